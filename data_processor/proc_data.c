@@ -80,7 +80,7 @@ int main(int argc, char *argv[]){
   char fileName[512];
   SDL_snprintf(fileName,512,"%schart.dat",appBasePath);
   const char headerStr[6] = "<>|<>";
-  const uint8_t version = 0; //revision of data format
+  const uint8_t version = 1; //revision of data format
 
   //parse data + metadata into an app_data struct
   app_data *dat=(app_data*)SDL_calloc(1,sizeof(app_data));
@@ -97,7 +97,7 @@ int main(int argc, char *argv[]){
     SDL_WriteIO(out,&headerStr[0],sizeof(headerStr)); //write header
     SDL_WriteIO(out,&version,sizeof(version));
     if(writeAsset(out,"data/io.github.e_j_w.ChartOfNuclides.svg",appBasePath)==-1){return SDL_APP_FAILURE;}
-    size_t dataSize = sizeof(app_data);
+    size_t dataSize = APP_DATA_STORED_SIZE; //search indices are built when the data is loaded
     //SDL_Log("Data size: %li\n",dataSize);
     SDL_WriteIO(out,&dataSize,sizeof(dataSize));
     if(SDL_WriteIO(out,dat,dataSize)!=dataSize){
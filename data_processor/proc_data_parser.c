@@ -604,6 +604,9 @@ static int parseAppRules(app_data *restrict dat, asset_mapping *restrict stringI
 	dat->locStringIDs[LOCSTR_SEARCHRES_GAMMACASCADE] = (uint16_t)nameToAssetID("search_result_gammacascade",stringIDmap);
 	dat->locStringIDs[LOCSTR_SEARCHRES_HALFLIFE] = (uint16_t)nameToAssetID("search_result_halflife",stringIDmap);
 	dat->locStringIDs[LOCSTR_SEARCHRES_LIFETIME] = (uint16_t)nameToAssetID("search_result_lifetime",stringIDmap);
+	dat->locStringIDs[LOCSTR_SEARCHRES_COMMENT] = (uint16_t)nameToAssetID("search_result_comment",stringIDmap);
+	dat->locStringIDs[LOCSTR_SEARCHRES_REACTION] = (uint16_t)nameToAssetID("search_result_reaction",stringIDmap);
+	dat->locStringIDs[LOCSTR_SEARCHRES_SPINPAR] = (uint16_t)nameToAssetID("search_result_spinpar",stringIDmap);
 	dat->locStringIDs[LOCSTR_SINGLE_ESCAPE] = (uint16_t)nameToAssetID("single_escape",stringIDmap);
 	dat->locStringIDs[LOCSTR_DOUBLE_ESCAPE] = (uint16_t)nameToAssetID("double_escape",stringIDmap);
 	dat->locStringIDs[LOCSTR_CLICKACTION_GOTOLEVEL] = (uint16_t)nameToAssetID("clickaction_goto_level",stringIDmap);
@@ -5780,6 +5783,7 @@ int buildDatabase(const char *appBasePath, ndata *nd){
     SDL_LogError(SDL_LOG_CATEGORY_APPLICATION,"no valid ENSDF data was found.\nPlease check that ENSDF files exist in the data/ensdf directory.\n");
     return -1;
   }
+
 	SDL_Log("Database build finished.\n");
 	return 0;
 }
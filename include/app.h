@@ -29,6 +29,8 @@ along with this program.  If not, see <https://www.gnu.org/licenses/>.
 #include "process_events.h"
 #include "data_ops.h"
 #include "thread_manager.h"
+#include "search_ops.h"
+#include "cli_query.h"
 
 #include <SDL3/SDL_main.h>
 
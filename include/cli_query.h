@@ -0,0 +1,30 @@
+/*
+Copyright (C) 2017-2026 J. Williams
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+/* Functions handling the command line query mode (searching without a window) */
+
+#ifndef CLIQ_H
+#define CLIQ_H
+
+#include <stdio.h>
+#include "formats.h"
+
+//function prototypes
+int parseCLIQueryArgs(int argc, char *argv[], cli_query_args *restrict args);
+int runCLIQuery(const cli_query_args *restrict args);
+
+#endif
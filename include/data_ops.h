@@ -28,6 +28,7 @@ using game data/state */
 void initializeTempState(const app_data *restrict dat, app_state *restrict state, resource_data *restrict rdat, thread_manager_state *restrict tms);
 
 void takeScreenshot(resource_data *restrict rdat);
+int saveScreenshot(screenshot_data *ssdat);
 
 void clearSelectionStrs(const drawing_state *restrict ds, text_selection_state *restrict tss, const uint8_t modifiableAfter, const uint8_t preservePos);
 
@@ -47,6 +48,9 @@ const char* getSpecialLvlStr(const app_data *restrict dat, const uint8_t special
 const char* getFullElemStr(const uint8_t Z, const uint8_t N);
 const char* getElemStr(const uint8_t Z);
 void getNuclNameStr(char strOut[32], const nucl *restrict nuclide, const uint8_t isomerMVal);
+void getNuclNameStrASCII(char strOut[32], const nucl *restrict nuclide, const uint8_t isomerMVal);
+uint8_t getNuclNameIdxKey(char keyOut[NUCL_NAME_IDX_STR_LEN], const char *str);
+uint32_t getNuclNameTrigramCode(const char *key, const uint8_t pos);
 uint8_t elemStrToZ(const char *elemStr);
 const char* getValueUnitShortStr(const uint8_t unit);
 const char* getValueTypeShortStr(const uint8_t type);
@@ -65,6 +69,7 @@ void getGSHalfLifeStr(char strOut[32], const app_data *restrict dat, const uint1
 void getDecayModeStr(char strOut[32], const ndata *restrict nd, const uint32_t dcyModeInd);
 void getMostProbableDecayModeStr(char strOut[32], const ndata *restrict nd, const uint32_t lvlInd);
 void getRxnStr(char strOut[32], const ndata *restrict nd, const uint32_t rxnInd);
+uint8_t getRxnCatalogueKey(char keyOut[RXN_CATALOGUE_KEY_LEN], char targetOut[RXN_CATALOGUE_TARGET_LEN], const char *rxnStr);
 void getAbundanceStr(char strOut[32], const ndata *restrict nd, const uint16_t nuclInd);
 void getSpinParStr(char strOut[32], const ndata *restrict nd, const uint32_t lvlInd);
 
@@ -86,6 +91,10 @@ double getLevelEnergykeV(const ndata *restrict nd, const uint32_t levelInd);
 
 int8_t getMostProbableParity(const ndata *restrict nd, const uint32_t lvlInd);
 double getMostProbableSpin(const ndata *restrict nd, const uint32_t lvlInd);
+uint16_t getSpinParValTwoJ(const ndata *restrict nd, const uint32_t lvlInd, const uint32_t spvInd);
+uint16_t getSpinParIdxKey(const uint16_t twoJ, const int8_t par);
+uint16_t getEHlGridEBin(const double energy);
+uint16_t getEHlGridTBin(const double hlSeconds);
 uint16_t getNumBetaDecayingLvls(const ndata *restrict nd, const uint16_t nuclInd);
 uint16_t getNumParticleDecayingLvls(const ndata *restrict nd, const uint16_t nuclInd);
 uint16_t getNumIsomers(const ndata *restrict nd, const double hlLimitSeconds, const uint16_t nuclInd);
@@ -98,6 +107,7 @@ double getR42(const ndata *restrict nd, const uint16_t nuclInd);
 double get2PlusEnergy(const ndata *restrict nd, const uint16_t nuclInd);
 double get2nd0PlusEnergy(const ndata *restrict nd, const uint16_t nuclInd);
 
+double getHalfLifeSecondsFromVal(const double hl, const uint8_t hlUnit);
 double getLevelHalfLifeSeconds(const ndata *restrict nd, const uint32_t levelInd);
 double getNuclLevelHalfLifeSeconds(const ndata *restrict nd, const uint16_t nuclInd, const uint16_t nuclLevel);
 double getNuclGSHalfLifeSeconds(const ndata *restrict nd, const uint16_t nuclInd);
@@ -112,6 +122,7 @@ uint16_t getNuclInd(const ndata *restrict nd, const int16_t N, const int16_t Z);
 
 void setCoincLvlFlags(const ndata *restrict nd, app_state *restrict state, const uint16_t nuclInd, const uint16_t nuclLevel);
 
+uint8_t isLvlDisplayedForRxn(const ndata *restrict nd, const uint8_t selectedRxn, const uint8_t reactionModeInd, const uint64_t *flaggedCoincLvls, const uint16_t nuclInd, const uint16_t nuclLvlInd);
 uint8_t isLvlDisplayed(const ndata *restrict nd, const app_state *restrict state, const uint16_t nuclInd, const uint16_t nuclLvlInd);
 
 uint16_t getNumScreenLvlDispLines(const drawing_state *restrict ds);
@@ -121,6 +132,8 @@ uint16_t getNumDispLinesForLvl(const ndata *restrict nd, const uint32_t lvlInd);
 
 uint32_t getENSDFLvlCommentStrInd(const ndata *restrict nd, const uint32_t lvlInd, const uint8_t commentType);
 uint32_t getENSDFTranCommentStrInd(const ndata *restrict nd, const uint32_t tranInd, const uint8_t commentType);
+uint32_t getCommentIdxDocStrInd(const ndata *restrict nd, const uint32_t docInd);
+uint32_t getNextCommentWord(const char *str, const uint32_t pos, char wordOut[COMMENT_IDX_MAX_WORD_LEN], uint32_t *wordStart);
 
 float getMinChartN(const drawing_state *restrict ds);
 float getMaxChartN(const drawing_state *restrict ds);
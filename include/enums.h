@@ -80,7 +80,7 @@ LOCSTR_CONTEXT_COPY, LOCSTR_CONTEXT_COPYTEXT, LOCSTR_CONTEXT_COPY_NUCLNAME,
 LOCSTR_CONTEXT_COPY_NUCLINFO, LOCSTR_CONTEXT_COPY_COMMENT, LOCSTR_SEARCH_PLACEHOLDER, 
 LOCSTR_SEARCH_PLACEHOLDER_LEVELINFO, LOCSTR_SEARCHRES_NUCLIDE, LOCSTR_SEARCHRES_EGAMMA, 
 LOCSTR_SEARCHRES_ELEVEL, LOCSTR_SEARCHRES_ELEVELDIFF, LOCSTR_SEARCHRES_GAMMACASCADE, 
-LOCSTR_SEARCHRES_HALFLIFE, LOCSTR_SEARCHRES_LIFETIME, LOCSTR_SINGLE_ESCAPE, 
+LOCSTR_SEARCHRES_HALFLIFE, LOCSTR_SEARCHRES_LIFETIME, LOCSTR_SEARCHRES_COMMENT, LOCSTR_SEARCHRES_REACTION, LOCSTR_SEARCHRES_SPINPAR, LOCSTR_SINGLE_ESCAPE, 
 LOCSTR_DOUBLE_ESCAPE, LOCSTR_CLICKACTION_GOTOLEVEL, LOCSTR_CLICKACTION_GOTODAUGHTER, 
 LOCSTR_CLICKACTION_SHOWCOINC, LOCSTR_CLICKACTION_SHOWSAMEJPI, LOCSTR_NUMPROTONS, 
 LOCSTR_NUMNEUTRONS, LOCSTR_CENTERCHART, LOCSTR_IS, LOCSTR_OF, LOCSTR_ONEARTH, 
@@ -530,8 +530,30 @@ SEARCHAGENT_ELEVEL,
 SEARCHAGENT_ELEVELDIFF,
 SEARCHAGENT_GAMMACASCADE,
 SEARCHAGENT_HALFLIFE,
+SEARCHAGENT_COMMENT,
+SEARCHAGENT_REACTION,
+SEARCHAGENT_SPINPAR,
+SEARCHAGENT_QUERY, //results are reported as SEARCHAGENT_ELEVEL, SEARCHAGENT_HALFLIFE or SEARCHAGENT_EGAMMA
 SEARCHAGENT_ENUM_LENGTH
 };
+enum search_token_cache_enum{
+TOKENCACHE_ELEVEL,
+TOKENCACHE_EGAMMA,
+TOKENCACHE_HALFLIFE,
+TOKENCACHE_ELEVELDIFF //first of NUM_SEARCH_CHUNKS caches (one for each chunk of the level energy difference search)
+};
+enum query_field_enum{
+QUERYFIELD_ELEVEL, //level energy (keV)
+QUERYFIELD_HALFLIFE, //level half-life (seconds)
+QUERYFIELD_SPIN, //level spin (2J)
+QUERYFIELD_PARITY, //level parity (1 or -1)
+QUERYFIELD_EGAMMA, //transition energy (keV)
+QUERYFIELD_IGAMMA, //transition relative intensity
+QUERYFIELD_Z, //nuclide proton number
+QUERYFIELD_N, //nuclide neutron number
+QUERYFIELD_A, //nuclide mass number
+QUERYFIELD_ENUM_LENGTH
+};
 enum search_state_enum{
 SEARCHSTATE_NOTSEARCHING,
 SEARCHSTATE_SEARCHING,
@@ -541,7 +563,39 @@ SEARCHSTATE_ENUM_LENGTH
 enum thread_state_enum{
 THREADSTATE_IDLE,
 THREADSTATE_SEARCH,
+THREADSTATE_BACKGROUNDTASK, //running a task other than a search
 THREADSTATE_KILL,
 THREADSTATE_DEAD,
 THREADSTATE_ENUM_LENGTH
 };
+enum thread_task_type_enum{
+THREADTASK_SEARCH, //run a search agent
+THREADTASK_SAVESCREENSHOT, //encode and save a screenshot (taskData points to the screenshot_data)
+THREADTASK_ENUM_LENGTH
+};
+enum thread_task_priority_enum{
+TASKPRIORITY_SEARCH, //highest priority, results are shown as the user types
+TASKPRIORITY_IO, //lowest priority
+TASKPRIORITY_ENUM_LENGTH
+};
+enum task_future_state_enum{
+TASKFUTURE_NONE, //no task has been queued
+TASKFUTURE_PENDING, //task queued or running
+TASKFUTURE_DONE, //task finished, result is available
+TASKFUTURE_ENUM_LENGTH
+};
+enum cli_format_enum{
+CLIFORMAT_TSV, //tab separated values, with a header line
+CLIFORMAT_JSON,
+CLIFORMAT_ENUM_LENGTH
+};
+enum cli_column_enum{
+CLICOL_TYPE, //type of search result
+CLICOL_NUCLIDE,
+CLICOL_ELEVEL, //level energy (keV)
+CLICOL_EGAMMA, //gamma-ray energy (keV)
+CLICOL_IGAMMA, //gamma-ray relative intensity
+CLICOL_HALFLIFE,
+CLICOL_DETAIL, //information specific to the type of result (eg. comment text, reaction, spin-parity)
+CLICOL_ENUM_LENGTH
+};
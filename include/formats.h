@@ -39,9 +39,14 @@ along with this program.  If not, see <https://www.gnu.org/licenses/>.
 #define MAX_SEARCH_TOKENS        16
 #define MAX_SEARCH_RESULTS       64 //number of results to cache (max 64, indexed by corrRes bitpattern)
 #define MAX_DISP_SEARCH_RESULTS  5  //number of results to display
-#define SEARCH_RESULT_DATASIZE   4
+#define SEARCH_RESULT_CACHE_SIZE 32 //number of recent queries whose results are cached
+#define MAX_CASCADE_GAMMAS       MAX_SEARCH_TOKENS //maximum number of gammas in a cascade search (one per search token)
+#define SEARCH_RESULT_DATASIZE   (MAX_CASCADE_GAMMAS+1) //large enough to hold the nuclide and all transitions of a cascade
 #define UNUSED_SEARCH_RESULT     MAX_UINT32_VAL
 
+//command line query parameters
+#define CLI_FIELD_STR_LEN        256 //maximum length of a decoded field of a search result printed by the command line query mode
+
 //text selection parameters
 #define MAX_SELECTABLE_STRS      1024 //maximum number of onscreen text strings that can be selectable at once
 #define MAX_SELECTABLE_STR_LEN   256 //maximum length of selectable text strings (should be larger than 32, which is the size used by some string composition functions in data_ops.c)
@@ -62,20 +67,60 @@ along with this program.  If not, see <https://www.gnu.org/licenses/>.
 #define MAXNUMREACTIONS          15000
 #define MAX_NEUTRON_NUM          200
 #define MAX_PROTON_NUM           130
+#define APP_DATA_STORED_SIZE     (offsetof(app_data,ndat) + offsetof(ndata,gammaIdx)) //bytes of app_data stored on disk (everything before the search indices at the end of ndata, which are built when the data is loaded)
 
 #define MAX_SPIN_VARS            32 //maximum spin variables (ie. J1, J2, J3...) per nuclide
 
 #define ISOMER_MVAL_HL_THRESHOLD    1.0E-3 //half-life (in seconds) lower threshold for an m-value to be assigned to an isomer
 #define ISOMER_MVAL_E_THRESHOLD     0.02   //energy (keV) upper threshold for an m-value to be assigned to an isomer, if the half-life is unknown
 
+#define HLIDX_MAX_REL_ERRBOUND      0.5    //half-lives with a search error bound larger than this fraction of their value are not sorted in the half-life index
+
+#define NUCL_NAME_IDX_STR_LEN          24     //maximum length of a name (including terminator) in the nuclide name index
+#define MAX_NUCL_NAME_IDX_ENTRIES      32768  //maximum number of names in the nuclide name index (must fit in uint16_t)
+#define NUCL_NAME_TRIGRAM_CHARS        37     //characters used in nuclide name index trigrams (start padding, 0-9, a-z)
+#define NUCL_NAME_TRIGRAM_CODES        (NUCL_NAME_TRIGRAM_CHARS*NUCL_NAME_TRIGRAM_CHARS*NUCL_NAME_TRIGRAM_CHARS)
+#define MAX_NUCL_NAME_TRIGRAM_POSTINGS (MAX_NUCL_NAME_IDX_ENTRIES*(NUCL_NAME_IDX_STR_LEN-1))
+
+#define MAX_COMMENT_IDX_DOCS           (MAXNUMLVLS+MAXNUMTRAN) //maximum number of comments (one per level or transition and comment type) in the comment text index
+#define MAX_COMMENT_IDX_TERMS          131072 //maximum number of distinct words in the comment text index
+#define COMMENT_IDX_TERMBUFSIZE        1048576 //size of the buffer holding the words of the comment text index
+#define COMMENT_IDX_POSTINGSSIZE       (ENSDFSTRBUFSIZE/2) //size of the buffer holding the compressed postings lists of the comment text index
+#define COMMENT_IDX_MAX_WORD_LEN       32 //maximum length of a word (including terminator) in the comment text index, longer words are truncated
+
+#define RXN_CATALOGUE_KEY_LEN          24 //maximum length of a canonical reaction type (including terminator) in the reaction catalogue
+#define RXN_CATALOGUE_TARGET_LEN       16 //maximum length of the target/parent part of a reaction string (including terminator)
+#define MAX_RXN_CATALOGUE_TYPES        4096 //maximum number of distinct reaction types in the reaction catalogue
+
+#define SPIDX_MAX_TWOJ                 255 //largest value of 2J in the spin-parity index, levels with higher spin aren't indexed
+#define SPIDX_NUM_KEYS                 ((SPIDX_MAX_TWOJ+1)*3) //number of (2J, parity) combinations in the spin-parity index
+
+#define EHL_GRID_E_BINS                128    //number of level energy bins in the (energy, half-life) grid index
+#define EHL_GRID_E_BIN_KEV             250.0  //width of each level energy bin, in keV (higher energies go in the last bin)
+#define EHL_GRID_T_BINS                100    //number of log10(half-life) bins in the (energy, half-life) grid index
+#define EHL_GRID_LOGT_MIN              -24.0  //log10 of the lowest half-life (in seconds) in the first half-life bin (shorter half-lives also go there)
+#define EHL_GRID_LOGT_BIN              0.5    //width of each log10(half-life) bin (longer half-lives go in the last bin)
+#define EHL_GRID_CELLS                 (EHL_GRID_E_BINS*EHL_GRID_T_BINS)
+
+#define MAX_QUERY_CLAUSES              8 //maximum number of OR-separated clauses in a structured query
+#define MAX_QUERY_CLAUSE_PREDS         8 //maximum number of predicates in each clause of a structured query
+#define MAX_QUERY_SCOPES               8 //maximum number of nuclides/elements a structured query can be restricted to
+
 
 #define NUMSHELLCLOSURES 7
 static const uint16_t shellClosureValues[NUMSHELLCLOSURES] = {2,8,20,28,50,82,126};
 
 //thread pool parameters
 #define MAX_NUM_THREADS 64 //maximum number of threads allowed in the thread pool
-                           //(cannot be > 64 as aliveThreads is uint64_t)
-#define THREAD_UPDATE_DELAY 10 //delay (in ms) for each thread to update its state
+#define MAX_NUM_THREAD_TASKS 48 //maximum number of tasks waiting in the thread pool's queue (must be >= NUM_SEARCH_THREADS, with room for background tasks)
+#define NUM_SEARCH_CHUNKS 8 //number of chunks (balanced by level and transition count) that the slowest search agents are split across
+#define NUM_CHUNKED_SEARCH_AGENTS 2 //number of search agents split into chunks (level energy difference and gamma cascade searches)
+#define NUM_SEARCH_THREADS (SEARCHAGENT_ENUM_LENGTH + NUM_CHUNKED_SEARCH_AGENTS*(NUM_SEARCH_CHUNKS - 1)) //one per search agent, plus the additional chunks of the chunked agents
+                                                                                                           //(cannot be >= 32 as completeThreadResults is uint32_t)
+#define SEARCH_RESULT_HASH_SIZE 128 //number of slots in the duplicate check hash of each search thread's results (power of 2, >= 2*MAX_SEARCH_RESULTS)
+#define NUM_SEARCH_TOKEN_CACHES (TOKENCACHE_ELEVELDIFF + NUM_SEARCH_CHUNKS) //number of search agent threads which keep results between searches (see search_token_cache_enum)
+#define SEARCH_TOKEN_CACHE_SLOTS 4 //number of search values that each search agent keeps results for (values beyond this are searched for without being cached)
+#define CACHE_LINE_SIZE 64 //in bytes, data written by different threads is kept on separate cache lines of this size
 
 //structures
 
@@ -184,6 +229,90 @@ typedef struct
                  //bit 3: set if any gamma mixing ratios are measured in this nuclide
 }nucl; //gamma data for a given nuclide
 
+typedef struct
+{
+  double energy; //decoded transition energy, in keV
+  float errBound; //half-width of the energy window that matches this transition, in keV (before broad search scaling)
+  uint32_t tranInd; //index of the transition
+  uint32_t lvlInd; //index of the level the transition is emitted from
+  uint16_t nuclInd; //index of the nuclide the transition belongs to
+}gamma_index_entry; //entry in the sorted index of transition energies, used by search agents
+
+typedef struct
+{
+  double energy; //decoded level energy, in keV
+  float errBound; //half-width of the energy window that matches this level, in keV (before broad search scaling)
+  uint32_t lvlInd; //index of the level
+  uint16_t nuclInd; //index of the nuclide the level belongs to
+}level_index_entry; //entry in the sorted index of level energies, used by search agents
+
+typedef struct
+{
+  double hlSeconds; //decoded half-life, in seconds (as returned by getHalfLifeSecondsFromVal)
+  double hlVal; //decoded half-life, in the units it is quoted in
+  double errBound; //half-width of the window that matches this half-life, in the units it is quoted in (before broad search scaling)
+  uint32_t lvlInd; //index of the level
+  uint16_t nuclInd; //index of the nuclide the level belongs to
+  uint8_t unit; //units the half-life is quoted in (values from value_unit_enum)
+}halflife_index_entry; //entry in the sorted index of level half-lives, used by search agents
+
+typedef struct
+{
+  double energy; //decoded level energy, in keV
+  double err; //decoded level energy uncertainty, in keV
+  uint32_t lvlInd; //index of the level
+}nucl_level_index_entry; //entry in the per-nuclide index of level energies, used by the level energy difference search
+
+typedef struct
+{
+  const char *str; //element name, or an accepted abbreviation/alternate spelling
+  uint8_t cmpLen; //number of characters which need to match (0 for an exact match)
+  uint8_t Z; //proton number of the element
+}elem_name_rule; //rule matching an element name to its Z, used by elemStrToZ
+
+typedef struct
+{
+  char name[NUCL_NAME_IDX_STR_LEN]; //lowercase ASCII name with separators removed (eg. '178m2hf', 'hf178m2', 'hafnium178')
+  uint32_t lvlInd; //index of the isomer level this name refers to, MAXNUMLVLS for ground state names
+  uint16_t nuclInd; //index of the nuclide
+  uint8_t len; //length of the name
+}nucl_name_index_entry; //entry in the index of nuclide name spellings, used by the fuzzy nuclide name search
+
+typedef struct
+{
+  uint32_t lvlInd; //index of the level the comment belongs to (for transition comments, the level the transition is emitted from)
+  uint32_t tranInd; //index of the transition the comment belongs to, MAX_UINT32_VAL for level comments
+  uint16_t nuclInd; //index of the nuclide
+  uint8_t commentType; //values from tran_comment_enum for transition comments, level_comment_enum otherwise
+}comment_index_doc; //a single ENSDF comment in the comment text index
+
+typedef struct
+{
+  uint32_t strPos; //start of the word in commentIdxTermBuf
+  uint32_t postingsPos; //start of the postings list in commentIdxPostings
+  uint32_t numDocs; //number of comments containing the word
+}comment_index_term; //a word in the comment text index, with the comments it appears in
+
+typedef struct
+{
+  char key[RXN_CATALOGUE_KEY_LEN]; //canonical reaction type (eg. '(p,g)', '(a,4n)', 'b-decay', 'coulombexcitation')
+  uint32_t firstEntry; //index of the first nuclide using this reaction type in rxnCatalogueEntries
+  uint16_t numEntries; //number of nuclides using this reaction type
+}rxn_catalogue_type; //a reaction type in the reaction catalogue
+
+typedef struct
+{
+  uint16_t nuclInd; //index of the nuclide populated by the reaction
+  uint8_t rxnLocalInd; //index of the reaction within the nuclide (selectedRxn-1 when filtering the level list)
+}rxn_catalogue_entry; //a nuclide populated by a reaction type in the reaction catalogue
+
+typedef struct
+{
+  uint32_t lvlInd; //index of the level
+  uint16_t nuclInd; //index of the nuclide the level belongs to
+  uint8_t tentative; //values from tentative_sp_enum
+}spinpar_index_entry; //entry in the index of level spin-parity values, used by the spin-parity search
+
 typedef struct
 {
   uint32_t numLvls; //number of levels across all nuclides
@@ -206,6 +335,53 @@ typedef struct
   spinparval spv[MAXSPINPARVAL];
   char ensdfStrBuf[ENSDFSTRBUFSIZE]; //huge buffer for directly copied ENSDF strings (reaction strings, comments, etc)
   uint32_t ensdfStrBufLen;
+  //search indices built when the app data is loaded (see buildSearchIndices), everything
+  //from here on is derived from the data above and isn't stored in the app data file
+  gamma_index_entry gammaIdx[MAXNUMTRAN]; //all transitions with known energy, sorted by energy
+  uint32_t numGammaIdx; //number of entries in gammaIdx
+  float gammaIdxMaxErrBound; //largest errBound of any entry in gammaIdx, in keV
+  level_index_entry lvlIdx[MAXNUMLVLS]; //all levels with known (non-zero) energy, sorted by energy
+  uint32_t numLvlIdx; //number of entries in lvlIdx
+  float lvlIdxMaxErrBound; //largest errBound of any entry in lvlIdx, in keV
+  halflife_index_entry hlIdx[MAXNUMLVLS]; //all levels with known half-life, entries [0,numHlIdxSorted) sorted by half-life in seconds, remaining entries (large errors or non-time units) unsorted
+  uint32_t numHlIdx; //number of entries in hlIdx
+  uint32_t numHlIdxSorted; //number of entries at the start of hlIdx which are sorted by half-life
+  nucl_level_index_entry nuclLvlIdx[MAXNUMLVLS]; //levels with known energy, sorted by energy within each nuclide, entries for a nuclide start at the nuclide's firstLevel
+  uint16_t numNuclLvlIdx[MAXNUMNUCL]; //number of entries in nuclLvlIdx for each nuclide
+  double nuclLvlIdxMaxErr[MAXNUMNUCL]; //largest energy uncertainty of any entry in nuclLvlIdx for each nuclide, in keV
+  comment_index_doc commentIdxDocs[MAX_COMMENT_IDX_DOCS]; //all level and transition ENSDF comments, in order of level index
+  uint32_t numCommentIdxDocs; //number of entries in commentIdxDocs
+  comment_index_term commentIdxTerms[MAX_COMMENT_IDX_TERMS]; //all words appearing in the comments, sorted alphabetically
+  uint32_t numCommentIdxTerms; //number of entries in commentIdxTerms
+  char commentIdxTermBuf[COMMENT_IDX_TERMBUFSIZE]; //null-terminated words referenced by commentIdxTerms
+  uint32_t commentIdxTermBufLen;
+  uint8_t commentIdxPostings[COMMENT_IDX_POSTINGSSIZE]; //postings lists (indices in commentIdxDocs, in increasing order), stored as differences from the previous index encoded 7 bits per byte (high bit set if more bytes follow)
+  uint32_t commentIdxPostingsLen;
+  uint32_t eHlGridStart[EHL_GRID_CELLS+1]; //levels in grid cell c (see getEHlGridEBin, getEHlGridTBin) are eHlGrid[eHlGridStart[c] ... eHlGridStart[c+1]-1]
+  uint32_t eHlGrid[MAXNUMLVLS]; //indices of the levels with known energy and (non-stable) half-life, grouped by grid cell and in order of level index within each cell
+  uint32_t numEHlGrid; //number of entries in eHlGrid
+  float qColLvlE[MAXNUMLVLS]; //level energy in keV, NaN if unknown or variable (columns used by structured queries)
+  float qColLvlLogHl[MAXNUMLVLS]; //log10 of the level half-life in seconds, INFINITY if stable, NaN if unknown
+  float qColLvlTwoJ[MAXNUMLVLS]; //2J of the first spin-parity value of the level, NaN if unknown
+  float qColLvlPar[MAXNUMLVLS]; //parity of the first spin-parity value of the level (1 or -1), NaN if unknown
+  uint16_t qColLvlNucl[MAXNUMLVLS]; //nuclide index of each level
+  float qColTranE[MAXNUMTRAN]; //transition energy in keV, NaN if unknown or variable
+  float qColTranI[MAXNUMTRAN]; //transition relative intensity, NaN if unknown
+  uint32_t qColTranLvl[MAXNUMTRAN]; //index of the level each transition comes from
+  nucl_name_index_entry nuclNameIdx[MAX_NUCL_NAME_IDX_ENTRIES]; //canonical and alternate spellings of all observed nuclide and isomer names, spellings of the same nuclide/isomer are adjacent
+  uint16_t numNuclNameIdx; //number of entries in nuclNameIdx
+  uint32_t nuclNameTrigramStart[NUCL_NAME_TRIGRAM_CODES+1]; //postings for trigram code c are nuclNameTrigramPostings[nuclNameTrigramStart[c] ... nuclNameTrigramStart[c+1]-1]
+  uint16_t nuclNameTrigramPostings[MAX_NUCL_NAME_TRIGRAM_POSTINGS]; //indices in nuclNameIdx of the names containing each trigram, in increasing order
+  uint16_t nuclIndByNZ[MAX_PROTON_NUM][MAX_NEUTRON_NUM]; //index of the observed nuclide with a given Z and N, MAXNUMNUCL if none
+  uint16_t nearestNuclIndByNZ[MAX_PROTON_NUM][MAX_NEUTRON_NUM]; //index of the observed nuclide closest to a given Z and N
+  uint8_t nuclIndGridBuilt; //1 once nuclIndByNZ and nearestNuclIndByNZ have been built, 0 otherwise
+  rxn_catalogue_type rxnCatalogueTypes[MAX_RXN_CATALOGUE_TYPES]; //all canonical reaction types, sorted by key
+  uint16_t numRxnCatalogueTypes; //number of entries in rxnCatalogueTypes
+  rxn_catalogue_entry rxnCatalogueEntries[MAXNUMREACTIONS]; //nuclides populated by each reaction type, entries for a type are adjacent and ordered by nuclide index
+  uint16_t numRxnCatalogueEntries; //number of entries in rxnCatalogueEntries
+  uint32_t spIdxStart[SPIDX_NUM_KEYS+1]; //levels with spin-parity key k (see getSpinParIdxKey) are spIdx[spIdxStart[k] ... spIdxStart[k+1]-1]
+  spinpar_index_entry spIdx[MAXSPINPARVAL]; //levels with known spin, grouped by (2J, parity) and in order of level index within each group
+  uint32_t numSpIdx; //number of entries in spIdx
 }ndata; //complete set of gamma data for all nuclides
 
 
@@ -308,6 +484,169 @@ typedef struct
   unsigned int forceRedraw : 1; //true if a re-draw should be forced
 }drawing_state; //struct containing values used for drawing
 
+typedef struct
+{
+  uint32_t tranInd; //index of the transition
+  uint32_t initialLvl; //initial level of the transition (relative to the nuclide's firstLevel)
+  uint32_t finalLvl; //final level of the transition (relative to the nuclide's firstLevel, same as the initial level if unknown)
+  uint16_t nuclInd; //nuclide the transition belongs to
+  uint8_t gamma; //query gamma matched by the transition
+}cascade_candidate; //transition matching one of the gammas of a cascade search
+
+typedef struct
+{
+  double gammaE[MAX_CASCADE_GAMMAS]; //query gamma energies, in keV
+  const cascade_candidate *cand; //transitions in the nuclide matching the query gammas, ordered by query gamma then transition
+  const uint64_t *reach; //bit-pattern for each candidate of the candidates below it in a cascade (reachWords entries per candidate)
+  uint32_t numCand;
+  uint32_t reachWords;
+  uint8_t numGammas;
+  uint16_t nuclInd; //nuclide being searched
+  uint32_t chainCand[MAX_CASCADE_GAMMAS]; //candidate used for each member of the cascade currently being built
+  uint32_t bestTran[MAX_CASCADE_GAMMAS]; //transitions in the best cascade found so far, ordered from the top of the cascade down
+  float bestRelevance; //relevance of the best cascade found so far (0 if none found)
+  uint32_t numNodesVisited; //used to limit the size of the search
+  uint64_t coincLvls[65536/64]; //scratch bit-pattern of levels in the nuclide below (and coincident with) a given level
+}cascade_search_data; //working data for the gamma cascade search of a single nuclide
+
+typedef struct
+{
+  cascade_candidate *cand; //candidate transitions in the nuclides of a chunk
+  uint32_t candSize; //number of candidates allocated
+  uint64_t *reach; //candidate reachability bit-patterns of a single nuclide (see cascade_search_data)
+  size_t reachSize; //number of bit-pattern entries allocated
+}cascade_search_buffers; //scratch buffers of the gamma cascade search agent, kept between searches (grown as needed)
+
+typedef struct
+{
+  double minVal; //lower bound, in keV (energies), seconds (half-life), 2J (spin), or the raw value (other fields)
+  double maxVal; //upper bound
+  uint8_t field; //values from query_field_enum
+  uint8_t minExcl; //1 if the lower bound is exclusive
+  uint8_t maxExcl; //1 if the upper bound is exclusive
+  uint8_t negate; //1 if the predicate matches (known) values outside of the bounds
+}query_pred; //single field predicate of a structured query
+
+typedef struct
+{
+  query_pred pred[MAX_QUERY_CLAUSE_PREDS]; //predicates, all of which must match
+  uint8_t numPreds;
+}query_clause; //AND-combined predicates of a structured query
+
+typedef struct
+{
+  query_clause clause[MAX_QUERY_CLAUSES]; //clauses, any of which may match
+  int16_t scopeZ[MAX_QUERY_SCOPES]; //proton number of each nuclide/element the query is restricted to
+  int16_t scopeA[MAX_QUERY_SCOPES]; //mass number of each nuclide the query is restricted to (0 for all isotopes of the element)
+  uint8_t numClauses; //0 if the search string isn't a structured query
+  uint8_t numScopes; //0 if the query isn't restricted to particular nuclides
+}query_plan; //compiled structured query (eg. 'E>1000 AND T<1us OR J=9/2+ in 178Hf')
+
+typedef struct
+{
+  uint32_t resultVal[2]; //first two result values
+  uint8_t resultType; //values from search_agent_enum
+  uint8_t used; //0 if the hash slot is empty
+}search_result_key; //identifies a search result, for duplicate checks
+
+typedef struct
+{
+  search_result res[MAX_SEARCH_RESULTS]; //binary min-heap ordered by relevance (lowest relevance result at index 0)
+  search_result_key hash[SEARCH_RESULT_HASH_SIZE]; //open addressing hash of the results in the heap
+  uint8_t numRes;
+}search_result_heap; //best results found by a single search thread
+
+typedef union
+{
+  search_result_heap heap;
+  uint8_t pad[((sizeof(search_result_heap) + CACHE_LINE_SIZE - 1)/CACHE_LINE_SIZE)*CACHE_LINE_SIZE]; //round up to a whole number of cache lines
+}search_thread_output; //results written by a single search thread, padded so that no two threads write to the same cache line
+
+typedef struct
+{
+  float chartPosX, chartPosY, chartZoomScale; //chart view (affects relevance)
+  uint16_t chartSelectedNucl; //affects relevance
+  uint16_t boostedNucl;
+  uint8_t boostedResultType;
+  uint8_t broadSearch;
+  uint8_t searchInProgress;
+  uint8_t useLifetimes;
+  uint8_t selectedRxn; //reaction filter for single nuclide searches
+  uint8_t agentPar; //agent specific parameter (eg. number of chunks that the search is split into)
+}search_token_cache_key; //search parameters (other than the search values) which the results of a search agent depend on
+
+typedef struct
+{
+  uint16_t firstNucl; //nuclide that the chunk starts in
+  uint16_t firstEnt; //entry in the nuclide's per-nuclide level energy index (ndat->nuclLvlIdx) that the chunk starts at
+}search_chunk; //start of a chunk of the nuclear data, chunks of the data are searched separately by the slowest search agents
+
+typedef struct
+{
+  double val; //search value (eg. energy) that the results were found for
+  search_result_heap res; //best results found for the value (with relevance boosts applied)
+  uint8_t used; //1 if the slot holds the complete results for the value
+}search_token_cache_slot;
+
+typedef struct
+{
+  search_token_cache_slot slot[SEARCH_TOKEN_CACHE_SLOTS];
+  search_token_cache_key key; //parameters that the cached results were found with
+}search_token_cache; //results found by a search agent for each value in recent searches, reused while the user types
+
+typedef struct
+{
+  char query[SEARCH_STRING_MAX_SIZE]; //search string, with runs of spaces collapsed and leading/trailing spaces removed
+  int16_t chartPosX, chartPosY; //chart position, rounded to whole chart units (0 if the proximity of results isn't weighted)
+  int16_t zoomStep; //chart zoom scale in steps of 0.25 (0 if the proximity of results isn't weighted)
+  uint16_t chartSelectedNucl;
+  uint8_t searchInProgress; //single nuclide or regular search, values from search_state_enum
+  uint8_t selectedRxn;
+  uint8_t reactionModeInd;
+  uint8_t useLifetimes;
+}search_result_cache_key; //normalized search query and the parts of the view which affect its results
+
+typedef struct
+{
+  search_result_cache_key key;
+  search_result results[MAX_SEARCH_RESULTS];
+  uint32_t lastUsed; //value of useCtr when the entry was last used, 0 if the entry is empty
+  uint8_t numResults;
+}search_result_cache_entry;
+
+typedef struct
+{
+  search_result_cache_entry entry[SEARCH_RESULT_CACHE_SIZE];
+  search_result_cache_key searchKey; //key of the search in progress
+  uint32_t useCtr; //incremented whenever an entry is used
+  uint32_t numHits, numMisses;
+  uint8_t searchCacheable; //1 if the results of the search in progress can be cached
+}search_result_cache; //results of recent searches (the least recently used entry is replaced first)
+
+typedef struct
+{
+  search_result results[MAX_SEARCH_RESULTS];
+  int generation; //generation of the search that the results belong to (see search_state)
+  uint8_t numResults;
+}search_result_buffer; //results published by the search threads while a search is running
+
+#define COINC_FLAG_BITPATTERN_SIZE 16
+#define MAX_COINC_FLAGGED_LVLS (64*COINC_FLAG_BITPATTERN_SIZE)
+
+typedef struct
+{
+  char searchString[SEARCH_STRING_MAX_SIZE]; //query being searched for
+  uint64_t flaggedCoincLvls[COINC_FLAG_BITPATTERN_SIZE]; //levels flagged as coincident (or having the same Jpi) in the nuclide being searched
+  float chartPosX, chartPosY, chartZoomScale; //chart view (affects relevance, quantised when zoomed in, see setSearchContext)
+  uint16_t chartSelectedNucl; //affects relevance
+  uint8_t searchInProgress; //single nuclide or regular search, values from search_state_enum
+  uint8_t selectedRxn; //reaction (or coincidence) filter for single nuclide searches
+  uint8_t reactionModeInd; //values from reaction_mode_enum
+  uint8_t useLifetimes;
+  int generation; //value of searchGeneration when the search was started (see search_state)
+}search_context; //the parts of the app state which a search depends on, copied when the search starts so
+                 //that the search threads never read state which the main thread may be changing
+
 typedef struct
 {
   char searchString[SEARCH_STRING_MAX_SIZE];   //the user's search query
@@ -316,16 +655,52 @@ typedef struct
   //will only be displayed once the search is completed
   search_result updatedResults[MAX_SEARCH_RESULTS];
   uint8_t numUpdatedResults; //the number of results returned so far
+  //results found by each search thread (written only by that thread, so no locking is needed)
+  //merged into updatedResults once the search is finished
+  //(NUM_SEARCH_THREADS entries, allocated aligned to the cache line size)
+  search_thread_output *threadResults;
+  //scratch heaps used to merge the results of the finished search threads, one for each entry of
+  //threadResults (used by that thread when publishing results), plus one used by the main thread
+  search_result_heap *mergeHeaps;
+  //scratch buffers of the comment search agent (written only by the thread running it), allocated
+  //by the first comment search with an entry for each comment in the comment text index
+  uint32_t *commentCand, *commentTermDocs;
+  uint8_t *commentPrefixDocs;
+  //scratch buffer of the fuzzy nuclide name search (written only by the thread running the nuclide search agent),
+  //allocated by the first fuzzy search with a count of shared trigrams for each entry in the nuclide name index,
+  //the entries touched by a search are cleared again once it is done
+  uint8_t *nuclNameShared;
+  cascade_search_buffers cascadeBuf[NUM_SEARCH_CHUNKS]; //scratch buffers of each chunk of the gamma cascade search agent
+  search_context ctx; //snapshot of the app state taken when the search started (read-only while searching)
+  search_context nextCtx; //context of the search whose tasks are queued, copied to ctx when its first task starts (protected by the thread pool's queue lock)
+  //chunks that the slowest search agents are split across (the last entry marks the end of the data),
+  //balanced by level and transition count, so that heavy nuclides may be split across several chunks
+  search_chunk chunk[NUM_SEARCH_CHUNKS+1];
+  //results of the numeric search agents for each search value, kept between searches
+  //so that only values which have changed are searched for again as the query is typed
+  search_token_cache tokenCache[NUM_SEARCH_TOKEN_CACHES];
+  search_result_cache resultCache; //final results of recent searches, published without searching again
+  //results of the search threads finished so far, published while the other threads are still searching
+  //(double buffered, the search threads write the back buffer and then swap it to the front)
+  search_result_buffer publishedResults[2];
+  SDL_AtomicInt publishedResultsInd; //index of the front buffer in publishedResults
+  SDL_AtomicInt numPublishedResults; //incremented each time results are published
+  int numShownPublishedResults; //value of numPublishedResults when published results were last shown (main thread only)
+  SDL_SpinLock publishLock; //held by a search thread while publishing results
+  uint32_t completeThreadResults; //bit pattern specifying which of threadResults are complete (protected by publishLock)
+  uint32_t publishedThreadResults; //bit pattern specifying which of threadResults the published results were merged from (protected by publishLock)
+  Uint32 resultsEventType; //SDL user event sent to wake the main thread when search threads finish (0 if unavailable)
   //the search results to display
   search_result results[MAX_SEARCH_RESULTS];
   uint8_t numResults; //the number of results returned so far
   uint8_t numSearchTok;
+  query_plan queryPlan; //structured query compiled from the search string (queryPlan.numClauses = 0 if it isn't one)
   uint8_t boostedResultType;  //result type which is prioritized, values from search_agent_enum
   uint8_t broadSearch; //0=use regular error bounds, 1=search with wider error bounds
   uint16_t boostedNucl; //nuclide which is prioritized, MAXNUMNUCL if none (or if only one nuclide is being searched, specifies that nuclide)
-  uint32_t finishedSearchAgents; //bit pattern specifying which search agents have finished
+  SDL_AtomicInt searchGeneration; //incremented by the main thread when a search starts, and when the query changes during a search (cancelling it)
+  int runningSearchGeneration; //value of searchGeneration when the main thread last started a search (search threads use ctx.generation)
   uint8_t searchInProgress; //values from search_state_enum
-  SDL_Semaphore *canUpdateResults;
 }search_state; //struct containing search data
 
 typedef struct
@@ -351,9 +726,6 @@ typedef struct
   uint16_t selectionInd, selectionInd2; //indices of nuclide/level or other items corresponding to this context menu
 }context_menu_state; //struct containing context menu data
 
-#define COINC_FLAG_BITPATTERN_SIZE 16
-#define MAX_COINC_FLAGGED_LVLS (64*COINC_FLAG_BITPATTERN_SIZE)
-
 typedef struct
 {
   drawing_state ds;          //the state information for drawing
@@ -391,10 +763,21 @@ typedef struct
   unsigned int quitAppFlag : 1; //0=take no action, 1=quit app
 }app_state; //structure containing all app state data (persistent AND temporary)
 
+//result of a task run by the thread pool, which the main thread can poll each frame (or wait on)
+typedef struct
+{
+  SDL_AtomicInt state; //values from task_future_state_enum
+  int result; //value returned by the task (only valid once the state is TASKFUTURE_DONE)
+}thread_task_future;
+
 typedef struct
 {
   SDL_Surface *screenshot; //surface for any screenshots
-  unsigned int takingScreenshot : 2; //0=not taking a screenshot, 1=taking a screenshot at the end of the current frame, 2=saving screenshot
+  char fileName[256]; //file that the screenshot is to be saved to
+  SDL_Surface *savingScreenshot; //screenshot being saved by the thread pool (owned by the save task until saveFuture is done)
+  char savingFileName[256];
+  thread_task_future saveFuture; //result of saving the screenshot (0 if successful)
+  unsigned int takingScreenshot : 2; //0=not taking a screenshot, 1=taking a screenshot at the end of the current frame, 2=choosing file, 3=file chosen, waiting to be saved
 }screenshot_data; //structure containing data relating to resources such as textures and fonts
 
 typedef struct
@@ -422,20 +805,56 @@ typedef struct
 typedef struct
 {
   app_rules rules; //app rules
-  ndata ndat; //nuclear structure database
   char strings[LOCSTR_ENUM_LENGTH][256]; //array of text strings used in the app
   uint16_t numLocStrings; //total number of text strings used
   uint16_t locStringIDs[LOCSTR_ENUM_LENGTH];
+  ndata ndat; //nuclear structure database (must be last, see APP_DATA_STORED_SIZE)
 }app_data; //structure for all imported app data
 
+//task run by a thread in the thread pool
+typedef struct
+{
+  void *taskData; //data used by the task (for tasks other than searches)
+  thread_task_future *future; //set once the task is done (NULL if the result isn't needed)
+  uint32_t dependencies; //bit pattern of tasks which must finish before this task can run (for searches, search agents)
+  uint32_t completes; //bit pattern set in finishedTasks once this task has finished
+  uint8_t taskType; //values from thread_task_type_enum
+  uint8_t priority; //values from thread_task_priority_enum, runnable tasks with the highest priority (lowest value) are run first
+  uint8_t taskNum; //index of the task in the batch it was queued with (used to report search task timing)
+  uint8_t threadPar; //task parameter (eg. which search agent to run)
+  uint8_t threadSubPar; //secondary task parameter (eg. which chunk of the data the search agent should process)
+  int searchGeneration; //generation of the search that the task belongs to (search tasks only, see search_state)
+}thread_task;
+
+//queue of tasks waiting to be run by the thread pool
+//(tasks run in order of priority, then in the order they were queued, once their dependencies have finished)
+typedef struct
+{
+  thread_task task[MAX_NUM_THREAD_TASKS]; //queued tasks, in the order they were queued
+  uint8_t numTasks; //number of queued tasks
+  uint8_t numUnfinishedSearchTasks; //number of tasks of the current search queued or being run
+  uint8_t numStaleSearchTasks; //number of tasks of cancelled searches still being run, tasks of the current search wait for these as they share the search state
+  int searchGeneration; //generation of the current search (0 if there is none)
+  uint32_t finishedTasks; //bit pattern of finished tasks (reset when a batch of tasks is queued)
+  Uint64 batchStartTime; //time (in ns, from SDL_GetTicksNS) at which the current batch of tasks was queued
+  Uint64 taskStartTime[MAX_NUM_THREAD_TASKS]; //time (in ns, relative to batchStartTime) at which each task in the batch started running
+  Uint64 taskEndTime[MAX_NUM_THREAD_TASKS]; //time (in ns, relative to batchStartTime) at which each task in the batch finished
+  uint8_t numBatchTasks; //number of tasks in the current batch
+  SDL_Mutex *lock; //protects the queue and thread states
+  SDL_Condition *taskQueued; //signalled when a task may have become runnable (queued, or its dependencies finished) or threads are killed, idle threads wait on this
+  SDL_Condition *taskDone; //broadcast when a task with a future, or the last task of a search, finishes (see waitForTaskFuture, waitForSearchTasks)
+}thread_task_queue;
+
 //data passed to a thread in the thread pool
 typedef struct
 {
   //pointers to game data accessible to threads go here
   uint8_t threadNum; //unique identifier for this thread
   uint8_t threadState; //state of the thread, values from thread_state_enum
-  uint8_t threadPar; //thread parameter (eg. which search agent to run)
+  uint8_t threadPar; //parameter of the task being run (eg. which search agent to run)
+  uint8_t threadSubPar; //secondary parameter of the task being run (eg. which chunk of the data the search agent should process)
   //data that the thread has access to:
+  thread_task_queue *queue; //the thread pool's task queue
   app_state *state;        //the application state
   app_data *dat;           //the application data
 }thread_data;
@@ -443,12 +862,25 @@ typedef struct
 //structure for thread management
 typedef struct
 {
-  uint8_t numThreads; //number of threads to have active in the thread pool
-  uint64_t aliveThreads; //bit-pattern specifying which threads are in use
+  uint8_t numThreads; //number of threads in the thread pool (0 until the first search starts them)
+  SDL_Thread *thread[MAX_NUM_THREADS]; //threads in the thread pool (waited on when the pool is stopped)
   thread_data threadData[MAX_NUM_THREADS]; //data to give to each thread
+  thread_task_queue queue; //tasks waiting to be run
+  Uint64 lastSearchTime; //time (in ns) taken by the last search which finished without being cancelled
+  Uint64 lastSlowestTaskTime; //run time (in ns) of the slowest task in that search
+  uint8_t lastSlowestTask; //index of the slowest task in that search (same as the index of its results in ss.threadResults)
   uint8_t masterThreadState; //what state the threads are expected to be in, values from thread_state_enum
 }thread_manager_state;
 
+//command line query options (see cli_query.c)
+typedef struct
+{
+  char searchString[SEARCH_STRING_MAX_SIZE]; //query to search for
+  uint8_t format; //output format, values from cli_format_enum
+  uint8_t limit; //maximum number of results to print
+  uint8_t showTiming; //whether to report the load and search times
+}cli_query_args;
+
 //structure containing all application data
 //used so that all app data can be allocated in a single block of memory
 typedef struct
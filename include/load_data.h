@@ -26,6 +26,7 @@ along with this program.  If not, see <https://www.gnu.org/licenses/>.
 #include "gui_constants.h"
 
 int importAppData(app_data *restrict dat, const app_state *restrict state, resource_data *restrict rdat);
+int importAppDataHeadless(app_data *restrict dat, resource_data *restrict rdat);
 int regenerateThemeAndFontCache(app_data *restrict dat, const app_state *restrict state, resource_data *restrict rdat);
 
 #endif
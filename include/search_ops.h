@@ -9,12 +9,32 @@
 #include "formats.h"
 
 //function prototypes
+void buildSearchIndices(ndata *nd);
+uint8_t getSearchResultHeapInd(const uint8_t agent, const uint8_t chunkInd);
+void setSearchChunks(const ndata *restrict ndat, search_state *restrict ss);
+void appendSearchResult(search_state *restrict ss, const uint8_t heapInd, search_result *restrict res);
+void mergeSearchResults(search_state *restrict ss);
+void publishSearchResults(search_state *restrict ss, const uint32_t threads);
+uint8_t getPublishedSearchResults(search_state *restrict ss);
+void freeSearchState(search_state *ss);
+void setSearchContext(const app_state *state, search_context *ctx);
+uint8_t getSearchResultCacheKey(const search_context *ctx, search_result_cache_key *key);
+uint8_t getCachedSearchResults(search_state *restrict ss);
+void cacheSearchResults(search_state *restrict ss);
+void cancelSearch(search_state *restrict ss);
+uint8_t isSearchCancelled(search_state *restrict ss);
+void startSearchTasks(search_state *restrict ss);
 void tokenizeSearchStr(search_state *restrict ss);
-void searchELevel(const ndata *restrict ndat, const app_state *state, search_state *ss);
-void searchELevelDiff(const ndata *restrict ndat, const app_state *state, search_state *ss);
-void searchEGamma(const ndata *restrict ndat, const app_state *state, search_state *ss);
-void searchGammaCascade(const ndata *restrict ndat, const app_state *state, search_state *ss);
-void searchHalfLife(const ndata *restrict ndat, const app_state *state, search_state *ss);
+void compileQueryPlan(const char *str, query_plan *plan);
+void searchELevel(const ndata *restrict ndat, const search_context *ctx, search_state *ss);
+void searchELevelDiff(const ndata *restrict ndat, const search_context *ctx, search_state *ss, const uint8_t chunkInd);
+void searchEGamma(const ndata *restrict ndat, const search_context *ctx, search_state *ss);
+void searchGammaCascade(const ndata *restrict ndat, const search_context *ctx, search_state *ss, const uint8_t chunkInd);
+void searchHalfLife(const ndata *restrict ndat, const search_context *ctx, search_state *ss);
+void searchComments(const ndata *restrict ndat, const search_context *ctx, search_state *ss);
+void searchReactions(const ndata *restrict ndat, const search_context *ctx, search_state *ss);
+void searchSpinParity(const ndata *restrict ndat, const search_context *ctx, search_state *ss);
+void searchQuery(const ndata *restrict ndat, const search_context *ctx, search_state *ss);
 void searchNuclides(const ndata *restrict ndat, search_state *restrict ss);
 void searchSpecialStrings(search_state *restrict ss);
 
@@ -25,7 +25,13 @@ along with this program.  If not, see <https://www.gnu.org/licenses/>.
 //function prototypes
 
 int startSearchThreads(app_data *restrict dat, app_state *restrict state, thread_manager_state *restrict tms);
-void updateThreads(const app_data *restrict dat, app_state *restrict state, resource_data *restrict rdat, thread_manager_state *restrict tms);
+void updateThreads(app_data *restrict dat, app_state *restrict state, resource_data *restrict rdat, thread_manager_state *restrict tms);
+void cancelSearchThreads(app_state *restrict state, thread_manager_state *restrict tms);
+int queueBackgroundTask(app_data *restrict dat, app_state *restrict state, thread_manager_state *restrict tms, const uint8_t taskType, const uint8_t priority, void *taskData, thread_task_future *future);
+uint8_t getTaskFutureState(thread_task_future *future);
+void waitForTaskFuture(thread_manager_state *restrict tms, thread_task_future *future);
+void waitForSearchTasks(thread_manager_state *restrict tms);
+void finishScreenshotSaves(app_data *restrict dat, app_state *restrict state, resource_data *restrict rdat, thread_manager_state *restrict tms);
 void stopThreadPool(thread_manager_state *restrict tms);
 
 #endif
@@ -0,0 +1,142 @@
+#include "ewmatch.h"
+#include <string.h> //memcpy, memset
+#include <SDL3/SDL.h> //CPU feature detection and intrinsics (SDL_intrin.h)
+
+//read the value of an entry
+static double ewm_loadVal(const ewm_layout *layout, const uint32_t ind){
+  double val;
+  memcpy(&val,(const char*)layout->base + (size_t)ind*layout->stride + layout->valOffset,sizeof(double));
+  return val;
+}
+
+//read the error bound of an entry
+static double ewm_loadErr(const ewm_layout *layout, const uint32_t ind){
+  const char *ptr = (const char*)layout->base + (size_t)ind*layout->stride + layout->errOffset;
+  if(layout->errIsDouble){
+    double err;
+    memcpy(&err,ptr,sizeof(double));
+    return err;
+  }
+  float err;
+  memcpy(&err,ptr,sizeof(float));
+  return (double)err;
+}
+
+//match entries [first,numEntries) one at a time
+static void ewm_matchScalar(const ewm_layout *layout, const uint32_t first, const uint32_t numEntries, const double shift, const double errScale, const double *query, const uint8_t numQueries, uint64_t *masks){
+  const uint32_t numWords = EWM_NUM_MASK_WORDS(numEntries);
+  for(uint32_t i=first; i<numEntries; i++){
+    const double val = ewm_loadVal(layout,i) - shift;
+    const double err = ewm_loadErr(layout,i)*errScale;
+    const double lo = val - err;
+    const double hi = val + err;
+    for(uint8_t q=0; q<numQueries; q++){
+      if((lo <= query[q])&&(hi >= query[q])){
+        masks[q*numWords + i/64U] |= (uint64_t)1 << (i%64U);
+      }
+    }
+  }
+}
+
+#ifdef SDL_AVX2_INTRINSICS
+//match entries 4 at a time (gathered from the entries in place), then the remainder one at a time
+static void SDL_TARGETING("avx2") ewm_matchAVX2(const ewm_layout *layout, const uint32_t numEntries, const double shift, const double errScale, const double *query, const uint8_t numQueries, uint64_t *masks){
+  const uint32_t numWords = EWM_NUM_MASK_WORDS(numEntries);
+  const long long stride = (long long)layout->stride;
+  const __m256i offsets = _mm256_set_epi64x(3*stride,2*stride,stride,0);
+  const __m256d shiftV = _mm256_set1_pd(shift);
+  const __m256d scaleV = _mm256_set1_pd(errScale);
+  __m256d queryV[EWM_MAX_QUERIES];
+  for(uint8_t q=0; q<numQueries; q++){
+    queryV[q] = _mm256_set1_pd(query[q]);
+  }
+  uint32_t i=0;
+  for(; (i+4)<=numEntries; i+=4){
+    const char *ptr = (const char*)layout->base + (size_t)i*layout->stride;
+    const __m256d val = _mm256_sub_pd(_mm256_i64gather_pd((const double*)(const void*)(ptr + layout->valOffset),offsets,1),shiftV);
+    __m256d err;
+    if(layout->errIsDouble){
+      err = _mm256_i64gather_pd((const double*)(const void*)(ptr + layout->errOffset),offsets,1);
+    }else{
+      err = _mm256_cvtps_pd(_mm256_i64gather_ps((const float*)(const void*)(ptr + layout->errOffset),offsets,1));
+    }
+    err = _mm256_mul_pd(err,scaleV);
+    const __m256d lo = _mm256_sub_pd(val,err);
+    const __m256d hi = _mm256_add_pd(val,err);
+    for(uint8_t q=0; q<numQueries; q++){
+      const int bits = _mm256_movemask_pd(_mm256_and_pd(_mm256_cmp_pd(lo,queryV[q],_CMP_LE_OQ),_mm256_cmp_pd(hi,queryV[q],_CMP_GE_OQ)));
+      masks[q*numWords + i/64U] |= (uint64_t)bits << (i%64U); //i is a multiple of 4, so the bits never span 2 words
+    }
+  }
+  ewm_matchScalar(layout,i,numEntries,shift,errScale,query,numQueries,masks);
+}
+#endif
+
+static SDL_AtomicInt ewm_supportedImpls; //bit pattern of the implementations supported on this CPU (bit indices from ewm_impl_enum), 0 until detected
+
+//returns the bit pattern of the implementations supported on this CPU, which are only detected on the first call
+static uint32_t ewm_getSupportedImpls(void){
+  int supported = SDL_GetAtomicInt(&ewm_supportedImpls);
+  if(supported == 0){
+    supported = (1 << EWM_IMPL_SCALAR);
+    #ifdef SDL_AVX2_INTRINSICS
+      if(SDL_HasAVX2()){
+        supported |= (1 << EWM_IMPL_AVX2);
+      }
+    #endif
+    SDL_SetAtomicInt(&ewm_supportedImpls,supported); //threads detecting at the same time all store the same value
+  }
+  return (uint32_t)supported;
+}
+
+//returns 1 if the implementation can be used on this CPU (and was compiled in), 0 otherwise
+uint8_t ewm_isImplSupported(const uint8_t impl){
+  if(impl >= EWM_IMPL_ENUM_LENGTH){
+    return 0;
+  }
+  return (uint8_t)((ewm_getSupportedImpls() >> impl) & 1U);
+}
+
+//returns the fastest implementation supported on this CPU
+uint8_t ewm_getBestImpl(void){
+  if(ewm_isImplSupported(EWM_IMPL_AVX2)){
+    return EWM_IMPL_AVX2;
+  }
+  return EWM_IMPL_SCALAR;
+}
+
+const char *ewm_getImplName(const uint8_t impl){
+  switch(impl){
+    case EWM_IMPL_AVX2:
+      return "AVX2";
+    case EWM_IMPL_SCALAR:
+    default:
+      return "scalar";
+  }
+}
+
+//match a block of entries using a specific implementation (falls back to the scalar
+//implementation if the requested one isn't supported)
+void ewm_matchBlockImpl(const uint8_t impl, const ewm_layout *layout, const uint32_t numEntries, const double shift, const double errScale, const double *query, const uint8_t numQueries, uint64_t *masks){
+  if((numQueries == 0)||(numQueries > EWM_MAX_QUERIES)){
+    return; //invalid parameter
+  }
+  memset(masks,0,(size_t)numQueries*EWM_NUM_MASK_WORDS(numEntries)*sizeof(uint64_t));
+  if(ewm_isImplSupported(impl)){
+    switch(impl){
+      #ifdef SDL_AVX2_INTRINSICS
+      case EWM_IMPL_AVX2:
+        ewm_matchAVX2(layout,numEntries,shift,errScale,query,numQueries,masks);
+        return;
+      #endif
+      default:
+        break;
+    }
+  }
+  ewm_matchScalar(layout,0,numEntries,shift,errScale,query,numQueries,masks);
+}
+
+//match a block of entries using the fastest implementation supported on this CPU
+void ewm_matchBlock(const ewm_layout *layout, const uint32_t numEntries, const double shift, const double errScale, const double *query, const uint8_t numQueries, uint64_t *masks){
+  ewm_matchBlockImpl(ewm_getBestImpl(),layout,numEntries,shift,errScale,query,numQueries,masks);
+}
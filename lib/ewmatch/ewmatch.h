@@ -0,0 +1,47 @@
+#ifndef EWMATCH_H
+#define EWMATCH_H
+
+#include <stdlib.h>
+#include <stdint.h> //allows uint8_t and similiar types
+
+// Energy window matching library, used by the search agents.
+
+// Checks which values in a block of entries (eg. level or gamma-ray energies)
+// lie within their error bounds of one or more query values, ie. for which
+// (E - err) <= query <= (E + err), where E = value - shift and err = errBound*errScale.
+// Entries are read in place from an array of structs, so that the sorted indices
+// used by the search agents don't need to be copied.
+//
+// Results are returned as bitmasks: bit b of masks[q*EWM_NUM_MASK_WORDS(numEntries) + w]
+// is set if entry (w*64 + b) matches query q.
+//
+// An AVX2 implementation (gathering the entries in place) is used when the CPU supports it
+// (detected once, at the first call), with a scalar fallback. Both give identical results.
+// There is no SSE2 implementation, as without gather instructions the entries would have
+// to be loaded one at a time, which is no faster than the scalar implementation.
+
+#define EWM_MAX_QUERIES 8 //maximum number of query values matched at once
+#define EWM_NUM_MASK_WORDS(numEntries) (((numEntries) + 63U)/64U) //number of 64-bit mask words per query
+
+enum ewm_impl_enum{
+EWM_IMPL_SCALAR,
+EWM_IMPL_AVX2,
+EWM_IMPL_ENUM_LENGTH
+};
+
+typedef struct
+{
+  const void *base; //first entry
+  size_t stride; //size of each entry, in bytes
+  size_t valOffset; //offset of the value (double) within each entry, in bytes
+  size_t errOffset; //offset of the error bound (float or double) within each entry, in bytes
+  uint8_t errIsDouble; //0 if error bounds are float, 1 if double
+}ewm_layout; //describes where the values and error bounds are found
+
+uint8_t ewm_getBestImpl(void);
+uint8_t ewm_isImplSupported(const uint8_t impl);
+const char *ewm_getImplName(const uint8_t impl);
+void ewm_matchBlockImpl(const uint8_t impl, const ewm_layout *layout, const uint32_t numEntries, const double shift, const double errScale, const double *query, const uint8_t numQueries, uint64_t *masks);
+void ewm_matchBlock(const ewm_layout *layout, const uint32_t numEntries, const double shift, const double errScale, const double *query, const uint8_t numQueries, uint64_t *masks);
+
+#endif
@@ -0,0 +1,102 @@
+// Microbenchmark for the energy window matching library.
+// Compares the SIMD implementations against the scalar one on synthetic
+// data laid out like the sorted energy indices used by the search agents.
+// Build with 'make ewmatch_bench'.
+
+#include <stdio.h>
+#include <stddef.h> //offsetof
+#include <string.h>
+#include <SDL3/SDL.h>
+#include "ewmatch.h"
+
+#define BENCH_NUM_ENTRIES 300000
+#define BENCH_NUM_REPS    200
+
+typedef struct
+{
+  double energy;
+  float errBound;
+  uint32_t tranInd;
+  uint32_t lvlInd;
+  uint16_t nuclInd;
+}bench_entry; //same layout as the gamma-ray energy index entries
+
+int main(int argc, char *argv[]){
+
+  (void)argc;
+  (void)argv;
+
+  bench_entry *ent = (bench_entry*)malloc(BENCH_NUM_ENTRIES*sizeof(bench_entry));
+  uint64_t *masks = (uint64_t*)malloc(EWM_MAX_QUERIES*EWM_NUM_MASK_WORDS(BENCH_NUM_ENTRIES)*sizeof(uint64_t));
+  uint64_t *refMasks = (uint64_t*)malloc(EWM_MAX_QUERIES*EWM_NUM_MASK_WORDS(BENCH_NUM_ENTRIES)*sizeof(uint64_t));
+  if((ent == NULL)||(masks == NULL)||(refMasks == NULL)){
+    printf("ERROR: couldn't allocate memory.\n");
+    return -1;
+  }
+
+  //sorted energies up to ~10 MeV, with error bounds like those in the index
+  uint32_t seed = 12345;
+  double energy = 0.0;
+  for(uint32_t i=0; i<BENCH_NUM_ENTRIES; i++){
+    seed = seed*1664525U + 1013904223U;
+    energy += (double)(seed >> 8)/(double)(1U << 24)*0.066;
+    ent[i].energy = energy;
+    ent[i].errBound = (float)(3.0 + energy*0.005*(double)(seed & 255U)/255.0);
+    ent[i].tranInd = i;
+    ent[i].lvlInd = i;
+    ent[i].nuclInd = 0;
+  }
+  ewm_layout layout;
+  layout.base = ent;
+  layout.stride = sizeof(bench_entry);
+  layout.valOffset = offsetof(bench_entry,energy);
+  layout.errOffset = offsetof(bench_entry,errBound);
+  layout.errIsDouble = 0;
+
+  double query[EWM_MAX_QUERIES];
+  for(uint8_t q=0; q<EWM_MAX_QUERIES; q++){
+    query[q] = 1000.0 + 1.7*q;
+  }
+
+  printf("Best implementation on this CPU: %s\n",ewm_getImplName(ewm_getBestImpl()));
+  const uint32_t blockSizes[3] = {256,4096,BENCH_NUM_ENTRIES};
+  const uint8_t numQueries[3] = {1,4,EWM_MAX_QUERIES};
+  for(uint8_t b=0; b<3; b++){
+    for(uint8_t nq=0; nq<3; nq++){
+      const uint32_t numReps = (uint32_t)(BENCH_NUM_REPS*(BENCH_NUM_ENTRIES/blockSizes[b]));
+      const size_t maskSize = (size_t)numQueries[nq]*EWM_NUM_MASK_WORDS(blockSizes[b])*sizeof(uint64_t);
+      double scalarNs = 0.0;
+      for(uint8_t impl=0; impl<EWM_IMPL_ENUM_LENGTH; impl++){
+        if(!ewm_isImplSupported(impl)){
+          printf("%7u entries, %u queries: %-6s not supported\n",blockSizes[b],numQueries[nq],ewm_getImplName(impl));
+          continue;
+        }
+        uint64_t checksum = 0;
+        const Uint64 startTime = SDL_GetTicksNS();
+        for(uint32_t r=0; r<numReps; r++){
+          //move the block around so that it isn't always in cache
+          layout.base = &ent[(r*7919U) % (BENCH_NUM_ENTRIES - blockSizes[b] + 1)];
+          ewm_matchBlockImpl(impl,&layout,blockSizes[b],0.0,1.0,query,numQueries[nq],masks);
+          checksum += masks[0];
+        }
+        const double nsPerEntry = (double)(SDL_GetTicksNS() - startTime)/((double)numReps*(double)blockSizes[b]);
+        if(impl == EWM_IMPL_SCALAR){
+          scalarNs = nsPerEntry;
+        }
+
+        //check that the results are identical to the scalar implementation
+        layout.base = &ent[BENCH_NUM_ENTRIES - blockSizes[b]];
+        ewm_matchBlockImpl(EWM_IMPL_SCALAR,&layout,blockSizes[b],0.0,5.0,query,numQueries[nq],refMasks);
+        ewm_matchBlockImpl(impl,&layout,blockSizes[b],0.0,5.0,query,numQueries[nq],masks);
+        const int identical = (memcmp(masks,refMasks,maskSize) == 0);
+
+        printf("%7u entries, %u queries: %-6s %6.3f ns/entry, speedup %5.2fx%s (checksum %llu)\n",blockSizes[b],numQueries[nq],ewm_getImplName(impl),nsPerEntry,scalarNs/nsPerEntry,identical ? "" : " MISMATCH",(unsigned long long)checksum);
+      }
+    }
+  }
+
+  free(ent);
+  free(masks);
+  free(refMasks);
+  return 0;
+}
@@ -41,13 +41,21 @@ void shutdownApp(const global_data *gdat, const uint8_t skipDealloc){
 
 int main(int argc, char *argv[]){
 
-  (void)argc; (void)argv; //required main function parameters are unused
   setlocale(LC_ALL, "en_ca.UTF-8");
 
   #ifdef __MINGW32__
   setbuf(stdout,NULL); //needed to show printf output on Windows
   #endif
 
+  //command line query mode, search without opening a window (see cli_query.c)
+  cli_query_args queryArgs;
+  const int queryMode = parseCLIQueryArgs(argc,argv,&queryArgs);
+  if(queryMode < 0){
+    return 1; //invalid arguments
+  }else if(queryMode > 0){
+    return runCLIQuery(&queryArgs);
+  }
+
   /*for(i=0;i<SDL_GetNumVideoDrivers();i++){
     SDL_Log("Video driver available: %s\n",SDL_GetVideoDriver(i));
   }*/
@@ -182,12 +190,20 @@ int main(int argc, char *argv[]){
     processFrameEvents(&gdat->dat,&gdat->state,&gdat->rdat); //can block the main thread to save CPU, see process_events.h
     
     if(gdat->state.searchStrUpdated){
-      if(gdat->state.ss.searchInProgress == SEARCHSTATE_NOTSEARCHING){
-        gdat->state.searchStrUpdated = 0; //reset flag
-        //start the search
-        if(startSearchThreads(&gdat->dat,&gdat->state,&gdat->tms)<0){
-          gdat->state.ss.searchInProgress = SEARCHSTATE_NOTSEARCHING; //unable to start search
-        }
+      gdat->state.searchStrUpdated = 0; //reset flag
+      if(gdat->state.ss.searchInProgress != SEARCHSTATE_NOTSEARCHING){
+        //the query changed during a search, stop the search tasks (discarding their
+        //results), the new search starts as soon as they have dropped out
+        cancelSearchThreads(&gdat->state,&gdat->tms); //thread_manager.c
+      }
+      //start the search
+      const int numSearchThreads = startSearchThreads(&gdat->dat,&gdat->state,&gdat->tms);
+      if(numSearchThreads<0){
+        gdat->state.ss.searchInProgress = SEARCHSTATE_NOTSEARCHING; //unable to start search
+      }else if(numSearchThreads==0){
+        //results were available without searching (or there is nothing to search for)
+        updateSearchUIState(&gdat->dat,&gdat->state,&gdat->rdat);
+        gdat->state.ds.forceRedraw = 1;
       }
     }
     //SDL_RenderClear(gdat->rdat.renderer); //clear the window, disabled for optimization purposes
@@ -208,6 +224,12 @@ int main(int argc, char *argv[]){
     }
 
   }
+
+  //don't exit until any screenshots waiting to be saved have been written
+  cancelSearchThreads(&gdat->state,&gdat->tms); //so that the thread pool doesn't wait for a search to finish
+  finishScreenshotSaves(&gdat->dat,&gdat->state,&gdat->rdat,&gdat->tms); //thread_manager.c
+  stopThreadPool(&gdat->tms);
+  freeSearchState(&gdat->state.ss); //search_ops.c
   
   shutdownApp(gdat,0);
 
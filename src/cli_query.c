@@ -0,0 +1,386 @@
+/*
+Copyright (C) 2017-2026 J. Williams
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+/* Functions handling the command line query mode, which runs a single search
+without a window and prints the results (eg. for scripted lookups) */
+
+#include "cli_query.h"
+#include "load_data.h"
+#include "data_ops.h"
+#include "thread_manager.h"
+#include "search_ops.h"
+
+static void printCLIQueryUsage(void){
+  fprintf(stderr,"Usage: chart --query \"<search string>\" [--format tsv|json] [--limit N] [--time]\n");
+  fprintf(stderr,"  --query   search string, using the same syntax as the search box\n");
+  fprintf(stderr,"  --format  output format (default: tsv)\n");
+  fprintf(stderr,"  --limit   maximum number of results to print (1 to %u, default: %u)\n",MAX_SEARCH_RESULTS,MAX_SEARCH_RESULTS);
+  fprintf(stderr,"  --time    report the data load and search times (in ms)\n");
+}
+
+//parses the command line arguments for the query mode
+//returns 1 if a query was given, 0 if the GUI should be started instead, or -1 on invalid arguments
+int parseCLIQueryArgs(int argc, char *argv[], cli_query_args *restrict args){
+
+  uint8_t queryGiven = 0;
+  for(int i=1; i<argc; i++){
+    if(strcmp(argv[i],"--query")==0){
+      queryGiven = 1;
+    }
+  }
+  if(!queryGiven){
+    return 0; //other arguments are ignored when starting the GUI
+  }
+
+  SDL_memset(args,0,sizeof(cli_query_args));
+  args->format = CLIFORMAT_TSV;
+  args->limit = MAX_SEARCH_RESULTS;
+  args->showTiming = 0;
+  for(int i=1; i<argc; i++){
+    if(strcmp(argv[i],"--time")==0){
+      args->showTiming = 1;
+    }else if((strcmp(argv[i],"--query")==0)||(strcmp(argv[i],"--format")==0)||(strcmp(argv[i],"--limit")==0)){
+      if((i+1)>=argc){
+        fprintf(stderr,"ERROR: missing value for %s.\n",argv[i]);
+        printCLIQueryUsage();
+        return -1;
+      }
+      const char *val = argv[i+1];
+      if(strcmp(argv[i],"--query")==0){
+        if(strlen(val) >= SEARCH_STRING_MAX_SIZE){
+          fprintf(stderr,"ERROR: search string is too long (maximum %u characters).\n",SEARCH_STRING_MAX_SIZE-1);
+          return -1;
+        }
+        SDL_strlcpy(args->searchString,val,SEARCH_STRING_MAX_SIZE);
+      }else if(strcmp(argv[i],"--format")==0){
+        if(strcmp(val,"tsv")==0){
+          args->format = CLIFORMAT_TSV;
+        }else if(strcmp(val,"json")==0){
+          args->format = CLIFORMAT_JSON;
+        }else{
+          fprintf(stderr,"ERROR: unknown output format '%s'.\n",val);
+          printCLIQueryUsage();
+          return -1;
+        }
+      }else{
+        char *end = NULL;
+        const long limit = SDL_strtol(val,&end,10);
+        if((end == val)||(*end != '\0')||(limit < 1)||(limit > MAX_SEARCH_RESULTS)){
+          fprintf(stderr,"ERROR: invalid result limit '%s'.\n",val);
+          printCLIQueryUsage();
+          return -1;
+        }
+        args->limit = (uint8_t)limit;
+      }
+      i++; //skip the value
+    }else{
+      fprintf(stderr,"ERROR: unknown argument '%s'.\n",argv[i]);
+      printCLIQueryUsage();
+      return -1;
+    }
+  }
+  if(strlen(args->searchString)==0){
+    fprintf(stderr,"ERROR: empty search string.\n");
+    return -1;
+  }
+
+  return 1;
+}
+
+static const char *getCLIResultTypeStr(const uint8_t resultType){
+  switch(resultType){
+    case SEARCHAGENT_NUCLIDE:
+      return "nuclide";
+    case SEARCHAGENT_EGAMMA:
+      return "gamma";
+    case SEARCHAGENT_ELEVEL:
+      return "level";
+    case SEARCHAGENT_ELEVELDIFF:
+      return "level_diff";
+    case SEARCHAGENT_GAMMACASCADE:
+      return "cascade";
+    case SEARCHAGENT_HALFLIFE:
+      return "half_life";
+    case SEARCHAGENT_COMMENT:
+      return "comment";
+    case SEARCHAGENT_REACTION:
+      return "reaction";
+    case SEARCHAGENT_SPINPAR:
+      return "spin_parity";
+    default:
+      return "unknown";
+  }
+}
+
+static const char *getCLIColumnName(const uint8_t col){
+  switch(col){
+    case CLICOL_TYPE:
+      return "type";
+    case CLICOL_NUCLIDE:
+      return "nuclide";
+    case CLICOL_ELEVEL:
+      return "level_energy_keV";
+    case CLICOL_EGAMMA:
+      return "gamma_energy_keV";
+    case CLICOL_IGAMMA:
+      return "gamma_intensity";
+    case CLICOL_HALFLIFE:
+      return "half_life";
+    case CLICOL_DETAIL:
+    default:
+      return "detail";
+  }
+}
+
+//copies a decoded value into an output field, without the leading spaces used to align values in the UI
+static void setCLIField(char field[CLI_FIELD_STR_LEN], const char *str){
+  while(*str == ' '){
+    str++;
+  }
+  SDL_strlcpy(field,str,CLI_FIELD_STR_LEN);
+}
+
+//decodes a search result into strings for each output column (empty if not applicable),
+//using the same fields as the search menu (see drawSearchMenu in gui.c)
+static void getCLIResultFields(const app_data *restrict dat, const app_state *restrict state, const search_result *restrict res, char fields[CLICOL_ENUM_LENGTH][CLI_FIELD_STR_LEN]){
+
+  char tmpStr[32];
+  const ndata *nd = &dat->ndat;
+  const uint16_t nuclInd = (uint16_t)res->resultVal[0];
+  uint32_t lvlInd = MAX_UINT32_VAL;
+  uint32_t tranInd = MAX_UINT32_VAL;
+
+  for(uint8_t i=0; i<CLICOL_ENUM_LENGTH; i++){
+    fields[i][0] = '\0';
+  }
+  SDL_strlcpy(fields[CLICOL_TYPE],getCLIResultTypeStr(res->resultType),CLI_FIELD_STR_LEN);
+  if(nuclInd >= nd->numNucl){
+    return; //invalid result
+  }
+  getNuclNameStrASCII(tmpStr,&nd->nuclData[nuclInd],255);
+  setCLIField(fields[CLICOL_NUCLIDE],tmpStr);
+
+  switch(res->resultType){
+    case SEARCHAGENT_NUCLIDE:
+      getGSHalfLifeStr(tmpStr,dat,nuclInd,state->ds.useLifetimes);
+      setCLIField(fields[CLICOL_HALFLIFE],tmpStr);
+      if(nd->nuclData[nuclInd].abundance.val > 0.0f){
+        getAbundanceStr(tmpStr,nd,nuclInd);
+        SDL_snprintf(fields[CLICOL_DETAIL],CLI_FIELD_STR_LEN,"abundance %s",tmpStr);
+      }
+      break;
+    case SEARCHAGENT_EGAMMA:
+      tranInd = res->resultVal[1];
+      lvlInd = res->resultVal[2];
+      if(res->resultVal[3] == 511){
+        SDL_strlcpy(fields[CLICOL_DETAIL],dat->strings[dat->locStringIDs[LOCSTR_SINGLE_ESCAPE]],CLI_FIELD_STR_LEN);
+      }else if(res->resultVal[3] == 1022){
+        SDL_strlcpy(fields[CLICOL_DETAIL],dat->strings[dat->locStringIDs[LOCSTR_DOUBLE_ESCAPE]],CLI_FIELD_STR_LEN);
+      }
+      break;
+    case SEARCHAGENT_ELEVEL:
+    case SEARCHAGENT_HALFLIFE:
+      lvlInd = res->resultVal[1];
+      break;
+    case SEARCHAGENT_ELEVELDIFF:
+      lvlInd = res->resultVal[2];
+      if(res->resultVal[1] < nd->numLvls){
+        getLvlEnergyStr(tmpStr,nd,res->resultVal[1],1);
+        SDL_snprintf(fields[CLICOL_DETAIL],CLI_FIELD_STR_LEN,"%0.1f keV above the %s keV level",getLevelEnergykeV(nd,res->resultVal[2])-getLevelEnergykeV(nd,res->resultVal[1]),tmpStr);
+      }
+      break;
+    case SEARCHAGENT_GAMMACASCADE:
+      {//prevent -Wjump-misses-init
+        size_t length = 0;
+        for(uint8_t j=1; j<SEARCH_RESULT_DATASIZE; j++){
+          if((res->resultVal[j] == UNUSED_SEARCH_RESULT)||(res->resultVal[j] >= nd->numTran)){
+            break;
+          }
+          getGammaEnergyStr(tmpStr,nd,res->resultVal[j],0);
+          length += (size_t)SDL_snprintf(fields[CLICOL_DETAIL]+length,CLI_FIELD_STR_LEN-length,"%s%s",(j>1) ? ", " : "",tmpStr);
+          if(length >= CLI_FIELD_STR_LEN){
+            break; //truncated
+          }
+        }
+        if(length > 0){
+          SDL_strlcat(fields[CLICOL_DETAIL]," keV cascade",CLI_FIELD_STR_LEN);
+        }
+      }
+      break;
+    case SEARCHAGENT_COMMENT:
+      lvlInd = res->resultVal[1];
+      if(res->resultVal[2] != MAX_UINT32_VAL){
+        tranInd = res->resultVal[2]; //transition comment
+      }
+      if(res->resultVal[3] < ENSDFSTRBUFSIZE){
+        SDL_strlcpy(fields[CLICOL_DETAIL],&nd->ensdfStrBuf[res->resultVal[3]],CLI_FIELD_STR_LEN);
+      }
+      break;
+    case SEARCHAGENT_SPINPAR:
+      lvlInd = res->resultVal[1];
+      if(lvlInd < nd->numLvls){
+        getSpinParStr(tmpStr,nd,lvlInd);
+        SDL_snprintf(fields[CLICOL_DETAIL],CLI_FIELD_STR_LEN,"Jpi = %s",tmpStr);
+      }
+      break;
+    case SEARCHAGENT_REACTION:
+      getRxnStr(tmpStr,nd,nd->nuclData[nuclInd].firstRxn + res->resultVal[1]);
+      setCLIField(fields[CLICOL_DETAIL],tmpStr);
+      break;
+    default:
+      break;
+  }
+
+  if(lvlInd < nd->numLvls){
+    getLvlEnergyStr(tmpStr,nd,lvlInd,1);
+    setCLIField(fields[CLICOL_ELEVEL],tmpStr);
+    getHalfLifeStr(tmpStr,dat,lvlInd,1,0,state->ds.useLifetimes);
+    setCLIField(fields[CLICOL_HALFLIFE],tmpStr);
+  }
+  if(tranInd < nd->numTran){
+    getGammaEnergyStr(tmpStr,nd,tranInd,1);
+    setCLIField(fields[CLICOL_EGAMMA],tmpStr);
+    getGammaIntensityStr(tmpStr,nd,tranInd,1);
+    setCLIField(fields[CLICOL_IGAMMA],tmpStr);
+  }
+}
+
+//prints a string as a TSV field (tabs and line breaks would split the field, so they are replaced by spaces)
+static void printTSVStr(const char *str){
+  for(size_t i=0; str[i]!='\0'; i++){
+    if((str[i]=='\t')||(str[i]=='\n')||(str[i]=='\r')){
+      fputc(' ',stdout);
+    }else{
+      fputc(str[i],stdout);
+    }
+  }
+}
+
+//prints a string as a quoted JSON string (UTF-8 characters are passed through unchanged)
+static void printJSONStr(const char *str){
+  fputc('"',stdout);
+  for(size_t i=0; str[i]!='\0'; i++){
+    const unsigned char c = (unsigned char)str[i];
+    if((c=='"')||(c=='\\')){
+      fputc('\\',stdout);
+      fputc(c,stdout);
+    }else if(c < 0x20U){
+      fprintf(stdout,"\\u%04x",c);
+    }else{
+      fputc(c,stdout);
+    }
+  }
+  fputc('"',stdout);
+}
+
+static void printCLIQueryResults(const app_data *restrict dat, const app_state *restrict state, const cli_query_args *restrict args, const Uint64 loadTime, const Uint64 searchTime){
+
+  char fields[CLICOL_ENUM_LENGTH][CLI_FIELD_STR_LEN];
+  const uint8_t numResults = (state->ss.numResults < args->limit) ? state->ss.numResults : args->limit;
+
+  if(args->format == CLIFORMAT_JSON){
+    fprintf(stdout,"{\"query\":");
+    printJSONStr(args->searchString);
+    if(args->showTiming){
+      fprintf(stdout,",\"load_ms\":%.3f,\"search_ms\":%.3f",(double)loadTime/1.0E6,(double)searchTime/1.0E6);
+    }
+    fprintf(stdout,",\"num_results\":%u,\"results\":[",numResults);
+    for(uint8_t i=0; i<numResults; i++){
+      getCLIResultFields(dat,state,&state->ss.results[i],fields);
+      fprintf(stdout,"%s\n{\"rank\":%u",(i>0) ? "," : "",(unsigned int)(i+1));
+      for(uint8_t j=0; j<CLICOL_ENUM_LENGTH; j++){
+        fprintf(stdout,",\"%s\":",getCLIColumnName(j));
+        printJSONStr(fields[j]);
+      }
+      fprintf(stdout,",\"relevance\":%.4f}",(double)state->ss.results[i].relevance);
+    }
+    fprintf(stdout,"]}\n");
+  }else{
+    fprintf(stdout,"rank");
+    for(uint8_t j=0; j<CLICOL_ENUM_LENGTH; j++){
+      fprintf(stdout,"\t%s",getCLIColumnName(j));
+    }
+    fprintf(stdout,"\trelevance\n");
+    for(uint8_t i=0; i<numResults; i++){
+      getCLIResultFields(dat,state,&state->ss.results[i],fields);
+      fprintf(stdout,"%u",(unsigned int)(i+1));
+      for(uint8_t j=0; j<CLICOL_ENUM_LENGTH; j++){
+        fputc('\t',stdout);
+        printTSVStr(fields[j]);
+      }
+      fprintf(stdout,"\t%.4f\n",(double)state->ss.results[i].relevance);
+    }
+    if(args->showTiming){
+      //timing goes to stderr, so that the output stays a single table
+      fprintf(stderr,"load_ms\t%.3f\nsearch_ms\t%.3f\n",(double)loadTime/1.0E6,(double)searchTime/1.0E6);
+    }
+  }
+  fflush(stdout);
+}
+
+//runs a single search without a window, using the same search agents and thread pool
+//as the GUI, and prints the results to stdout
+//returns the exit code of the program
+int runCLIQuery(const cli_query_args *restrict args){
+
+  SDL_SetLogPriorities(SDL_LOG_PRIORITY_WARN); //keep informational messages out of the output
+
+  global_data *gdat=(global_data*)SDL_calloc(1,sizeof(global_data));
+  if(gdat==NULL){
+    SDL_LogError(SDL_LOG_CATEGORY_APPLICATION,"runCLIQuery - could not allocate application data structure.\n");
+    return 1;
+  }
+  int retVal = 0;
+  Uint64 loadTime, searchTime;
+  gdat->rdat.appPrefPath = SDL_GetPrefPath("ChartOfNuclides","chart"); //one of the locations searched for the app data file
+  initializeTempState(&gdat->dat,&gdat->state,&gdat->rdat,&gdat->tms); //data_ops.c
+  gdat->state.ss.resultsEventType = 0; //no event loop to wake, the search is waited on below
+  //user preferences (chart.ini) aren't read, so that the results don't depend on the GUI settings
+
+  //load the nuclear data only (no window, renderer, fonts, or UI themes)
+  const Uint64 loadStartTime = SDL_GetTicksNS();
+  if(importAppDataHeadless(&gdat->dat,&gdat->rdat)!=0){
+    fprintf(stderr,"ERROR: couldn't load app data file (chart.dat).\n");
+    retVal = 1;
+    goto cleanup;
+  }
+  loadTime = SDL_GetTicksNS() - loadStartTime;
+
+  //search
+  SDL_strlcpy(gdat->state.ss.searchString,args->searchString,SEARCH_STRING_MAX_SIZE);
+  const Uint64 searchStartTime = SDL_GetTicksNS();
+  if(startSearchThreads(&gdat->dat,&gdat->state,&gdat->tms)<0){
+    fprintf(stderr,"ERROR: couldn't start search.\n");
+    retVal = 1;
+    goto cleanup;
+  }
+  while(gdat->state.ss.searchInProgress != SEARCHSTATE_NOTSEARCHING){
+    waitForSearchTasks(&gdat->tms); //sleep until the search tasks are finished
+    updateThreads(&gdat->dat,&gdat->state,&gdat->rdat,&gdat->tms); //merges the results
+  }
+  searchTime = SDL_GetTicksNS() - searchStartTime;
+
+  printCLIQueryResults(&gdat->dat,&gdat->state,args,loadTime,searchTime);
+
+  cleanup:
+  stopThreadPool(&gdat->tms);
+  freeSearchState(&gdat->state.ss);
+  SDL_free(gdat->rdat.appPrefPath);
+  SDL_free(gdat);
+
+  return retVal;
+}
@@ -105,7 +105,25 @@ void initializeTempState(const app_data *restrict dat, app_state *restrict state
 	state->cms.numContextMenuItems = 0;
 	state->ss.numResults = 0;
 	state->ss.searchInProgress = SEARCHSTATE_NOTSEARCHING;
-	state->ss.canUpdateResults = SDL_CreateSemaphore(1);
+	SDL_SetAtomicInt(&state->ss.searchGeneration,0);
+	state->ss.runningSearchGeneration = 0;
+	SDL_SetAtomicInt(&state->ss.publishedResultsInd,0);
+	SDL_SetAtomicInt(&state->ss.numPublishedResults,0);
+	state->ss.numShownPublishedResults = 0;
+	state->ss.publishLock = 0;
+	state->ss.completeThreadResults = 0;
+	state->ss.publishedThreadResults = 0;
+	state->ss.threadResults = (search_thread_output*)SDL_aligned_alloc(CACHE_LINE_SIZE,NUM_SEARCH_THREADS*sizeof(search_thread_output));
+	state->ss.mergeHeaps = (search_result_heap*)SDL_malloc((NUM_SEARCH_THREADS+1)*sizeof(search_result_heap));
+	if((state->ss.threadResults == NULL)||(state->ss.mergeHeaps == NULL)){
+		SDL_LogError(SDL_LOG_CATEGORY_APPLICATION,"initializeTempState - couldn't allocate search thread results.\n");
+		exit(-1);
+	}
+	SDL_memset(state->ss.threadResults,0,NUM_SEARCH_THREADS*sizeof(search_thread_output));
+	state->ss.resultsEventType = SDL_RegisterEvents(1);
+	if(state->ss.resultsEventType == 0){
+		SDL_LogWarn(SDL_LOG_CATEGORY_APPLICATION,"initializeTempState - couldn't register search event: %s",SDL_GetError());
+	}
 	clearSelectionStrs(&state->ds,&state->tss,0,0);
 	SDL_memset(state->ds.uiElemExtPlusX,0,sizeof(state->ds.uiElemExtPlusX));
 	SDL_memset(state->ds.uiElemExtPlusY,0,sizeof(state->ds.uiElemExtPlusY));
@@ -119,6 +137,9 @@ void initializeTempState(const app_data *restrict dat, app_state *restrict state
 	for(uint8_t i=0;i<MAX_NUM_THREADS;i++){
 		tms->threadData[i].threadState = THREADSTATE_DEAD;
 	}
+	tms->numThreads = 0; //thread pool is started by the first search
+	tms->masterThreadState = THREADSTATE_IDLE;
+	SDL_memset(&tms->queue,0,sizeof(tms->queue));
 
 	//check that constants are valid
 	if(UIELEM_ENUM_LENGTH > /* DISABLES CODE */ (128)){
@@ -130,7 +151,15 @@ void initializeTempState(const app_data *restrict dat, app_state *restrict state
 		exit(-1);
 	}
 	if(SEARCHAGENT_ENUM_LENGTH > /* DISABLES CODE */ (32)){
-		SDL_LogError(SDL_LOG_CATEGORY_APPLICATION,"search_agent_enum is too long, cannot be indexed by a uint32_t bit pattern (ss->finishedSearchAgents)!\n");
+		SDL_LogError(SDL_LOG_CATEGORY_APPLICATION,"search_agent_enum is too long, cannot be indexed by a uint32_t bit pattern (tms->queue.finishedTasks)!\n");
+		exit(-1);
+	}
+	if(NUM_SEARCH_THREADS > /* DISABLES CODE */ (31)){
+		SDL_LogError(SDL_LOG_CATEGORY_APPLICATION,"NUM_SEARCH_THREADS is too large, search thread results cannot be indexed by a uint32_t bit pattern (ss->completeThreadResults)!\n");
+		exit(-1);
+	}
+	if(NUM_SEARCH_THREADS > /* DISABLES CODE */ (MAX_NUM_THREAD_TASKS)){
+		SDL_LogError(SDL_LOG_CATEGORY_APPLICATION,"NUM_SEARCH_THREADS is too large, search tasks cannot fit in the thread pool's task queue (tms->queue)!\n");
 		exit(-1);
 	}
 	if(FONTSIZE_ENUM_LENGTH > /* DISABLES CODE */ (16)){
@@ -154,6 +183,7 @@ void initializeTempState(const app_data *restrict dat, app_state *restrict state
 
 //callback for saving screenshots
 //userdata points to the application resource_data
+//(the screenshot is encoded and saved by the thread pool, see updateThreads)
 void saveScreenshotCallback(void *userdata, const char * const *filelist, int filter){
 	(void)filter; //unused for now
 
@@ -163,39 +193,46 @@ void saveScreenshotCallback(void *userdata, const char * const *filelist, int fi
 		if(filelist){
 			//loop through all files
 			while(*filelist){
-				char fileName[256];
 				//handle string format returned by file dialog
 				if(strncmp(*filelist,"file://",7)==0){
-					SDL_strlcpy(fileName,(*filelist)+7,255);
+					SDL_strlcpy(rdat->ssdat.fileName,(*filelist)+7,255);
 				}else{
-					SDL_strlcpy(fileName,(*filelist),255);
+					SDL_strlcpy(rdat->ssdat.fileName,(*filelist),255);
 				}
-				//SDL_Log("Filename: %s\n",fileName);
+				//SDL_Log("Filename: %s\n",rdat->ssdat.fileName);
 				//check for file extension
-				const char *dot = SDL_strrchr(fileName,'.');
+				const char *dot = SDL_strrchr(rdat->ssdat.fileName,'.');
 				if((dot==NULL)||(SDL_strcmp(dot,".png")!=0)){
-					SDL_strlcat(fileName,".png",255);
-				}
-				//SDL_Log("Filename: %s\n",fileName);
-
-				if(IMG_SavePNG(rdat->ssdat.screenshot,fileName) == false){
-					SDL_LogWarn(SDL_LOG_CATEGORY_APPLICATION,"saveScreenshotCallback - error saving PNG file: %s",SDL_GetError());
-					break;
+					SDL_strlcat(rdat->ssdat.fileName,".png",255);
 				}
-				
-				break; //only one filename can be provided
+				//SDL_Log("Filename: %s\n",rdat->ssdat.fileName);
+				rdat->ssdat.takingScreenshot = 3; //file chosen, save the screenshot
+				return;
 			}
 		}else{
 			SDL_LogWarn(SDL_LOG_CATEGORY_APPLICATION,"saveScreenshotCallback - file selection error: %s",SDL_GetError());
 		}
 		SDL_DestroySurface(rdat->ssdat.screenshot);
+		rdat->ssdat.screenshot = NULL;
 	}
 
 	rdat->ssdat.takingScreenshot = 0; //no longer taking a screenshot
-  //successfully saved file
   //changeUIState(((app_state*)userdata),UISTATE_DRAWAREAONLY); //make buttons interactable again
 }
 
+//encodes and saves a screenshot which is being saved (ssdat->savingScreenshot), then frees it
+//run by the thread pool, returns 0 if successful, -1 otherwise
+int saveScreenshot(screenshot_data *ssdat){
+	int retVal = 0;
+	if(IMG_SavePNG(ssdat->savingScreenshot,ssdat->savingFileName) == false){
+		SDL_LogWarn(SDL_LOG_CATEGORY_APPLICATION,"saveScreenshot - error saving PNG file: %s",SDL_GetError());
+		retVal = -1;
+	}
+	SDL_DestroySurface(ssdat->savingScreenshot);
+	ssdat->savingScreenshot = NULL;
+	return retVal;
+}
+
 void takeScreenshot(resource_data *restrict rdat){
 	rdat->ssdat.takingScreenshot = 2; //currently taking a screenshot
 	rdat->ssdat.screenshot = SDL_RenderReadPixels(rdat->renderer,NULL);
@@ -1222,483 +1259,168 @@ void getNuclNameStr(char strOut[32], const nucl *restrict nuclide, const uint8_t
 	SDL_free(nameStrCpy);
 }
 
+//same layout as getNuclNameStr, but in plain ASCII (no superscripts)
+//isomerMVal = 255 for non-isomers, 0 for isomers where the m-index is not drawn
+void getNuclNameStrASCII(char strOut[32], const nucl *restrict nuclide, const uint8_t isomerMVal){
+	if((nuclide->Z + nuclide->N) <= 1){
+		SDL_snprintf(strOut,32,"%s",getElemStr((uint8_t)(nuclide->Z)));
+	}else if(isomerMVal == 255){
+		SDL_snprintf(strOut,32,"%u%s",nuclide->Z + nuclide->N,getElemStr((uint8_t)(nuclide->Z)));
+	}else if(isomerMVal == 0){
+		SDL_snprintf(strOut,32,"%um%s",nuclide->Z + nuclide->N,getElemStr((uint8_t)(nuclide->Z)));
+	}else{
+		SDL_snprintf(strOut,32,"%um%u%s",nuclide->Z + nuclide->N,isomerMVal,getElemStr((uint8_t)(nuclide->Z)));
+	}
+}
+
+//converts a string to the form used as a key in the nuclide name index:
+//lowercase letters and digits only, all other characters (separators,
+//UTF-8 sequences) are dropped, returns the length of the key
+uint8_t getNuclNameIdxKey(char keyOut[NUCL_NAME_IDX_STR_LEN], const char *str){
+	uint8_t len = 0;
+	for(size_t i=0; str[i]!='\0'; i++){
+		if(len >= (NUCL_NAME_IDX_STR_LEN-1)){
+			break;
+		}
+		const char c = str[i];
+		if((c >= '0')&&(c <= '9')){
+			keyOut[len] = c;
+			len++;
+		}else if((c >= 'a')&&(c <= 'z')){
+			keyOut[len] = c;
+			len++;
+		}else if((c >= 'A')&&(c <= 'Z')){
+			keyOut[len] = (char)(c - 'A' + 'a');
+			len++;
+		}
+	}
+	keyOut[len] = '\0';
+	return len;
+}
+
+//returns the code of the trigram ending at position pos of a nuclide name
+//index key, with the start of the key padded (so that a key of length n
+//has n trigrams)
+uint32_t getNuclNameTrigramCode(const char *key, const uint8_t pos){
+	uint32_t code = 0;
+	for(int8_t i=(int8_t)(pos-2); i<=(int8_t)pos; i++){
+		uint32_t charCode = 0; //start padding
+		if(i >= 0){
+			if((key[i] >= '0')&&(key[i] <= '9')){
+				charCode = (uint32_t)(key[i] - '0') + 1;
+			}else{
+				charCode = (uint32_t)(key[i] - 'a') + 11;
+			}
+		}
+		code = code*NUCL_NAME_TRIGRAM_CHARS + charCode;
+	}
+	return code;
+}
+
+//element symbol lookup table, indexed by [first character - 'A'][0 for one-character
+//symbols, otherwise second character - 'a' + 1], 255 if no such element
+static const uint8_t elemSymbolZ[26][27] = {
+	{255,255,255,89,255,255,255,47,255,255,255,255,13,95,255,255,255,255,18,33,85,79,255,255,255,255,255}, //A
+	{5,56,255,255,255,4,255,255,107,83,255,97,255,255,255,255,255,255,35,255,255,255,255,255,255,255,255}, //B
+	{6,20,255,255,48,58,98,255,255,255,255,255,17,96,112,27,255,255,24,55,255,29,255,255,255,255,255}, //C
+	{255,255,105,255,255,255,255,255,255,255,255,255,255,255,255,255,255,255,255,110,255,255,255,255,255,66,255}, //D
+	{255,255,255,255,255,255,255,255,255,255,255,255,255,255,255,255,255,255,68,99,255,63,255,255,255,255,255}, //E
+	{9,255,255,255,255,26,255,255,255,255,255,255,114,100,255,255,255,255,87,255,255,255,255,255,255,255,255}, //F
+	{255,31,255,255,64,32,255,255,255,255,255,255,255,255,255,255,255,255,255,255,255,255,255,255,255,255,255}, //G
+	{1,255,255,255,255,2,72,80,255,255,255,255,255,255,255,67,255,255,255,108,255,255,255,255,255,255,255}, //H
+	{53,255,255,255,255,255,255,255,255,255,255,255,255,255,49,255,255,255,77,255,255,255,255,255,255,255,255}, //I
+	{255,255,255,255,255,255,255,255,255,255,255,255,255,255,255,255,255,255,255,255,255,255,255,255,255,255,255}, //J
+	{19,255,255,255,255,255,255,255,255,255,255,255,255,255,255,255,255,255,36,255,255,255,255,255,255,255,255}, //K
+	{255,57,255,255,255,255,255,255,255,3,255,255,255,255,255,255,255,255,103,255,255,71,116,255,255,255,255}, //L
+	{255,255,255,115,101,255,255,12,255,255,255,255,255,255,25,42,255,255,255,255,109,255,255,255,255,255,255}, //M
+	{7,11,41,255,60,10,255,255,113,28,255,255,255,255,255,102,93,255,255,255,255,255,255,255,255,255,255}, //N
+	{8,255,255,255,255,255,255,118,255,255,255,255,255,255,255,255,255,255,255,76,255,255,255,255,255,255,255}, //O
+	{15,91,82,255,46,255,255,255,255,255,255,255,255,61,255,84,255,255,59,255,78,94,255,255,255,255,255}, //P
+	{255,255,255,255,255,255,255,255,255,255,255,255,255,255,255,255,255,255,255,255,255,255,255,255,255,255,255}, //Q
+	{255,88,37,255,255,75,104,111,45,255,255,255,255,255,86,255,255,255,255,255,255,44,255,255,255,255,255}, //R
+	{16,255,51,21,255,34,255,106,255,14,255,255,255,62,50,255,255,255,38,255,255,255,255,255,255,255,255}, //S
+	{255,73,65,43,255,52,255,255,90,22,255,255,81,69,255,255,255,255,255,117,255,255,255,255,255,255,255}, //T
+	{92,255,255,255,255,255,255,255,255,255,255,255,255,255,255,255,255,255,255,255,255,255,255,255,255,255,255}, //U
+	{23,255,255,255,255,255,255,255,255,255,255,255,255,255,255,255,255,255,255,255,255,255,255,255,255,255,255}, //V
+	{74,255,255,255,255,255,255,255,255,255,255,255,255,255,255,255,255,255,255,255,255,255,255,255,255,255,255}, //W
+	{255,255,255,255,255,54,255,255,255,255,255,255,255,255,255,255,255,255,255,255,255,255,255,255,255,255,255}, //X
+	{39,255,70,255,255,255,255,255,255,255,255,255,255,255,255,255,255,255,255,255,255,255,255,255,255,255,255}, //Y
+	{255,255,255,255,255,255,255,255,255,255,255,255,255,255,30,255,255,255,40,255,255,255,255,255,255,255,255} //Z
+};
+
+//element names (and accepted abbreviations/alternate spellings), sorted by first
+//character and otherwise kept in priority order, with the number of characters that
+//need to match (0 for an exact match) and the corresponding Z
+static const elem_name_rule elemNameRules[] = {
+	{"Aluminium",3,13},{"Argon",3,18},{"Arsenic",3,33},{"Antimony",3,51},{"Astatine",3,85},{"Actinium",3,89},
+	{"Americium",3,95},{"Beryllium",4,4},{"Boron",3,5},{"Bromine",3,35},{"Barium",3,56},{"Bismuth",3,83},
+	{"Berkelium",4,97},{"Bohrium",3,107},{"Carbon",3,6},{"Chlorine",3,17},{"Calcium",4,20},{"Chromium",3,24},
+	{"Cromium",3,24},{"Cobalt",3,27},{"Copper",4,29},{"Columbium",4,41},{"Cadmium",3,48},{"Caesium",3,55},
+	{"Cesium",3,55},{"Cerium",3,58},{"Curium",3,96},{"Californium",4,98},{"Copernicium",4,112},{"Dysprosium",3,66},
+	{"Dubnium",3,105},{"Darmstadtium",3,110},{"Europium",3,63},{"Erbium",3,68},{"Einsteinium",3,99},{"Fluorine",3,9},
+	{"Florine",3,9},{"Francium",3,87},{"Fermium",3,100},{"Flerovium",3,114},{"Gallium",3,31},{"Germanium",3,32},
+	{"Gadolinium",3,64},{"Gold",3,79},{"Hydrogen",3,1},{"Helium",3,2},{"Holmium",3,67},{"Hafnium",3,72},
+	{"Hassium",3,108},{"Iron",3,26},{"Indium",3,49},{"Iodine",2,53},{"Iridium",3,77},{"Krypton",3,36},
+	{"Lithium",3,3},{"Lanthanum",3,57},{"Lutetium",3,71},{"Lead",3,82},{"Led",0,82},{"Lawrencium",3,103},
+	{"Livermorium",3,116},{"Magnesium",3,12},{"Manganese",3,25},{"Molybdenum",3,42},{"Mercury",3,80},{"Mendelevium",3,101},
+	{"Meitnerium",3,109},{"Moscovium",3,115},{"Neutron",0,0},{"Nitrogen",3,7},{"Neon",0,10},{"Nickel",3,28},
+	{"Niobium",3,41},{"Neodymium",4,60},{"Neptunium",3,93},{"Nobelium",3,102},{"Nihonium",3,113},{"Oxygen",2,8},
+	{"Osmium",3,76},{"Oganesson",3,118},{"Proton",5,1},{"Phosphorus",3,15},{"Potassium",3,19},{"Palladium",3,46},
+	{"Praseodymium",3,59},{"Promethium",4,61},{"Platinum",3,78},{"Polonium",3,84},{"Protactinium",5,91},{"Plutonium",3,94},
+	{"Rubidium",3,37},{"Ruthenium",6,44},{"Rhodium",3,45},{"Rhenium",3,75},{"Radon",4,86},{"Radium",4,88},
+	{"Rutherfordium",6,104},{"Roentgenium",3,111},{"Sodium",2,11},{"Silicon",4,14},{"Sulfur",3,16},{"Scandium",3,21},
+	{"Selenium",3,34},{"Strontium",3,38},{"Silver",4,47},{"Samarium",3,62},{"Seaborgium",3,106},{"Titanium",3,22},
+	{"Technetium",3,43},{"Tin",0,50},{"Tellurium",3,52},{"Terbium",3,65},{"Thulium",3,69},{"Tantalum",3,73},
+	{"Tungsten",3,74},{"Thallium",3,81},{"Thorium",3,90},{"Tennessine",3,117},{"Uranium",3,92},{"Unununium",6,111},
+	{"Vanadium",3,23},{"Wolfram",3,74},{"Xenon",3,54},{"Yttrium",4,39},{"Ytrium",3,39},{"Ytterbium",4,70},
+	{"Yterbium",3,70},{"Zinc",3,30},{"Zirconium",3,40}
+};
+#define NUM_ELEM_NAME_RULES ((uint8_t)(sizeof(elemNameRules)/sizeof(elemNameRules[0])))
+
+//returns the Z corresponding to an element symbol (eg. 'Si') or name (eg. 'Silicon',
+//or some abbreviations and alternate spellings), 255 if no matching element is found
 uint8_t elemStrToZ(const char *elemStr){
-	if(SDL_strcmp(elemStr,"n")==0){
-		return 0;
-	}else if(SDL_strcmp(elemStr,"H")==0){
-		return 1;
-	}else if(SDL_strcmp(elemStr,"He")==0){
-		return 2;
-	}else if(SDL_strcmp(elemStr,"Li")==0){
-		return 3;
-	}else if(SDL_strcmp(elemStr,"Be")==0){
-		return 4;
-	}else if(SDL_strcmp(elemStr,"B")==0){
-		return 5;
-	}else if(SDL_strcmp(elemStr,"C")==0){
-		return 6;
-	}else if(SDL_strcmp(elemStr,"N")==0){
-		return 7;
-	}else if(SDL_strcmp(elemStr,"O")==0){
-		return 8;
-	}else if(SDL_strcmp(elemStr,"F")==0){
-		return 9;
-	}else if(SDL_strcmp(elemStr,"Ne")==0){
-		return 10;
-	}else if(SDL_strcmp(elemStr,"Na")==0){
-		return 11;
-	}else if(SDL_strcmp(elemStr,"Mg")==0){
-		return 12;
-	}else if(SDL_strcmp(elemStr,"Al")==0){
-		return 13;
-	}else if(SDL_strcmp(elemStr,"Si")==0){
-		return 14;
-	}else if(SDL_strcmp(elemStr,"P")==0){
-		return 15;
-	}else if(SDL_strcmp(elemStr,"S")==0){
-		return 16;
-	}else if(SDL_strcmp(elemStr,"Cl")==0){
-		return 17;
-	}else if(SDL_strcmp(elemStr,"Ar")==0){
-		return 18;
-	}else if(SDL_strcmp(elemStr,"K")==0){
-		return 19;
-	}else if(SDL_strcmp(elemStr,"Ca")==0){
-		return 20;
-	}else if(SDL_strcmp(elemStr,"Sc")==0){
-		return 21;
-	}else if(SDL_strcmp(elemStr,"Ti")==0){
-		return 22;
-	}else if(SDL_strcmp(elemStr,"V")==0){
-		return 23;
-	}else if(SDL_strcmp(elemStr,"Cr")==0){
-		return 24;
-	}else if(SDL_strcmp(elemStr,"Mn")==0){
-		return 25;
-	}else if(SDL_strcmp(elemStr,"Fe")==0){
-		return 26;
-	}else if(SDL_strcmp(elemStr,"Co")==0){
-		return 27;
-	}else if(SDL_strcmp(elemStr,"Ni")==0){
-		return 28;
-	}else if(SDL_strcmp(elemStr,"Cu")==0){
-		return 29;
-	}else if(SDL_strcmp(elemStr,"Zn")==0){
-		return 30;
-	}else if(SDL_strcmp(elemStr,"Ga")==0){
-		return 31;
-	}else if(SDL_strcmp(elemStr,"Ge")==0){
-		return 32;
-	}else if(SDL_strcmp(elemStr,"As")==0){
-		return 33;
-	}else if(SDL_strcmp(elemStr,"Se")==0){
-		return 34;
-	}else if(SDL_strcmp(elemStr,"Br")==0){
-		return 35;
-	}else if(SDL_strcmp(elemStr,"Kr")==0){
-		return 36;
-	}else if(SDL_strcmp(elemStr,"Rb")==0){
-		return 37;
-	}else if(SDL_strcmp(elemStr,"Sr")==0){
-		return 38;
-	}else if(SDL_strcmp(elemStr,"Y")==0){
-		return 39;
-	}else if(SDL_strcmp(elemStr,"Zr")==0){
-		return 40;
-	}else if(SDL_strcmp(elemStr,"Nb")==0){
-		return 41;
-	}else if(SDL_strcmp(elemStr,"Mo")==0){
-		return 42;
-	}else if(SDL_strcmp(elemStr,"Tc")==0){
-		return 43;
-	}else if(SDL_strcmp(elemStr,"Ru")==0){
-		return 44;
-	}else if(SDL_strcmp(elemStr,"Rh")==0){
-		return 45;
-	}else if(SDL_strcmp(elemStr,"Pd")==0){
-		return 46;
-	}else if(SDL_strcmp(elemStr,"Ag")==0){
-		return 47;
-	}else if(SDL_strcmp(elemStr,"Cd")==0){
-		return 48;
-	}else if(SDL_strcmp(elemStr,"In")==0){
-		return 49;
-	}else if(SDL_strcmp(elemStr,"Sn")==0){
-		return 50;
-	}else if(SDL_strcmp(elemStr,"Sb")==0){
-		return 51;
-	}else if(SDL_strcmp(elemStr,"Te")==0){
-		return 52;
-	}else if(SDL_strcmp(elemStr,"I")==0){
-		return 53;
-	}else if(SDL_strcmp(elemStr,"Xe")==0){
-		return 54;
-	}else if(SDL_strcmp(elemStr,"Cs")==0){
-		return 55;
-	}else if(SDL_strcmp(elemStr,"Ba")==0){
-		return 56;
-	}else if(SDL_strcmp(elemStr,"La")==0){
-		return 57;
-	}else if(SDL_strcmp(elemStr,"Ce")==0){
-		return 58;
-	}else if(SDL_strcmp(elemStr,"Pr")==0){
-		return 59;
-	}else if(SDL_strcmp(elemStr,"Nd")==0){
-		return 60;
-	}else if(SDL_strcmp(elemStr,"Pm")==0){
-		return 61;
-	}else if(SDL_strcmp(elemStr,"Sm")==0){
-		return 62;
-	}else if(SDL_strcmp(elemStr,"Eu")==0){
-		return 63;
-	}else if(SDL_strcmp(elemStr,"Gd")==0){
-		return 64;
-	}else if(SDL_strcmp(elemStr,"Tb")==0){
-		return 65;
-	}else if(SDL_strcmp(elemStr,"Dy")==0){
-		return 66;
-	}else if(SDL_strcmp(elemStr,"Ho")==0){
-		return 67;
-	}else if(SDL_strcmp(elemStr,"Er")==0){
-		return 68;
-	}else if(SDL_strcmp(elemStr,"Tm")==0){
-		return 69;
-	}else if(SDL_strcmp(elemStr,"Yb")==0){
-		return 70;
-	}else if(SDL_strcmp(elemStr,"Lu")==0){
-		return 71;
-	}else if(SDL_strcmp(elemStr,"Hf")==0){
-		return 72;
-	}else if(SDL_strcmp(elemStr,"Ta")==0){
-		return 73;
-	}else if(SDL_strcmp(elemStr,"W")==0){
-		return 74;
-	}else if(SDL_strcmp(elemStr,"Re")==0){
-		return 75;
-	}else if(SDL_strcmp(elemStr,"Os")==0){
-		return 76;
-	}else if(SDL_strcmp(elemStr,"Ir")==0){
-		return 77;
-	}else if(SDL_strcmp(elemStr,"Pt")==0){
-		return 78;
-	}else if(SDL_strcmp(elemStr,"Au")==0){
-		return 79;
-	}else if(SDL_strcmp(elemStr,"Hg")==0){
-		return 80;
-	}else if(SDL_strcmp(elemStr,"Tl")==0){
-		return 81;
-	}else if(SDL_strcmp(elemStr,"Pb")==0){
-		return 82;
-	}else if(SDL_strcmp(elemStr,"Bi")==0){
-		return 83;
-	}else if(SDL_strcmp(elemStr,"Po")==0){
-		return 84;
-	}else if(SDL_strcmp(elemStr,"At")==0){
-		return 85;
-	}else if(SDL_strcmp(elemStr,"Rn")==0){
-		return 86;
-	}else if(SDL_strcmp(elemStr,"Fr")==0){
-		return 87;
-	}else if(SDL_strcmp(elemStr,"Ra")==0){
-		return 88;
-	}else if(SDL_strcmp(elemStr,"Ac")==0){
-		return 89;
-	}else if(SDL_strcmp(elemStr,"Th")==0){
-		return 90;
-	}else if(SDL_strcmp(elemStr,"Pa")==0){
-		return 91;
-	}else if(SDL_strcmp(elemStr,"U")==0){
-		return 92;
-	}else if(SDL_strcmp(elemStr,"Np")==0){
-		return 93;
-	}else if(SDL_strcmp(elemStr,"Pu")==0){
-		return 94;
-	}else if(SDL_strcmp(elemStr,"Am")==0){
-		return 95;
-	}else if(SDL_strcmp(elemStr,"Cm")==0){
-		return 96;
-	}else if(SDL_strcmp(elemStr,"Bk")==0){
-		return 97;
-	}else if(SDL_strcmp(elemStr,"Cf")==0){
-		return 98;
-	}else if(SDL_strcmp(elemStr,"Es")==0){
-		return 99;
-	}else if(SDL_strcmp(elemStr,"Fm")==0){
-		return 100;
-	}else if(SDL_strcmp(elemStr,"Md")==0){
-		return 101;
-	}else if(SDL_strcmp(elemStr,"No")==0){
-		return 102;
-	}else if(SDL_strcmp(elemStr,"Lr")==0){
-		return 103;
-	}else if(SDL_strcmp(elemStr,"Rf")==0){
-		return 104;
-	}else if(SDL_strcmp(elemStr,"Db")==0){
-		return 105;
-	}else if(SDL_strcmp(elemStr,"Sg")==0){
-		return 106;
-	}else if(SDL_strcmp(elemStr,"Bh")==0){
-		return 107;
-	}else if(SDL_strcmp(elemStr,"Hs")==0){
-		return 108;
-	}else if(SDL_strcmp(elemStr,"Mt")==0){
-		return 109;
-	}else if(SDL_strcmp(elemStr,"Ds")==0){
-		return 110;
-	}else if(SDL_strcmp(elemStr,"Rg")==0){
-		return 111;
-	}else if(SDL_strcmp(elemStr,"Cn")==0){
-		return 112;
-	}else if(SDL_strcmp(elemStr,"Nh")==0){
-		return 113;
-	}else if(SDL_strcmp(elemStr,"Fl")==0){
-		return 114;
-	}else if(SDL_strcmp(elemStr,"Mc")==0){
-		return 115;
-	}else if(SDL_strcmp(elemStr,"Lv")==0){
-		return 116;
-	}else if(SDL_strcmp(elemStr,"Ts")==0){
-		return 117;
-	}else if(SDL_strcmp(elemStr,"Og")==0){
-		return 118;
-	}else if(SDL_strcmp(elemStr,"Neutron")==0){
-		return 0;
-	}else if((SDL_strncmp(elemStr,"Hydrogen",3)==0)||(SDL_strncmp(elemStr,"Proton",5)==0)){
-		return 1;
-	}else if(SDL_strncmp(elemStr,"Helium",3)==0){
-		return 2;
-	}else if(SDL_strncmp(elemStr,"Lithium",3)==0){
-		return 3;
-	}else if(SDL_strncmp(elemStr,"Beryllium",4)==0){
-		return 4;
-	}else if(SDL_strncmp(elemStr,"Boron",3)==0){
-		return 5;
-	}else if(SDL_strncmp(elemStr,"Carbon",3)==0){
-		return 6;
-	}else if(SDL_strncmp(elemStr,"Nitrogen",3)==0){
-		return 7;
-	}else if(SDL_strncmp(elemStr,"Oxygen",2)==0){
-		return 8;
-	}else if((SDL_strncmp(elemStr,"Fluorine",3)==0)||(SDL_strncmp(elemStr,"Florine",3)==0)){
-		return 9;
-	}else if(SDL_strcmp(elemStr,"Neon")==0){
-		return 10;
-	}else if(SDL_strncmp(elemStr,"Sodium",2)==0){
-		return 11;
-	}else if(SDL_strncmp(elemStr,"Magnesium",3)==0){
-		return 12;
-	}else if(SDL_strncmp(elemStr,"Aluminium",3)==0){
-		return 13;
-	}else if(SDL_strncmp(elemStr,"Silicon",4)==0){
-		return 14;
-	}else if(SDL_strncmp(elemStr,"Phosphorus",3)==0){
-		return 15;
-	}else if(SDL_strncmp(elemStr,"Sulfur",3)==0){
-		return 16;
-	}else if(SDL_strncmp(elemStr,"Chlorine",3)==0){
-		return 17;
-	}else if(SDL_strncmp(elemStr,"Argon",3)==0){
-		return 18;
-	}else if(SDL_strncmp(elemStr,"Potassium",3)==0){
-		return 19;
-	}else if(SDL_strncmp(elemStr,"Calcium",4)==0){
-		return 20;
-	}else if(SDL_strncmp(elemStr,"Scandium",3)==0){
-		return 21;
-	}else if(SDL_strncmp(elemStr,"Titanium",3)==0){
-		return 22;
-	}else if(SDL_strncmp(elemStr,"Vanadium",3)==0){
-		return 23;
-	}else if((SDL_strncmp(elemStr,"Chromium",3)==0)||(SDL_strncmp(elemStr,"Cromium",3)==0)){
-		return 24;
-	}else if(SDL_strncmp(elemStr,"Manganese",3)==0){
-		return 25;
-	}else if(SDL_strncmp(elemStr,"Iron",3)==0){
-		return 26;
-	}else if(SDL_strncmp(elemStr,"Cobalt",3)==0){
-		return 27;
-	}else if(SDL_strncmp(elemStr,"Nickel",3)==0){
-		return 28;
-	}else if(SDL_strncmp(elemStr,"Copper",4)==0){
-		return 29;
-	}else if(SDL_strncmp(elemStr,"Zinc",3)==0){
-		return 30;
-	}else if(SDL_strncmp(elemStr,"Gallium",3)==0){
-		return 31;
-	}else if(SDL_strncmp(elemStr,"Germanium",3)==0){
-		return 32;
-	}else if(SDL_strncmp(elemStr,"Arsenic",3)==0){
-		return 33;
-	}else if(SDL_strncmp(elemStr,"Selenium",3)==0){
-		return 34;
-	}else if(SDL_strncmp(elemStr,"Bromine",3)==0){
-		return 35;
-	}else if(SDL_strncmp(elemStr,"Krypton",3)==0){
-		return 36;
-	}else if(SDL_strncmp(elemStr,"Rubidium",3)==0){
-		return 37;
-	}else if(SDL_strncmp(elemStr,"Strontium",3)==0){
-		return 38;
-	}else if((SDL_strncmp(elemStr,"Yttrium",4)==0)||(SDL_strncmp(elemStr,"Ytrium",3)==0)){
-		return 39;
-	}else if(SDL_strncmp(elemStr,"Zirconium",3)==0){
-		return 40;
-	}else if((SDL_strncmp(elemStr,"Niobium",3)==0)||(SDL_strncmp(elemStr,"Columbium",4)==0)){
-		return 41;
-	}else if(SDL_strncmp(elemStr,"Molybdenum",3)==0){
-		return 42;
-	}else if(SDL_strncmp(elemStr,"Technetium",3)==0){
-		return 43;
-	}else if(SDL_strncmp(elemStr,"Ruthenium",6)==0){
-		return 44;
-	}else if(SDL_strncmp(elemStr,"Rhodium",3)==0){
-		return 45;
-	}else if(SDL_strncmp(elemStr,"Palladium",3)==0){
-		return 46;
-	}else if(SDL_strncmp(elemStr,"Silver",4)==0){
-		return 47;
-	}else if(SDL_strncmp(elemStr,"Cadmium",3)==0){
-		return 48;
-	}else if(SDL_strncmp(elemStr,"Indium",3)==0){
-		return 49;
-	}else if(SDL_strcmp(elemStr,"Tin")==0){
-		return 50;
-	}else if(SDL_strncmp(elemStr,"Antimony",3)==0){
-		return 51;
-	}else if(SDL_strncmp(elemStr,"Tellurium",3)==0){
-		return 52;
-	}else if(SDL_strncmp(elemStr,"Iodine",2)==0){
-		return 53;
-	}else if(SDL_strncmp(elemStr,"Xenon",3)==0){
-		return 54;
-	}else if((SDL_strncmp(elemStr,"Caesium",3)==0)||(SDL_strncmp(elemStr,"Cesium",3)==0)){
-		return 55;
-	}else if(SDL_strncmp(elemStr,"Barium",3)==0){
-		return 56;
-	}else if(SDL_strncmp(elemStr,"Lanthanum",3)==0){
-		return 57;
-	}else if(SDL_strncmp(elemStr,"Cerium",3)==0){
-		return 58;
-	}else if(SDL_strncmp(elemStr,"Praseodymium",3)==0){
-		return 59;
-	}else if(SDL_strncmp(elemStr,"Neodymium",4)==0){
-		return 60;
-	}else if(SDL_strncmp(elemStr,"Promethium",4)==0){
-		return 61;
-	}else if(SDL_strncmp(elemStr,"Samarium",3)==0){
-		return 62;
-	}else if(SDL_strncmp(elemStr,"Europium",3)==0){
-		return 63;
-	}else if(SDL_strncmp(elemStr,"Gadolinium",3)==0){
-		return 64;
-	}else if(SDL_strncmp(elemStr,"Terbium",3)==0){
-		return 65;
-	}else if(SDL_strncmp(elemStr,"Dysprosium",3)==0){
-		return 66;
-	}else if(SDL_strncmp(elemStr,"Holmium",3)==0){
-		return 67;
-	}else if(SDL_strncmp(elemStr,"Erbium",3)==0){
-		return 68;
-	}else if(SDL_strncmp(elemStr,"Thulium",3)==0){
-		return 69;
-	}else if((SDL_strncmp(elemStr,"Ytterbium",4)==0)||(SDL_strncmp(elemStr,"Yterbium",3)==0)){
-		return 70;
-	}else if(SDL_strncmp(elemStr,"Lutetium",3)==0){
-		return 71;
-	}else if(SDL_strncmp(elemStr,"Hafnium",3)==0){
-		return 72;
-	}else if(SDL_strncmp(elemStr,"Tantalum",3)==0){
-		return 73;
-	}else if((SDL_strncmp(elemStr,"Tungsten",3)==0)||(SDL_strncmp(elemStr,"Wolfram",3)==0)){
-		return 74;
-	}else if(SDL_strncmp(elemStr,"Rhenium",3)==0){
-		return 75;
-	}else if(SDL_strncmp(elemStr,"Osmium",3)==0){
-		return 76;
-	}else if(SDL_strncmp(elemStr,"Iridium",3)==0){
-		return 77;
-	}else if(SDL_strncmp(elemStr,"Platinum",3)==0){
-		return 78;
-	}else if(SDL_strncmp(elemStr,"Gold",3)==0){
-		return 79;
-	}else if(SDL_strncmp(elemStr,"Mercury",3)==0){
-		return 80;
-	}else if(SDL_strncmp(elemStr,"Thallium",3)==0){
-		return 81;
-	}else if((SDL_strncmp(elemStr,"Lead",3)==0)||(SDL_strcmp(elemStr,"Led")==0)){
-		return 82;
-	}else if(SDL_strncmp(elemStr,"Bismuth",3)==0){
-		return 83;
-	}else if(SDL_strncmp(elemStr,"Polonium",3)==0){
-		return 84;
-	}else if(SDL_strncmp(elemStr,"Astatine",3)==0){
-		return 85;
-	}else if(SDL_strncmp(elemStr,"Radon",4)==0){
-		return 86;
-	}else if(SDL_strncmp(elemStr,"Francium",3)==0){
-		return 87;
-	}else if(SDL_strncmp(elemStr,"Radium",4)==0){
-		return 88;
-	}else if(SDL_strncmp(elemStr,"Actinium",3)==0){
-		return 89;
-	}else if(SDL_strncmp(elemStr,"Thorium",3)==0){
-		return 90;
-	}else if(SDL_strncmp(elemStr,"Protactinium",5)==0){
-		return 91;
-	}else if(SDL_strncmp(elemStr,"Uranium",3)==0){
-		return 92;
-	}else if(SDL_strncmp(elemStr,"Neptunium",3)==0){
-		return 93;
-	}else if(SDL_strncmp(elemStr,"Plutonium",3)==0){
-		return 94;
-	}else if(SDL_strncmp(elemStr,"Americium",3)==0){
-		return 95;
-	}else if(SDL_strncmp(elemStr,"Curium",3)==0){
-		return 96;
-	}else if(SDL_strncmp(elemStr,"Berkelium",4)==0){
-		return 97;
-	}else if(SDL_strncmp(elemStr,"Californium",4)==0){
-		return 98;
-	}else if(SDL_strncmp(elemStr,"Einsteinium",3)==0){
-		return 99;
-	}else if(SDL_strncmp(elemStr,"Fermium",3)==0){
-		return 100;
-	}else if(SDL_strncmp(elemStr,"Mendelevium",3)==0){
-		return 101;
-	}else if(SDL_strncmp(elemStr,"Nobelium",3)==0){
-		return 102;
-	}else if(SDL_strncmp(elemStr,"Lawrencium",3)==0){
-		return 103;
-	}else if(SDL_strncmp(elemStr,"Rutherfordium",6)==0){
-		return 104;
-	}else if(SDL_strncmp(elemStr,"Dubnium",3)==0){
-		return 105;
-	}else if(SDL_strncmp(elemStr,"Seaborgium",3)==0){
-		return 106;
-	}else if(SDL_strncmp(elemStr,"Bohrium",3)==0){
-		return 107;
-	}else if(SDL_strncmp(elemStr,"Hassium",3)==0){
-		return 108;
-	}else if(SDL_strncmp(elemStr,"Meitnerium",3)==0){
-		return 109;
-	}else if(SDL_strncmp(elemStr,"Darmstadtium",3)==0){
-		return 110;
-	}else if((SDL_strncmp(elemStr,"Roentgenium",3)==0)||(SDL_strncmp(elemStr,"Unununium",6)==0)){
-		return 111;
-	}else if(SDL_strncmp(elemStr,"Copernicium",4)==0){
-		return 112;
-	}else if(SDL_strncmp(elemStr,"Nihonium",3)==0){
-		return 113;
-	}else if(SDL_strncmp(elemStr,"Flerovium",3)==0){
-		return 114;
-	}else if(SDL_strncmp(elemStr,"Moscovium",3)==0){
-		return 115;
-	}else if(SDL_strncmp(elemStr,"Livermorium",3)==0){
-		return 116;
-	}else if(SDL_strncmp(elemStr,"Tennessine",3)==0){
-		return 117;
-	}else if(SDL_strncmp(elemStr,"Oganesson",3)==0){
-		return 118;
+	const char firstChar = elemStr[0];
+	if((firstChar < 'A')||(firstChar > 'Z')){
+		if(SDL_strcmp(elemStr,"n")==0){
+			return 0; //neutron
+		}
+		return 255; //no matching element found
+	}
+	const uint8_t firstInd = (uint8_t)(firstChar - 'A');
+
+	//check element symbols
+	if(elemStr[1] == '\0'){
+		if(elemSymbolZ[firstInd][0] != 255){
+			return elemSymbolZ[firstInd][0];
+		}
+	}else if((elemStr[1] >= 'a')&&(elemStr[1] <= 'z')&&(elemStr[2] == '\0')){
+		if(elemSymbolZ[firstInd][elemStr[1] - 'a' + 1] != 255){
+			return elemSymbolZ[firstInd][elemStr[1] - 'a' + 1];
+		}
+	}
+
+	//find the first element name starting with the same character
+	uint8_t lo = 0;
+	uint8_t hi = NUM_ELEM_NAME_RULES;
+	while(lo < hi){
+		const uint8_t mid = (uint8_t)(lo + (hi - lo)/2);
+		if(elemNameRules[mid].str[0] < firstChar){
+			lo = (uint8_t)(mid + 1);
+		}else{
+			hi = mid;
+		}
+	}
+
+	//check element names starting with the same character
+	for(uint8_t i=lo; (i<NUM_ELEM_NAME_RULES)&&(elemNameRules[i].str[0] == firstChar); i++){
+		if(elemNameRules[i].cmpLen == 0){
+			if(SDL_strcmp(elemStr,elemNameRules[i].str)==0){
+				return elemNameRules[i].Z;
+			}
+		}else if(SDL_strncmp(elemStr,elemNameRules[i].str,elemNameRules[i].cmpLen)==0){
+			return elemNameRules[i].Z;
+		}
 	}
 
 	return 255; //no matching element found
@@ -2399,6 +2121,169 @@ void getRxnStr(char strOut[32], const ndata *restrict nd, const uint32_t rxnInd)
 	SDL_snprintf(strOut,nd->rxn[rxnInd].rxnStrLen,"%s",&nd->ensdfStrBuf[nd->rxn[rxnInd].rxnStrBufStartPos]);
 }
 
+//converts a reaction string (as stored in the database, or as typed by the user)
+//to the canonical reaction type used by the reaction catalogue: lowercase ASCII
+//with spaces removed, and Greek letters (or their names) replaced by the ENSDF
+//abbreviations (α->a, β->b, γ->g, ε->ec, μ->mu, ν->nu, π->pi)
+//eg. '26Mg(p,γ)' -> '(p,g)', '152Eu β- decay (13.5 y)' -> 'b-decay',
+//'Coulomb Excitation' -> 'coulombexcitation'
+//the target or parent nuclide preceding the reaction (if any) is written to targetOut
+//returns the length of the key, or 0 if the string doesn't contain a reaction
+uint8_t getRxnCatalogueKey(char keyOut[RXN_CATALOGUE_KEY_LEN], char targetOut[RXN_CATALOGUE_TARGET_LEN], const char *rxnStr){
+
+	keyOut[0] = '\0';
+	targetOut[0] = '\0';
+
+	//normalize the string
+	char norm[SEARCH_STRING_MAX_SIZE];
+	uint16_t normLen = 0;
+	for(uint16_t i=0; (rxnStr[i]!='\0')&&(normLen < (SEARCH_STRING_MAX_SIZE-3)); i++){
+		const unsigned char c = (unsigned char)rxnStr[i];
+		const char *rep = NULL;
+		if((c == 0xCEU)||(c == 0xCFU)){
+			if(rxnStr[i+1] == '\0'){
+				break;
+			}
+			switch((c << 8) | (unsigned char)rxnStr[i+1]){
+				case 0xCEB1U:
+					rep = "a"; //α
+					break;
+				case 0xCEB2U:
+					rep = "b"; //β
+					break;
+				case 0xCEB3U:
+					rep = "g"; //γ
+					break;
+				case 0xCEB5U:
+					rep = "ec"; //ε
+					break;
+				case 0xCEBCU:
+					rep = "mu"; //μ
+					break;
+				case 0xCEBDU:
+					rep = "nu"; //ν
+					break;
+				case 0xCF80U:
+					rep = "pi"; //π
+					break;
+				default:
+					break;
+			}
+			i++;
+			if(rep == NULL){
+				continue;
+			}
+		}else if(c >= 0x80U){
+			continue; //other non-ASCII characters
+		}else if(SDL_isspace(c)){
+			if((normLen > 0)&&(norm[normLen-1] != ' ')){
+				norm[normLen] = ' ';
+				normLen++;
+			}
+			continue;
+		}else if(SDL_isalpha(c)&&((i == 0)||(!SDL_isalpha((unsigned char)rxnStr[i-1])))){
+			//spelled out particle names
+			static const char *const spelledNames[4][2] = {{"alpha","a"},{"beta","b"},{"gamma","g"},{"epsilon","ec"}};
+			for(uint8_t j=0; j<4; j++){
+				const uint16_t nameLen = (uint16_t)SDL_strlen(spelledNames[j][0]);
+				if((SDL_strncasecmp(&rxnStr[i],spelledNames[j][0],nameLen)==0)&&(!SDL_isalpha((unsigned char)rxnStr[i+nameLen]))){
+					rep = spelledNames[j][1];
+					i = (uint16_t)(i + nameLen - 1);
+					break;
+				}
+			}
+		}
+		if(rep != NULL){
+			for(uint8_t j=0; (rep[j]!='\0')&&(normLen < (SEARCH_STRING_MAX_SIZE-1)); j++){
+				norm[normLen] = rep[j];
+				normLen++;
+			}
+		}else{
+			norm[normLen] = (char)SDL_tolower(c);
+			normLen++;
+		}
+	}
+	while((normLen > 0)&&(norm[normLen-1] == ' ')){
+		normLen--;
+	}
+	norm[normLen] = '\0';
+	if(normLen == 0){
+		return 0;
+	}
+
+	uint8_t keyLen = 0;
+	int32_t targetEnd = -1; //position just after the end of the target/parent nuclide in norm
+	const char *decayPos = SDL_strstr(norm,"decay");
+	const char *openPos = SDL_strchr(norm,'(');
+	const char *closePos = (openPos != NULL) ? SDL_strchr(openPos,')') : NULL;
+	const char *commaPos = (openPos != NULL) ? SDL_strchr(openPos,',') : NULL;
+	if(decayPos != NULL){
+		//decay: key is the decay mode followed by 'decay'
+		int32_t modeEnd = (int32_t)(decayPos - norm);
+		while((modeEnd > 0)&&(norm[modeEnd-1] == ' ')){
+			modeEnd--;
+		}
+		int32_t modeStart = modeEnd;
+		while((modeStart > 0)&&(norm[modeStart-1] != ' ')&&(norm[modeStart-1] != '(')){
+			modeStart--;
+		}
+		if(modeStart == modeEnd){
+			return 0; //no decay mode
+		}
+		for(int32_t i=modeStart; (i<modeEnd)&&(keyLen < (RXN_CATALOGUE_KEY_LEN-6)); i++){
+			keyOut[keyLen] = norm[i];
+			keyLen++;
+		}
+		SDL_strlcpy(&keyOut[keyLen],"decay",6);
+		keyLen = (uint8_t)(keyLen + 5);
+		targetEnd = modeStart;
+	}else if((closePos != NULL)&&(commaPos != NULL)&&(commaPos < closePos)){
+		//projectile and ejectile: key is the bracketed part
+		uint8_t keyCommaPos = 0;
+		for(const char *c=openPos; (c<=closePos)&&(keyLen < (RXN_CATALOGUE_KEY_LEN-1)); c++){
+			if(*c != ' '){
+				if(*c == ','){
+					keyCommaPos = keyLen;
+				}
+				keyOut[keyLen] = *c;
+				keyLen++;
+			}
+		}
+		keyOut[keyLen] = '\0';
+		if((keyLen > (keyCommaPos+3))&&(keyOut[keyLen-1] == ')')&&(keyOut[keyLen-2] == 'g')){
+			//drop gamma from multi-particle ejectiles, as done for the database strings
+			keyOut[keyLen-2] = ')';
+			keyLen--;
+		}
+		targetEnd = (int32_t)(openPos - norm);
+	}else{
+		//named reaction (eg. Coulomb excitation)
+		for(uint16_t i=0; (i<normLen)&&(keyLen < (RXN_CATALOGUE_KEY_LEN-1)); i++){
+			if(norm[i] != ' '){
+				keyOut[keyLen] = norm[i];
+				keyLen++;
+			}
+		}
+	}
+	keyOut[keyLen] = '\0';
+
+	//get the target/parent nuclide (last word before the reaction)
+	if(targetEnd > 0){
+		while((targetEnd > 0)&&(norm[targetEnd-1] == ' ')){
+			targetEnd--;
+		}
+		int32_t targetStart = targetEnd;
+		while((targetStart > 0)&&(norm[targetStart-1] != ' ')){
+			targetStart--;
+		}
+		if((targetEnd > targetStart)&&((targetEnd - targetStart) < RXN_CATALOGUE_TARGET_LEN)){
+			SDL_strlcpy(targetOut,&norm[targetStart],(size_t)(targetEnd - targetStart + 1));
+		}
+	}
+
+	return keyLen;
+}
+
 void getAbundanceStr(char strOut[32], const ndata *restrict nd, const uint16_t nuclInd){
 	if(nuclInd < nd->numNucl){
 		if((nd->nuclData[nuclInd].abundance.unit & 127U) == VALUE_UNIT_PERCENT){
@@ -3268,6 +3153,52 @@ double getMostProbableSpin(const ndata *restrict nd, const uint32_t lvlInd){
 	return 255.0; //unknown spin
 }
 
+//returns twice the spin of a spin-parity value of a level, or 65535 if the spin
+//isn't a definite number (unknown, variable, or a range/high J/low J marker)
+uint16_t getSpinParValTwoJ(const ndata *restrict nd, const uint32_t lvlInd, const uint32_t spvInd){
+	const spinparval *spv = &nd->spv[spvInd];
+	const uint8_t tentative = (uint8_t)((spv->format >> 10U) & 15U);
+	if((spv->spinVal == 255)||(spv->format & 1U)||(tentative == TENTATIVESP_RANGE)||(tentative == TENTATIVESP_HIGHJ)||(tentative == TENTATIVESP_LOWJ)){
+		return 65535U;
+	}
+	if(nd->levels[lvlInd].format & 1U){
+		return spv->spinVal; //half-integer spin, stored as 2J
+	}
+	return (uint16_t)(2U*spv->spinVal);
+}
+
+//key of a (2J, parity) combination in the spin-parity index
+//(parity: 1 if positive, -1 if negative, 0 if unknown)
+uint16_t getSpinParIdxKey(const uint16_t twoJ, const int8_t par){
+	return (uint16_t)(twoJ*3U + (uint16_t)(par + 1));
+}
+
+//level energy bin of the (energy, half-life) grid index
+uint16_t getEHlGridEBin(const double energy){
+	if(energy <= 0.0){
+		return 0;
+	}
+	const double bin = SDL_floor(energy/EHL_GRID_E_BIN_KEV);
+	if(bin >= (EHL_GRID_E_BINS-1)){
+		return EHL_GRID_E_BINS-1;
+	}
+	return (uint16_t)bin;
+}
+
+//half-life bin of the (energy, half-life) grid index
+uint16_t getEHlGridTBin(const double hlSeconds){
+	if(hlSeconds <= 0.0){
+		return 0;
+	}
+	const double bin = SDL_floor((SDL_log10(hlSeconds) - EHL_GRID_LOGT_MIN)/EHL_GRID_LOGT_BIN);
+	if(bin <= 0.0){
+		return 0;
+	}else if(bin >= (EHL_GRID_T_BINS-1)){
+		return EHL_GRID_T_BINS-1;
+	}
+	return (uint16_t)bin;
+}
+
 // gets the number of levels in the nuclide which have a beta or EC decay mode
 uint16_t getNumBetaDecayingLvls(const ndata *restrict nd, const uint16_t nuclInd){
 	uint16_t numLvls = 0;
@@ -3411,6 +3342,46 @@ double get2nd0PlusEnergy(const ndata *restrict nd, const uint16_t nuclInd){
 
 #define HBAR 6.582119569E-16 //in eV s
 
+//converts a half-life value quoted in the specified units (values from value_unit_enum)
+//to seconds, returns -2.0 if the units do not correspond to a half-life
+double getHalfLifeSecondsFromVal(const double hl, const uint8_t hlUnit){
+	switch(hlUnit){
+		case VALUE_UNIT_STABLE:
+			return 1.0E50; //stable
+		case VALUE_UNIT_YEARS:
+			return hl*365.25*24*3600;
+		case VALUE_UNIT_DAYS:
+			return hl*24*3600;
+		case VALUE_UNIT_HOURS:
+			return hl*3600;
+		case VALUE_UNIT_MINUTES:
+			return hl*60;
+		case VALUE_UNIT_SECONDS:
+			return hl;
+		case VALUE_UNIT_MILLISECONDS:
+			return hl*0.001;
+		case VALUE_UNIT_MICROSECONDS:
+			return hl*0.000001;
+		case VALUE_UNIT_NANOSECONDS:
+			return hl*0.000000001;
+		case VALUE_UNIT_PICOSECONDS:
+			return hl*0.000000000001;
+		case VALUE_UNIT_FEMTOSECONDS:
+			return hl*0.000000000000001;
+		case VALUE_UNIT_ATTOSECONDS:
+			return hl*0.000000000000000001;
+		case VALUE_UNIT_MEV:
+			return HBAR*3.14159/(1.4427*4*hl*1000000.0); //lifetime * deltaE = (pi/4)*hbar ... log(2) factor to convert lifetime to half-life
+		case VALUE_UNIT_KEV:
+			return HBAR*3.14159/(1.4427*4*hl*1000.0); //lifetime * deltaE = (pi/4)*hbar ... log(2) factor to convert lifetime to half-life
+		case VALUE_UNIT_EV:
+			return HBAR*3.14159/(1.4427*4*hl); //lifetime * deltaE = (pi/4)*hbar ... log(2) factor to convert lifetime to half-life
+		case VALUE_UNIT_NOVAL:
+		default:
+			return -2.0; //couldn't find half-life
+	}
+}
+
 double getLevelHalfLifeSeconds(const ndata *restrict nd, const uint32_t levelInd){
 	if(levelInd < nd->numLvls){
 		uint8_t hlValueType = (uint8_t)((nd->levels[levelInd].halfLife.format >> 5U) & 15U);
@@ -3424,41 +3395,7 @@ double getLevelHalfLifeSeconds(const ndata *restrict nd, const uint32_t levelInd
 			return -2.0;
 		}
 		uint8_t hlUnit = (uint8_t)(nd->levels[levelInd].halfLife.unit & 127U);
-		switch(hlUnit){
-			case VALUE_UNIT_STABLE:
-				return 1.0E50; //stable
-			case VALUE_UNIT_YEARS:
-				return hl*365.25*24*3600;
-			case VALUE_UNIT_DAYS:
-				return hl*24*3600;
-			case VALUE_UNIT_HOURS:
-				return hl*3600;
-			case VALUE_UNIT_MINUTES:
-				return hl*60;
-			case VALUE_UNIT_SECONDS:
-				return hl;
-			case VALUE_UNIT_MILLISECONDS:
-				return hl*0.001;
-			case VALUE_UNIT_MICROSECONDS:
-				return hl*0.000001;
-			case VALUE_UNIT_NANOSECONDS:
-				return hl*0.000000001;
-			case VALUE_UNIT_PICOSECONDS:
-				return hl*0.000000000001;
-			case VALUE_UNIT_FEMTOSECONDS:
-				return hl*0.000000000000001;
-			case VALUE_UNIT_ATTOSECONDS:
-				return hl*0.000000000000000001;
-			case VALUE_UNIT_MEV:
-				return HBAR*3.14159/(1.4427*4*hl*1000000.0); //lifetime * deltaE = (pi/4)*hbar ... log(2) factor to convert lifetime to half-life
-			case VALUE_UNIT_KEV:
-				return HBAR*3.14159/(1.4427*4*hl*1000.0); //lifetime * deltaE = (pi/4)*hbar ... log(2) factor to convert lifetime to half-life
-			case VALUE_UNIT_EV:
-				return HBAR*3.14159/(1.4427*4*hl); //lifetime * deltaE = (pi/4)*hbar ... log(2) factor to convert lifetime to half-life
-			case VALUE_UNIT_NOVAL:
-			default:
-				return -2.0; //couldn't find half-life
-		}
+		return getHalfLifeSecondsFromVal(hl,hlUnit);
 	}else{
 		return -2.0; //couldn't find half-life
 	}
@@ -3564,6 +3501,13 @@ uint32_t getFinalLvlInd(const ndata *restrict nd, const uint32_t initialLevel, c
 }
 
 uint16_t getNuclInd(const ndata *restrict nd, const int16_t N, const int16_t Z){
+	if(nd->nuclIndGridBuilt){
+		if((N >= 0)&&(N < MAX_NEUTRON_NUM)&&(Z >= 0)&&(Z < MAX_PROTON_NUM)){
+			return nd->nuclIndByNZ[Z][N];
+		}
+		return MAXNUMNUCL;
+	}
+	//lookup grid not available yet (ie. while building the database), search all nuclides
 	for(uint16_t i=0; i<nd->numNucl;i++){
 		if(nd->nuclData[i].Z == Z){
 			if(nd->nuclData[i].N == N){
@@ -3695,29 +3639,37 @@ void setCoincLvlFlags(const ndata *restrict nd, app_state *restrict state, const
 }
 
 
-//checks whether a level is displayed in the level list,
-//based on the current app state
-uint8_t isLvlDisplayed(const ndata *restrict nd, const app_state *restrict state, const uint16_t nuclInd, const uint16_t nuclLvlInd){
+//checks whether a level is displayed in the level list for a given reaction (or coincidence)
+//filter, rather than the one in the current app state (search threads use the filter that
+//their search was started with)
+//selectedRxn and reactionModeInd as in drawing_state, flaggedCoincLvls as in app_state
+uint8_t isLvlDisplayedForRxn(const ndata *restrict nd, const uint8_t selectedRxn, const uint8_t reactionModeInd, const uint64_t *flaggedCoincLvls, const uint16_t nuclInd, const uint16_t nuclLvlInd){
 	if(nuclLvlInd < nd->nuclData[nuclInd].numLevels){
-		if(state->ds.selectedRxn == 0){
+		if(selectedRxn == 0){
 			return 1;
-		}else if(state->ds.selectedRxn >= 254){
+		}else if(selectedRxn >= 254){
 			//coincidence or same Jpi display mode
 			if(nuclLvlInd < MAX_COINC_FLAGGED_LVLS){
 				const uint32_t bpInd = nuclLvlInd/64; //bit-pattern index (maximum int size is 64 bits)
-				if(state->flaggedCoincLvls[bpInd] & (uint64_t)((uint64_t)(1) << (nuclLvlInd - (bpInd*64)))){
+				if(flaggedCoincLvls[bpInd] & (uint64_t)((uint64_t)(1) << (nuclLvlInd - (bpInd*64)))){
 					return 1;
 				}
 			}
-		}else if(state->ds.reactionModeInd == REACTIONMODE_HIGHLIGHT){
+		}else if(reactionModeInd == REACTIONMODE_HIGHLIGHT){
 			return 1;
-		}else if(nd->levels[nd->nuclData[nuclInd].firstLevel + (uint32_t)nuclLvlInd].populatingRxns & ((uint64_t)(1) << (state->ds.selectedRxn-1))){
+		}else if(nd->levels[nd->nuclData[nuclInd].firstLevel + (uint32_t)nuclLvlInd].populatingRxns & ((uint64_t)(1) << (selectedRxn-1))){
 			return 1;
 		}
 	}
 	return 0;
 }
 
+//checks whether a level is displayed in the level list,
+//based on the current app state
+uint8_t isLvlDisplayed(const ndata *restrict nd, const app_state *restrict state, const uint16_t nuclInd, const uint16_t nuclLvlInd){
+	return isLvlDisplayedForRxn(nd,state->ds.selectedRxn,state->ds.reactionModeInd,state->flaggedCoincLvls,nuclInd,nuclLvlInd);
+}
+
 uint16_t getNumScreenLvlDispLines(const drawing_state *restrict ds){
 	return (uint16_t)(SDL_floorf((ds->windowYRes - NUCL_FULLINFOBOX_LEVELLIST_POS_Y)/(NUCL_INFOBOX_SMALLLINE_HEIGHT*ds->uiUserScale) - 2*ds->uiUserScale)); //somewhat hacky, to make sure all levels are visible on all UI scales
 }
@@ -3937,6 +3889,41 @@ uint32_t getENSDFTranCommentStrInd(const ndata *restrict nd, const uint32_t tran
 	return MAX_UINT32_VAL;
 }
 
+//finds the starting index of the text of a comment in the comment text index
+//returns MAX_UINT32_VAL if the comment is not available
+uint32_t getCommentIdxDocStrInd(const ndata *restrict nd, const uint32_t docInd){
+	const comment_index_doc *doc = &nd->commentIdxDocs[docInd];
+	if(doc->tranInd != MAX_UINT32_VAL){
+		return getENSDFTranCommentStrInd(nd,doc->tranInd,doc->commentType);
+	}
+	return getENSDFLvlCommentStrInd(nd,doc->lvlInd,doc->commentType);
+}
+
+//reads the next word (run of letters and digits, converted to lowercase) of
+//an ENSDF comment, starting from position pos in the string
+//returns the position just after the end of the word, or 0 if there are no
+//more words, wordStart is set to the position of the start of the word
+uint32_t getNextCommentWord(const char *str, const uint32_t pos, char wordOut[COMMENT_IDX_MAX_WORD_LEN], uint32_t *wordStart){
+	uint32_t strPos = pos;
+	while((str[strPos] != '\0')&&(!SDL_isalnum((unsigned char)str[strPos]))){
+		strPos++;
+	}
+	if(str[strPos] == '\0'){
+		return 0;
+	}
+	*wordStart = strPos;
+	uint8_t len = 0;
+	while(SDL_isalnum((unsigned char)str[strPos])){
+		if(len < (COMMENT_IDX_MAX_WORD_LEN-1)){
+			wordOut[len] = (char)SDL_tolower((unsigned char)str[strPos]);
+			len++;
+		}
+		strPos++;
+	}
+	wordOut[len] = '\0';
+	return strPos;
+}
+
 float mouseXPxToN(const drawing_state *restrict ds, const float mouseX){
 	return ds->chartPosX + ((mouseX - ds->windowXRes/(2.0f))/(DEFAULT_NUCLBOX_DIM*ds->chartZoomScale*ds->uiUserScale));
 }
@@ -4204,85 +4191,23 @@ void panChartToPos(const app_data *restrict dat, drawing_state *restrict ds, con
 //finds the nearest nuclide to the coordinates N,Z (values can be negative)
 //and returns its index
 uint16_t getNearestNuclInd(const app_data *restrict dat, const int16_t N, const int16_t Z){
-	int16_t selectedN = N;
-  int16_t selectedZ = Z;
-	uint8_t loopCtr = 0;
-	uint16_t nuclInd = getNuclInd(&dat->ndat,selectedN,selectedZ);
-	while(nuclInd == MAXNUMNUCL){
-		//try to guess closest
-		if(loopCtr > 10){
-			return MAXNUMNUCL; //safety valve
-		}
-		if((N <= 0)&&(Z <= 0)){
-			if(N < Z){
-				selectedN = 0;
-				selectedZ = 1;
-			}else{
-				selectedN = 0;
-				selectedZ = 1;
-			}
-		}else if((selectedN >= dat->ndat.maxN)&&(selectedZ >= dat->ndat.maxZ)){
-			if((selectedN > dat->ndat.maxN)||(selectedZ > dat->ndat.maxZ)){
-				if(selectedN > dat->ndat.maxN){
-					selectedN = (int16_t)(dat->ndat.maxN);
-				}
-				if(selectedZ > dat->ndat.maxZ){
-					selectedZ = (int16_t)(dat->ndat.maxZ);
-				}
-			}else{
-				selectedN -= 1;
-				selectedZ -= 1;
-			}
-		}else if(selectedN > selectedZ){
-			//go towards N=Z from neutron rich side
-			for(uint8_t i=0; i<100; i++){
-				selectedN -= 1;
-				selectedZ += 1;
-				nuclInd = getNuclInd(&dat->ndat,selectedN,selectedZ);
-				if(nuclInd != MAXNUMNUCL){
-					return nuclInd;
-				}
-			}
-			//if that didn't work, try the opposite direction
-			selectedN += 100;
-			selectedZ -= 100;
-			for(uint8_t i=0; i<100; i++){
-				selectedN += 1;
-				selectedZ -= 1;
-				nuclInd = getNuclInd(&dat->ndat,selectedN,selectedZ);
-				if(nuclInd != MAXNUMNUCL){
-					return nuclInd;
-				}
-			}
-			break; //don't do any more loops
-		}else{
-			//go towards N=Z from neutron deficient side
-			for(uint8_t i=0; i<100; i++){
-				selectedN += 1;
-				selectedZ -= 1;
-				nuclInd = getNuclInd(&dat->ndat,selectedN,selectedZ);
-				if(nuclInd != MAXNUMNUCL){
-					return nuclInd;
-				}
-			}
-			//if that didn't work, try the opposite direction
-			selectedN -= 100;
-			selectedZ += 100;
-			for(uint8_t i=0; i<100; i++){
-				selectedN -= 1;
-				selectedZ += 1;
-				nuclInd = getNuclInd(&dat->ndat,selectedN,selectedZ);
-				if(nuclInd != MAXNUMNUCL){
-					return nuclInd;
-				}
-			}
-			break; //don't do any more loops
-		}
-
-		nuclInd = getNuclInd(&dat->ndat,selectedN,selectedZ);
-		loopCtr++;
+	if(dat->ndat.nuclIndGridBuilt == 0){
+		return getNuclInd(&dat->ndat,N,Z);
 	}
-	return nuclInd;
+	//clamp to the edges of the chart
+	int16_t selectedN = N;
+	int16_t selectedZ = Z;
+	if(selectedN < 0){
+		selectedN = 0;
+	}else if(selectedN >= MAX_NEUTRON_NUM){
+		selectedN = MAX_NEUTRON_NUM-1;
+	}
+	if(selectedZ < 0){
+		selectedZ = 0;
+	}else if(selectedZ >= MAX_PROTON_NUM){
+		selectedZ = MAX_PROTON_NUM-1;
+	}
+	return dat->ndat.nearestNuclIndByNZ[selectedZ][selectedN];
 }
 
 int SDLCALL compareQvals(const void *a, const void *b){
@@ -5110,6 +5035,8 @@ void searchResultClickAction(app_data *restrict dat, app_state *restrict state,
 				state->ds.fcScrollFinished = 0;
 			}
 			break;
+		case SEARCHAGENT_COMMENT: //go to the level the comment belongs to
+		case SEARCHAGENT_SPINPAR:
 		case SEARCHAGENT_ELEVEL:
 			if((state->uiState != UISTATE_FULLLEVELINFO)&&(state->uiState != UISTATE_FULLLEVELINFOWITHMENU)){
 				setSelectedNuclOnChartDirect(dat,state,rdat,(uint16_t)(state->ss.results[resultInd].resultVal[0]),1);
@@ -5179,6 +5106,15 @@ void searchResultClickAction(app_data *restrict dat, app_state *restrict state,
 				state->ds.fcScrollFinished = 0;
 			}
 			break;
+		case SEARCHAGENT_REACTION:
+			//show the level list, filtered by the reaction
+			if((state->uiState != UISTATE_FULLLEVELINFO)&&(state->uiState != UISTATE_FULLLEVELINFOWITHMENU)){
+				setSelectedNuclOnChartDirect(dat,state,rdat,(uint16_t)(state->ss.results[resultInd].resultVal[0]),1);
+				uiElemClickAction(dat,state,rdat,0,UIELEM_NUCL_INFOBOX_ALLLEVELSBUTTON);
+			}
+			state->ds.selectedRxn = (uint8_t)(state->ss.results[resultInd].resultVal[1] + 1);
+			setSelectedNuclOnLevelList(dat,state,rdat,(uint16_t)(dat->ndat.nuclData[state->ss.results[resultInd].resultVal[0]].N),(uint16_t)(dat->ndat.nuclData[state->ss.results[resultInd].resultVal[0]].Z),1); //update and re-draw level list
+			break;
 		default:
 			break;
 	}
@@ -4653,43 +4653,44 @@ void drawSearchMenu(const app_data *restrict dat, const app_state *restrict stat
           drawTextAlignedSized(rdat,drawRect.x+12.0f*state->ds.uiUserScale,drawRect.y+(SEARCH_MENU_RESULT_HEIGHT-32.0f)*state->ds.uiUserScale,grayCol8Bit,FONTSIZE_NORMAL,alpha8,tmpStr,ALIGN_LEFT,16384);
           break;
         case SEARCHAGENT_GAMMACASCADE:
-          if((state->uiState == UISTATE_FULLLEVELINFOWITHMENU)||(state->uiState == UISTATE_FULLLEVELINFO)){
-            int32_t length = 0;
-            uint8_t numCascadeGammas = 0;
-            for(uint8_t j=1; j<SEARCH_RESULT_DATASIZE; j++){
-              if(state->ss.results[i].resultVal[j] == UNUSED_SEARCH_RESULT){
-                break;
-              }
-              numCascadeGammas++;
-            }
-            if(numCascadeGammas > 3){
-              numCascadeGammas = 3; //truncate the string so it fits in the box
-            }
-            for(uint8_t j=1; j<numCascadeGammas; j++){
-              length += SDL_snprintf(tmpStr+length,(uint64_t)(64-length),"%0.0f, ",(double)(dat->ndat.tran[state->ss.results[i].resultVal[j]].energy.val));
+          {//prevent -Wjump-misses-init
+            //list every gamma in the cascade, continuing on the second line (after the
+            //result type label) once the first line is full
+            const float maxLineWidth = (drawRect.w - 24.0f*state->ds.uiUserScale)*rdat->uiDPIScale;
+            const uint8_t lineFont[2] = {FONTSIZE_LARGE,FONTSIZE_NORMAL};
+            char lineStr[2][128], testStr[128];
+            if((state->uiState == UISTATE_FULLLEVELINFOWITHMENU)||(state->uiState == UISTATE_FULLLEVELINFO)){
+              lineStr[0][0] = '\0';
+            }else{
+              getNuclNameStr(eStr,&dat->ndat.nuclData[state->ss.results[i].resultVal[0]],255);
+              SDL_snprintf(lineStr[0],128,"%s – ",eStr);
             }
-            SDL_snprintf(tmpStr+length,(uint64_t)(64-length),"%0.0f keV",(double)(dat->ndat.tran[state->ss.results[i].resultVal[numCascadeGammas]].energy.val));
-          }else{
-            getNuclNameStr(eStr,&dat->ndat.nuclData[state->ss.results[i].resultVal[0]],255);
-            int32_t length = 0;
-            uint8_t numCascadeGammas = 0;
+            SDL_snprintf(lineStr[1],128,"%s: ",dat->strings[dat->locStringIDs[LOCSTR_SEARCHRES_GAMMACASCADE]]);
+            uint8_t line = 0;
             for(uint8_t j=1; j<SEARCH_RESULT_DATASIZE; j++){
               if(state->ss.results[i].resultVal[j] == UNUSED_SEARCH_RESULT){
                 break;
               }
-              numCascadeGammas++;
-            }
-            if(numCascadeGammas > 3){
-              numCascadeGammas = 3; //truncate the string so it fits in the box
+              const uint8_t lastGamma = ((j+1) >= SEARCH_RESULT_DATASIZE)||(state->ss.results[i].resultVal[j+1] == UNUSED_SEARCH_RESULT);
+              SDL_snprintf(eStr2,32,"%0.0f%s",(double)(dat->ndat.tran[state->ss.results[i].resultVal[j]].energy.val),lastGamma ? " keV" : ", ");
+              SDL_snprintf(testStr,128,"%s%s",lineStr[line],eStr2);
+              if((j > 1)&&(getTextWidth(rdat,lineFont[line],testStr) > maxLineWidth)){
+                if(line == 0){
+                  line = 1; //continue on the second line
+                }else{
+                  SDL_strlcat(lineStr[1],"...",128); //no room for the rest of the cascade
+                  break;
+                }
+              }
+              SDL_strlcat(lineStr[line],eStr2,128);
             }
-            length += SDL_snprintf(tmpStr+length,64,"%s – ",eStr);
-            for(uint8_t j=1; j<numCascadeGammas; j++){
-              length += SDL_snprintf(tmpStr+length,(uint64_t)(64-length),"%0.0f, ",(double)(dat->ndat.tran[state->ss.results[i].resultVal[j]].energy.val));
+            if(line == 0){
+              //whole cascade fits on the first line, only the label goes on the second
+              SDL_strlcpy(lineStr[1],dat->strings[dat->locStringIDs[LOCSTR_SEARCHRES_GAMMACASCADE]],128);
             }
-            SDL_snprintf(tmpStr+length,(uint64_t)(64-length),"%0.0f keV",(double)(dat->ndat.tran[state->ss.results[i].resultVal[numCascadeGammas]].energy.val));
+            drawTextAlignedSized(rdat,drawRect.x+12.0f*state->ds.uiUserScale,drawRect.y+(16.0f*state->ds.uiUserScale),textCol,FONTSIZE_LARGE,alpha8,lineStr[0],ALIGN_LEFT,16384); //draw element and cascade label
+            drawTextAlignedSized(rdat,drawRect.x+12.0f*state->ds.uiUserScale,drawRect.y+(SEARCH_MENU_RESULT_HEIGHT-32.0f)*state->ds.uiUserScale,grayCol8Bit,FONTSIZE_NORMAL,alpha8,lineStr[1],ALIGN_LEFT,16384);
           }
-          drawTextAlignedSized(rdat,drawRect.x+12.0f*state->ds.uiUserScale,drawRect.y+(16.0f*state->ds.uiUserScale),textCol,FONTSIZE_LARGE,alpha8,tmpStr,ALIGN_LEFT,16384); //draw element and cascade label
-          drawTextAlignedSized(rdat,drawRect.x+12.0f*state->ds.uiUserScale,drawRect.y+(SEARCH_MENU_RESULT_HEIGHT-32.0f)*state->ds.uiUserScale,grayCol8Bit,FONTSIZE_NORMAL,alpha8,dat->strings[dat->locStringIDs[LOCSTR_SEARCHRES_GAMMACASCADE]],ALIGN_LEFT,16384);
           break;
         case SEARCHAGENT_HALFLIFE:
           getHalfLifeStr(eStr2,dat,state->ss.results[i].resultVal[1],1,0,state->ds.useLifetimes);
@@ -4731,6 +4732,51 @@ void drawSearchMenu(const app_data *restrict dat, const app_state *restrict stat
           }
           drawTextAlignedSized(rdat,drawRect.x+12.0f*state->ds.uiUserScale,drawRect.y+(SEARCH_MENU_RESULT_HEIGHT-32.0f)*state->ds.uiUserScale,grayCol8Bit,FONTSIZE_NORMAL,alpha8,tmpStr,ALIGN_LEFT,16384);
           break;
+        case SEARCHAGENT_COMMENT:
+          if(state->ss.results[i].resultVal[2] != MAX_UINT32_VAL){
+            getGammaEnergyStr(eStr2,&dat->ndat,state->ss.results[i].resultVal[2],1); //transition comment
+          }else{
+            getLvlEnergyStr(eStr2,&dat->ndat,state->ss.results[i].resultVal[1],1); //level comment
+          }
+          if((state->uiState == UISTATE_FULLLEVELINFOWITHMENU)||(state->uiState == UISTATE_FULLLEVELINFO)){
+            SDL_snprintf(tmpStr,64,"%s keV",eStr2);
+          }else{
+            getNuclNameStr(eStr,&dat->ndat.nuclData[state->ss.results[i].resultVal[0]],255);
+            SDL_snprintf(tmpStr,64,"%s – %s keV",eStr,eStr2);
+          }
+          drawTextAlignedSized(rdat,drawRect.x+12.0f*state->ds.uiUserScale,drawRect.y+(16.0f*state->ds.uiUserScale),textCol,FONTSIZE_LARGE,alpha8,tmpStr,ALIGN_LEFT,16384); //draw element and level/transition label
+          //show the comment text starting from the match
+          SDL_snprintf(tmpStr,64,"%s: %s",dat->strings[dat->locStringIDs[LOCSTR_SEARCHRES_COMMENT]],&dat->ndat.ensdfStrBuf[state->ss.results[i].resultVal[3]]);
+          if(SDL_strlen(tmpStr) > 42){
+            tmpStr[42]='.'; tmpStr[43]='.'; tmpStr[44]='.';
+            tmpStr[45]='\0'; //terminate
+          }
+          drawTextAlignedSized(rdat,drawRect.x+12.0f*state->ds.uiUserScale,drawRect.y+(SEARCH_MENU_RESULT_HEIGHT-32.0f)*state->ds.uiUserScale,grayCol8Bit,FONTSIZE_NORMAL,alpha8,tmpStr,ALIGN_LEFT,16384);
+          break;
+        case SEARCHAGENT_SPINPAR:
+          getLvlEnergyStr(eStr2,&dat->ndat,state->ss.results[i].resultVal[1],1);
+          if((state->uiState == UISTATE_FULLLEVELINFOWITHMENU)||(state->uiState == UISTATE_FULLLEVELINFO)){
+            SDL_snprintf(tmpStr,64,"%s keV",eStr2);
+          }else{
+            getNuclNameStr(eStr,&dat->ndat.nuclData[state->ss.results[i].resultVal[0]],255);
+            SDL_snprintf(tmpStr,64,"%s – %s keV",eStr,eStr2);
+          }
+          drawTextAlignedSized(rdat,drawRect.x+12.0f*state->ds.uiUserScale,drawRect.y+(16.0f*state->ds.uiUserScale),textCol,FONTSIZE_LARGE,alpha8,tmpStr,ALIGN_LEFT,16384); //draw element and level label
+          getSpinParStr(eStr2,&dat->ndat,state->ss.results[i].resultVal[1]);
+          SDL_snprintf(tmpStr,64,"%s – %s",dat->strings[dat->locStringIDs[LOCSTR_SEARCHRES_SPINPAR]],eStr2);
+          drawTextAlignedSized(rdat,drawRect.x+12.0f*state->ds.uiUserScale,drawRect.y+(SEARCH_MENU_RESULT_HEIGHT-32.0f)*state->ds.uiUserScale,grayCol8Bit,FONTSIZE_NORMAL,alpha8,tmpStr,ALIGN_LEFT,16384);
+          break;
+        case SEARCHAGENT_REACTION:
+          getRxnStr(eStr2,&dat->ndat,dat->ndat.nuclData[state->ss.results[i].resultVal[0]].firstRxn + state->ss.results[i].resultVal[1]);
+          if((state->uiState == UISTATE_FULLLEVELINFOWITHMENU)||(state->uiState == UISTATE_FULLLEVELINFO)){
+            SDL_snprintf(tmpStr,64,"%s",eStr2);
+          }else{
+            getNuclNameStr(eStr,&dat->ndat.nuclData[state->ss.results[i].resultVal[0]],255);
+            SDL_snprintf(tmpStr,64,"%s – %s",eStr,eStr2);
+          }
+          drawTextAlignedSized(rdat,drawRect.x+12.0f*state->ds.uiUserScale,drawRect.y+(16.0f*state->ds.uiUserScale),textCol,FONTSIZE_LARGE,alpha8,tmpStr,ALIGN_LEFT,16384); //draw element and reaction label
+          drawTextAlignedSized(rdat,drawRect.x+12.0f*state->ds.uiUserScale,drawRect.y+(SEARCH_MENU_RESULT_HEIGHT-32.0f)*state->ds.uiUserScale,grayCol8Bit,FONTSIZE_NORMAL,alpha8,dat->strings[dat->locStringIDs[LOCSTR_SEARCHRES_REACTION]],ALIGN_LEFT,16384);
+          break;
         default:
           continue;
       }
@@ -5103,7 +5149,7 @@ void drawPerformanceStats(const ui_theme_rules *restrict uirules, const app_stat
   //draw background
   SDL_FRect perfOvRect;
   perfOvRect.w = (628.0f*rdat->uiScale);
-  perfOvRect.h = (156.0f*rdat->uiScale);
+  perfOvRect.h = (196.0f*rdat->uiScale);
   perfOvRect.x = (CHART_AXIS_DEPTH*rdat->uiScale);
   perfOvRect.y = 0.0f;
   
@@ -5124,12 +5170,16 @@ void drawPerformanceStats(const ui_theme_rules *restrict uirules, const app_stat
   drawDefaultText(uirules,rdat,PERF_OVERLAY_BUTTON_X_ANCHOR,PERF_OVERLAY_BUTTON_Y_ANCHOR+2*PERF_OVERLAY_Y_SPACING*state->ds.uiUserScale,txtStr);
   SDL_snprintf(txtStr,256,"Chart position: [%3.2f %3.2f], Selected nuclide: %4u",(double)state->ds.chartPosX,(double)state->ds.chartPosY,state->chartSelectedNucl);
   drawDefaultText(uirules,rdat,PERF_OVERLAY_BUTTON_X_ANCHOR,PERF_OVERLAY_BUTTON_Y_ANCHOR+3*PERF_OVERLAY_Y_SPACING*state->ds.uiUserScale,txtStr);
-  SDL_snprintf(txtStr,256,"Active threads: %2u, Selectable strings: %3u, Selected string: %3u [%3u %3u]",tms->numThreads,state->tss.numSelStrs,state->tss.selectedStr,state->tss.selStartPos,state->tss.selEndPos);
+  SDL_snprintf(txtStr,256,"Worker threads: %2u, Selectable strings: %3u, Selected string: %3u [%3u %3u]",tms->numThreads,state->tss.numSelStrs,state->tss.selectedStr,state->tss.selStartPos,state->tss.selEndPos);
   drawDefaultText(uirules,rdat,PERF_OVERLAY_BUTTON_X_ANCHOR,PERF_OVERLAY_BUTTON_Y_ANCHOR+4*PERF_OVERLAY_Y_SPACING*state->ds.uiUserScale,txtStr);
   SDL_snprintf(txtStr,256,"FPS: %4.1f",1.0/((double)deltaTime));
   drawDefaultText(uirules,rdat,PERF_OVERLAY_BUTTON_X_ANCHOR,PERF_OVERLAY_BUTTON_Y_ANCHOR+5*PERF_OVERLAY_Y_SPACING*state->ds.uiUserScale,txtStr);
   SDL_snprintf(txtStr,256,"Frame time (ms): %4.3f",(double)(deltaTime*1000.0f));
   drawDefaultText(uirules,rdat,PERF_OVERLAY_BUTTON_X_ANCHOR,PERF_OVERLAY_BUTTON_Y_ANCHOR+6*PERF_OVERLAY_Y_SPACING*state->ds.uiUserScale,txtStr);
+  SDL_snprintf(txtStr,256,"Search result cache hits: %u, misses: %u",state->ss.resultCache.numHits,state->ss.resultCache.numMisses);
+  drawDefaultText(uirules,rdat,PERF_OVERLAY_BUTTON_X_ANCHOR,PERF_OVERLAY_BUTTON_Y_ANCHOR+7*PERF_OVERLAY_Y_SPACING*state->ds.uiUserScale,txtStr);
+  SDL_snprintf(txtStr,256,"Last search time (ms): %4.3f, slowest task: %2u (%4.3f ms)",(double)tms->lastSearchTime/1.0E6,tms->lastSlowestTask,(double)tms->lastSlowestTaskTime/1.0E6);
+  drawDefaultText(uirules,rdat,PERF_OVERLAY_BUTTON_X_ANCHOR,PERF_OVERLAY_BUTTON_Y_ANCHOR+8*PERF_OVERLAY_Y_SPACING*state->ds.uiUserScale,txtStr);
 }
 
 //meta-function which draws any UI menus, if applicable
@@ -19,6 +19,7 @@ along with this program.  If not, see <https://www.gnu.org/licenses/>.
 
 #include <stdio.h>
 #include "load_data.h"
+#include "search_ops.h"
 
 //function to find and load the app data file, trying various platform-independent
 //and platform-dependent locations
@@ -40,7 +41,9 @@ int findAndLoadAppDataFile(SDL_IOStream **inp, resource_data *restrict rdat, con
       if(strcmp(platformStr,"Linux")==0){
         SDL_snprintf(rdat->appDataFilepath,270,"/usr/share/chart/chart.dat");
       }else{
-        SDL_ShowSimpleMessageBox(SDL_MESSAGEBOX_ERROR,"Error","Could not find platform-specific location for app data file (chart.dat).",rdat->window);
+        if(rdat->window != NULL){ //no message box when running without a window (command line query mode)
+          SDL_ShowSimpleMessageBox(SDL_MESSAGEBOX_ERROR,"Error","Could not find platform-specific location for app data file (chart.dat).",rdat->window);
+        }
         SDL_LogError(SDL_LOG_CATEGORY_APPLICATION,"importAppData - couldn't determine platform specific data file location.\n");
         return -1;
       }
@@ -50,7 +53,9 @@ int findAndLoadAppDataFile(SDL_IOStream **inp, resource_data *restrict rdat, con
         SDL_snprintf(rdat->appDataFilepath,270,"/app/share/chart.dat");
         *inp = SDL_IOFromFile(rdat->appDataFilepath, "rb");
         if(*inp==NULL){
-          SDL_ShowSimpleMessageBox(SDL_MESSAGEBOX_ERROR,"Error","App data file (chart.dat) doesn't exist or is unreadable.",rdat->window);
+          if(rdat->window != NULL){ //no message box when running without a window (command line query mode)
+            SDL_ShowSimpleMessageBox(SDL_MESSAGEBOX_ERROR,"Error","App data file (chart.dat) doesn't exist or is unreadable.",rdat->window);
+          }
           SDL_LogError(SDL_LOG_CATEGORY_APPLICATION,"importAppData - couldn't read data package file %s.\n",rdat->appDataFilepath);
           return -1;
         }
@@ -89,7 +94,7 @@ int importAppData(app_data *restrict dat, const app_state *restrict state, resou
   }
   //read version number
   SDL_ReadIO(inp,&version,sizeof(uint8_t));
-  if(version!=0){
+  if(version!=1){
     SDL_ShowSimpleMessageBox(SDL_MESSAGEBOX_ERROR,"Error","Invalid app data file version.",rdat->window);
     SDL_LogError(SDL_LOG_CATEGORY_APPLICATION,"importAppData - invalid data file version (%u).\n",version);
     return -1;
@@ -124,17 +129,18 @@ int importAppData(app_data *restrict dat, const app_state *restrict state, resou
   SDL_SetSurfaceRLE(rdat->iconSurface, 1); //enable RLE acceleration
 
   //load app_data
-  if((SDL_ReadIO(inp,&fileSize,sizeof(int64_t))!=sizeof(int64_t))||(fileSize!=(int64_t)sizeof(app_data))){
+  if((SDL_ReadIO(inp,&fileSize,sizeof(int64_t))!=sizeof(int64_t))||(fileSize!=(int64_t)APP_DATA_STORED_SIZE)){
     SDL_ShowSimpleMessageBox(SDL_MESSAGEBOX_ERROR,"Error","App data file read error - invalid data size.",rdat->window);
     SDL_LogError(SDL_LOG_CATEGORY_APPLICATION,"importAppData - invalid app_data size (%li) from file %s - %s.\n",(long int)fileSize,rdat->appDataFilepath,SDL_GetError());
-    SDL_Log("Expected: %lu\n",(long unsigned int)sizeof(app_data));
+    SDL_Log("Expected: %lu\n",(long unsigned int)APP_DATA_STORED_SIZE);
     return -1;
   }
-  if(SDL_ReadIO(inp,dat,sizeof(app_data))!=sizeof(app_data)){
+  if(SDL_ReadIO(inp,dat,APP_DATA_STORED_SIZE)!=APP_DATA_STORED_SIZE){
     SDL_ShowSimpleMessageBox(SDL_MESSAGEBOX_ERROR,"Error","App data file read error - could not read data bank.",rdat->window);
     SDL_LogError(SDL_LOG_CATEGORY_APPLICATION,"importAppData - couldn't read app data from file %s - %s.\n",rdat->appDataFilepath,SDL_GetError());
     return -1;
   }
+  buildSearchIndices(&dat->ndat);
 
   //synchronize UI theme setting
   if(state->ds.uiColorTheme < UITHEME_ENUM_LENGTH){
@@ -303,6 +309,71 @@ int importAppData(app_data *restrict dat, const app_state *restrict state, resou
   
 }
 
+//import only the nuclear data and strings (app_data), skipping the icon, UI themes, and fonts,
+//for use without a window or renderer (command line query mode)
+int importAppDataHeadless(app_data *restrict dat, resource_data *restrict rdat){
+
+  SDL_IOStream *inp = NULL;
+  char readStr[6];
+  uint8_t version = 255;
+  int64_t fileSize;
+
+  if(findAndLoadAppDataFile(&inp,rdat,0)==-1){
+    return -1;
+  }
+  //read header
+  if(SDL_ReadIO(inp,readStr,sizeof(readStr))!=sizeof(readStr)){
+    SDL_LogError(SDL_LOG_CATEGORY_APPLICATION,"importAppDataHeadless - couldn't read header from file %s - %s.\n",rdat->appDataFilepath,SDL_GetError());
+    SDL_CloseIO(inp);
+    return -1;
+  }
+  readStr[5]='\0';
+  if(strcmp(readStr,"<>|<>")!=0){
+    SDL_LogError(SDL_LOG_CATEGORY_APPLICATION,"importAppDataHeadless - bad header in data file %s (%s)\n",rdat->appDataFilepath,readStr);
+    SDL_CloseIO(inp);
+    return -1;
+  }
+  //read version number
+  SDL_ReadIO(inp,&version,sizeof(uint8_t));
+  if(version!=1){
+    SDL_LogError(SDL_LOG_CATEGORY_APPLICATION,"importAppDataHeadless - invalid data file version (%u).\n",version);
+    SDL_CloseIO(inp);
+    return -1;
+  }
+
+  //skip over the application icon data
+  fileSize=0;
+  if((SDL_ReadIO(inp,&fileSize,sizeof(int64_t))!=sizeof(int64_t))||(fileSize<=0)){
+    SDL_LogError(SDL_LOG_CATEGORY_APPLICATION,"importAppDataHeadless - invalid application icon filesize (%li) from file %s - %s.\n",(long int)fileSize,rdat->appDataFilepath,SDL_GetError());
+    SDL_CloseIO(inp);
+    return -1;
+  }
+  if(SDL_SeekIO(inp,fileSize,SDL_IO_SEEK_CUR)<0){
+    SDL_LogError(SDL_LOG_CATEGORY_APPLICATION,"importAppDataHeadless - couldn't skip application icon data in file %s - %s.\n",rdat->appDataFilepath,SDL_GetError());
+    SDL_CloseIO(inp);
+    return -1;
+  }
+
+  //load app_data
+  if((SDL_ReadIO(inp,&fileSize,sizeof(int64_t))!=sizeof(int64_t))||(fileSize!=(int64_t)APP_DATA_STORED_SIZE)){
+    SDL_LogError(SDL_LOG_CATEGORY_APPLICATION,"importAppDataHeadless - invalid app_data size (%li) from file %s - %s.\n",(long int)fileSize,rdat->appDataFilepath,SDL_GetError());
+    SDL_Log("Expected: %lu\n",(long unsigned int)APP_DATA_STORED_SIZE);
+    SDL_CloseIO(inp);
+    return -1;
+  }
+  if(SDL_ReadIO(inp,dat,APP_DATA_STORED_SIZE)!=APP_DATA_STORED_SIZE){
+    SDL_LogError(SDL_LOG_CATEGORY_APPLICATION,"importAppDataHeadless - couldn't read app data from file %s - %s.\n",rdat->appDataFilepath,SDL_GetError());
+    SDL_CloseIO(inp);
+    return -1;
+  }
+  buildSearchIndices(&dat->ndat);
+
+  //the rest of the file (UI themes and fonts) isn't needed
+  SDL_CloseIO(inp);
+  SDL_Log("Data import finished (app data only).\n");
+  return 0;
+}
+
 //similar to importAppData, but only handles loading and rescaling the font data
 int regenerateThemeAndFontCache(app_data *restrict dat, const app_state *restrict state, resource_data *restrict rdat){
   
@@ -19,8 +19,11 @@ along with this program.  If not, see <https://www.gnu.org/licenses/>.
 
 #include "search_ops.h"
 #include "data_ops.h"
+#include "ewmatch.h"
 
-#define MAX_CASCADE_GAMMAS 8 //if raised, need to change gammasMatched bit-pattern to a larger size type
+#define MAX_CASCADE_SEARCH_NODES 4096 //maximum number of partial cascades checked per starting transition
+#define SEARCH_MATCH_BLOCK_SIZE  256  //number of index entries checked per call to the energy window kernel
+#define SEARCH_CANCEL_CHECK_INTERVAL 4096 //number of entries checked between cancellation checks in long scans
 
 int SDLCALL compareRelevance(const void *a, const void *b){
 	search_result *resA = ((search_result*)(intptr_t)(a)); //get the search result (double cast to avoid warning)
@@ -37,57 +40,530 @@ int SDLCALL compareRelevance(const void *a, const void *b){
 	return 0;
 }
 
-void sortAndAppendResult(search_state *restrict ss, search_result *restrict res){
+//returns the first slot in the probe sequence of a search result
+static uint8_t getSearchResultHashHome(const uint8_t resultType, const uint32_t val0, const uint32_t val1){
+	uint32_t h = (uint32_t)resultType*0x9E3779B1U ^ val0*0x85EBCA77U ^ val1*0xC2B2AE3DU;
+	h ^= h >> 15;
+	h *= 0x2C1B3C6DU;
+	h ^= h >> 13;
+	return (uint8_t)(h & (SEARCH_RESULT_HASH_SIZE-1));
+}
+
+//returns the hash slot where a search result is found, or the empty slot
+//where it would be inserted if it isn't present
+static uint8_t getSearchResultHashSlot(const search_result_heap *heap, const search_result *res){
+	uint8_t slot = getSearchResultHashHome(res->resultType,res->resultVal[0],res->resultVal[1]);
+	while(heap->hash[slot].used){
+		if((heap->hash[slot].resultType == res->resultType)&&(heap->hash[slot].resultVal[0] == res->resultVal[0])&&(heap->hash[slot].resultVal[1] == res->resultVal[1])){
+			break;
+		}
+		slot = (uint8_t)((slot + 1) & (SEARCH_RESULT_HASH_SIZE-1));
+	}
+	return slot;
+}
+
+//removes a search result from the hash, moving back any subsequent entries
+//in the probe sequence so that no gaps are left
+static void removeSearchResultHash(search_result_heap *heap, const search_result *res){
+	uint8_t gap = getSearchResultHashSlot(heap,res);
+	if(!heap->hash[gap].used){
+		return; //not present
+	}
+	uint8_t next = gap;
+	while(1){
+		next = (uint8_t)((next + 1) & (SEARCH_RESULT_HASH_SIZE-1));
+		if(!heap->hash[next].used){
+			break;
+		}
+		const uint8_t home = getSearchResultHashHome(heap->hash[next].resultType,heap->hash[next].resultVal[0],heap->hash[next].resultVal[1]);
+		//entries whose probe sequence starts after the gap (cyclically) stay where they are
+		const uint8_t stays = (gap <= next) ? ((gap < home)&&(home <= next)) : ((gap < home)||(home <= next));
+		if(!stays){
+			memcpy(&heap->hash[gap],&heap->hash[next],sizeof(search_result_key));
+			gap = next;
+		}
+	}
+	heap->hash[gap].used = 0;
+}
+
+static void swapSearchResults(search_result *a, search_result *b){
+	search_result tmp;
+	memcpy(&tmp,a,sizeof(search_result));
+	memcpy(a,b,sizeof(search_result));
+	memcpy(b,&tmp,sizeof(search_result));
+}
+
+//moves a result in a heap of results down (towards the more relevant results) until the heap is ordered
+static void siftDownSearchResult(search_result_heap *heap, uint8_t pos){
+	while(1){
+		const uint8_t left = (uint8_t)(2*pos + 1);
+		const uint8_t right = (uint8_t)(left + 1);
+		uint8_t smallest = pos;
+		if((left < heap->numRes)&&(heap->res[left].relevance < heap->res[smallest].relevance)){
+			smallest = left;
+		}
+		if((right < heap->numRes)&&(heap->res[right].relevance < heap->res[smallest].relevance)){
+			smallest = right;
+		}
+		if(smallest == pos){
+			break;
+		}
+		swapSearchResults(&heap->res[smallest],&heap->res[pos]);
+		pos = smallest;
+	}
+}
+
+//adds a result to a heap of results, keeping the MAX_SEARCH_RESULTS most relevant ones
+static void insertSearchResult(search_result_heap *heap, const search_result *res){
 
-	SDL_WaitSemaphore(ss->canUpdateResults); //wait while any other threads update the results
-	
 	//check that the result isn't identical to an existing one
-	for(uint8_t i=0; i<ss->numUpdatedResults;i++){
-		if(res->resultType == ss->updatedResults[i].resultType){
-			if(res->resultVal[0] == ss->updatedResults[i].resultVal[0]){
-				if(res->resultVal[1] == ss->updatedResults[i].resultVal[1]){
-					SDL_SignalSemaphore(ss->canUpdateResults); //signal that other threads can now update the results
-					return; //don't append identical results
+	const uint8_t slot = getSearchResultHashSlot(heap,res);
+	if(heap->hash[slot].used){
+		//don't append identical results, but keep the most relevant copy (so that the
+		//results don't depend on the order they were found in, eg. when the search is
+		//split into chunks)
+		for(uint8_t i=0; i<heap->numRes; i++){
+			if((heap->res[i].resultType == res->resultType)&&(heap->res[i].resultVal[0] == res->resultVal[0])&&(heap->res[i].resultVal[1] == res->resultVal[1])){
+				if(res->relevance > heap->res[i].relevance){
+					memcpy(&heap->res[i],res,sizeof(search_result));
+					siftDownSearchResult(heap,i);
 				}
+				break;
+			}
+		}
+		return;
+	}
+
+	//SDL_Log("Appending result with type %u, values [%u %u], relevance %0.3f.\n",res->resultType,res->resultVal[0],res->resultVal[1],(double)res->relevance);
+	if(heap->numRes < MAX_SEARCH_RESULTS){
+		//append the result and sift it up
+		uint8_t pos = heap->numRes;
+		memcpy(&heap->res[pos],res,sizeof(search_result));
+		heap->numRes++;
+		while(pos > 0){
+			const uint8_t parent = (uint8_t)((pos - 1)/2);
+			if(heap->res[parent].relevance <= heap->res[pos].relevance){
+				break;
 			}
+			swapSearchResults(&heap->res[parent],&heap->res[pos]);
+			pos = parent;
 		}
+	}else if(res->relevance > heap->res[0].relevance){
+		//replace the lowest relevance result and sift the new result down
+		removeSearchResultHash(heap,&heap->res[0]);
+		memcpy(&heap->res[0],res,sizeof(search_result));
+		siftDownSearchResult(heap,0);
+	}else{
+		return; //result isn't relevant enough
 	}
 
-	//boost result relevance if neccessary
+	//add the result to the hash (the slot is recomputed, since removing an entry may have moved it)
+	const uint8_t newSlot = getSearchResultHashSlot(heap,res);
+	heap->hash[newSlot].resultType = res->resultType;
+	heap->hash[newSlot].resultVal[0] = res->resultVal[0];
+	heap->hash[newSlot].resultVal[1] = res->resultVal[1];
+	heap->hash[newSlot].used = 1;
+}
+
+//boosts the relevance of a result if neccessary
+static void boostSearchResult(const search_state *restrict ss, search_result *restrict res){
 	if(res->resultType == ss->boostedResultType){
 		res->relevance *= 100.0f;
 	}
-	if((res->resultType == SEARCHAGENT_EGAMMA)||(res->resultType == SEARCHAGENT_ELEVEL)||(res->resultType == SEARCHAGENT_GAMMACASCADE)||(res->resultType == SEARCHAGENT_HALFLIFE)||(res->resultType == SEARCHAGENT_ELEVELDIFF)){
-		if((ss->searchInProgress != SEARCHSTATE_SEARCHING_SINGLENUCL)&&(res->resultVal[0] == ss->boostedNucl)){
+	if((res->resultType == SEARCHAGENT_EGAMMA)||(res->resultType == SEARCHAGENT_ELEVEL)||(res->resultType == SEARCHAGENT_GAMMACASCADE)||(res->resultType == SEARCHAGENT_HALFLIFE)||(res->resultType == SEARCHAGENT_ELEVELDIFF)||(res->resultType == SEARCHAGENT_COMMENT)||(res->resultType == SEARCHAGENT_REACTION)||(res->resultType == SEARCHAGENT_SPINPAR)){
+		if((ss->ctx.searchInProgress != SEARCHSTATE_SEARCHING_SINGLENUCL)&&(res->resultVal[0] == ss->boostedNucl)){
 			//gamma, level, or half-life matching a nuclide
 			res->relevance *= 100.0f;
 		}
 	}
+}
 
-	/*if(res->relevance < 1.0f){
-		return; //don't process low relevance results
-	}*/
+//boosts the relevance of a result if neccessary, and adds it to a heap of results
+static void appendSearchResultToHeap(const search_state *restrict ss, search_result_heap *heap, search_result *restrict res){
+	boostSearchResult(ss,res);
+	insertSearchResult(heap,res);
+}
 
-	//SDL_Log("Appending result with type %u, values [%u %u], relevance %0.3f.\n",res->resultType,res->resultVal[0],res->resultVal[1],(double)res->relevance);
-	//add the result to the list, if possible
-	if(ss->numUpdatedResults < MAX_SEARCH_RESULTS){
-		//append the result
-		memcpy(&ss->updatedResults[ss->numUpdatedResults],res,sizeof(search_result));
-		ss->numUpdatedResults++;
+//adds a result to the results of a search thread (heapInd: the thread's index
+//in ss->threadResults), keeping the MAX_SEARCH_RESULTS most relevant results
+//only the thread running the search agent may write to its heap, so no locking is needed
+void appendSearchResult(search_state *restrict ss, const uint8_t heapInd, search_result *restrict res){
+	appendSearchResultToHeap(ss,&ss->threadResults[heapInd].heap,res);
+}
+
+//frees the memory allocated for searches, once no search threads are running
+void freeSearchState(search_state *ss){
+	SDL_free(ss->commentCand);
+	SDL_free(ss->commentTermDocs);
+	SDL_free(ss->commentPrefixDocs);
+	ss->commentCand = NULL;
+	ss->commentTermDocs = NULL;
+	ss->commentPrefixDocs = NULL;
+	SDL_free(ss->nuclNameShared);
+	ss->nuclNameShared = NULL;
+	for(uint8_t i=0; i<NUM_SEARCH_CHUNKS; i++){
+		SDL_free(ss->cascadeBuf[i].cand);
+		SDL_free(ss->cascadeBuf[i].reach);
+		SDL_memset(&ss->cascadeBuf[i],0,sizeof(cascade_search_buffers));
+	}
+	SDL_aligned_free(ss->threadResults);
+	SDL_free(ss->mergeHeaps);
+	ss->threadResults = NULL;
+	ss->mergeHeaps = NULL;
+}
+
+//copies the parts of the app state which a search depends on (the search mode must already be set),
+//the search threads only read the copy, so the main thread is free to change the app state while they run
+void setSearchContext(const app_state *state, search_context *ctx){
+	SDL_memset(ctx,0,sizeof(search_context));
+	SDL_strlcpy(ctx->searchString,state->ss.searchString,SEARCH_STRING_MAX_SIZE);
+	ctx->chartPosX = state->ds.chartPosX;
+	ctx->chartPosY = state->ds.chartPosY;
+	ctx->chartZoomScale = state->ds.chartZoomScale;
+	if(ctx->chartZoomScale > 5.0f){
+		//the view affects result relevance (see getProximityFactor), quantise it so that
+		//small changes in the view don't change the results (allowing them to be cached,
+		//see getSearchResultCacheKey)
+		ctx->chartPosX = SDL_roundf(ctx->chartPosX);
+		ctx->chartPosY = SDL_roundf(ctx->chartPosY);
+		ctx->chartZoomScale = SDL_roundf(ctx->chartZoomScale*4.0f)/4.0f;
+	}
+	ctx->chartSelectedNucl = state->chartSelectedNucl;
+	ctx->searchInProgress = state->ss.searchInProgress;
+	ctx->selectedRxn = state->ds.selectedRxn;
+	ctx->reactionModeInd = state->ds.reactionModeInd;
+	ctx->useLifetimes = (uint8_t)state->ds.useLifetimes;
+	if(ctx->selectedRxn >= 254){
+		memcpy(ctx->flaggedCoincLvls,state->flaggedCoincLvls,sizeof(ctx->flaggedCoincLvls));
+	}
+}
+
+//sets up the result cache key for a search (from the search context),
+//returns 0 if the results of the search can't be cached
+uint8_t getSearchResultCacheKey(const search_context *ctx, search_result_cache_key *key){
+
+	SDL_memset(key,0,sizeof(search_result_cache_key)); //so that padding can be compared
+
+	//normalize the query
+	size_t len = 0;
+	uint8_t pendingSpace = 0;
+	for(const char *c=ctx->searchString; *c!='\0'; c++){
+		if(*c == ' '){
+			pendingSpace = (len > 0);
+			continue;
+		}
+		if((len + pendingSpace) >= (SEARCH_STRING_MAX_SIZE-1)){
+			break;
+		}
+		if(pendingSpace){
+			key->query[len++] = ' ';
+			pendingSpace = 0;
+		}
+		key->query[len++] = *c;
+	}
+
+	//parts of the view affecting result relevance (see getProximityFactor),
+	//already quantised by setSearchContext
+	if(ctx->chartZoomScale > 5.0f){
+		key->chartPosX = (int16_t)SDL_roundf(ctx->chartPosX);
+		key->chartPosY = (int16_t)SDL_roundf(ctx->chartPosY);
+		key->zoomStep = (int16_t)SDL_roundf(ctx->chartZoomScale*4.0f);
+	}
+	key->chartSelectedNucl = ctx->chartSelectedNucl;
+	key->searchInProgress = ctx->searchInProgress;
+	if(ctx->searchInProgress == SEARCHSTATE_SEARCHING_SINGLENUCL){
+		if(ctx->selectedRxn >= 254){
+			return 0; //results depend on which levels are flagged as coincident (or having the same Jpi)
+		}
+		key->selectedRxn = ctx->selectedRxn;
+		key->reactionModeInd = ctx->reactionModeInd;
+	}
+	key->useLifetimes = ctx->useLifetimes;
+
+	return 1;
+}
+
+//publishes the cached results of the search about to be started (ss->resultCache.searchKey),
+//returns 1 if cached results were found, 0 otherwise
+uint8_t getCachedSearchResults(search_state *restrict ss){
+	search_result_cache *cache = &ss->resultCache;
+	if(cache->searchCacheable){
+		for(uint8_t i=0; i<SEARCH_RESULT_CACHE_SIZE; i++){
+			if((cache->entry[i].lastUsed > 0)&&(memcmp(&cache->entry[i].key,&cache->searchKey,sizeof(search_result_cache_key)) == 0)){
+				cache->useCtr++;
+				cache->entry[i].lastUsed = cache->useCtr;
+				memcpy(ss->results,cache->entry[i].results,sizeof(ss->results));
+				ss->numResults = cache->entry[i].numResults;
+				cache->numHits++;
+				return 1;
+			}
+		}
+	}
+	cache->numMisses++;
+	return 0;
+}
+
+//adds the results of a finished search (ss->results) to the cache,
+//replacing the least recently used entry
+void cacheSearchResults(search_state *restrict ss){
+	search_result_cache *cache = &ss->resultCache;
+	if(!cache->searchCacheable){
+		return;
+	}
+	uint8_t entryInd = 0;
+	for(uint8_t i=0; i<SEARCH_RESULT_CACHE_SIZE; i++){
+		if((cache->entry[i].lastUsed > 0)&&(memcmp(&cache->entry[i].key,&cache->searchKey,sizeof(search_result_cache_key)) == 0)){
+			entryInd = i; //already cached
+			break;
+		}
+		if(cache->entry[i].lastUsed < cache->entry[entryInd].lastUsed){
+			entryInd = i;
+		}
+	}
+	memcpy(&cache->entry[entryInd].key,&cache->searchKey,sizeof(search_result_cache_key));
+	memcpy(cache->entry[entryInd].results,ss->results,sizeof(ss->results));
+	cache->entry[entryInd].numResults = ss->numResults;
+	cache->useCtr++;
+	cache->entry[entryInd].lastUsed = cache->useCtr;
+}
+
+//cancels the search in progress (called by the main thread when the query changes),
+//the search threads stop at their next cancellation check, and their results are discarded
+void cancelSearch(search_state *restrict ss){
+	SDL_AddAtomicInt(&ss->searchGeneration,1);
+}
+
+//returns 1 if the search being run by the search threads was cancelled (ie. the query has changed
+//since it started), search agents check this periodically, and stop searching if it is set
+uint8_t isSearchCancelled(search_state *restrict ss){
+	return (SDL_GetAtomicInt(&ss->searchGeneration) != ss->ctx.generation);
+}
+
+//called by the search thread taking the first task of a search from the queue (with the queue
+//locked, once no tasks of cancelled searches are running), sets up the state shared by the search tasks
+void startSearchTasks(search_state *restrict ss){
+	memcpy(&ss->ctx,&ss->nextCtx,sizeof(search_context));
+	SDL_memset(ss->threadResults,0,NUM_SEARCH_THREADS*sizeof(search_thread_output));
+	if(ss->ctx.searchInProgress == SEARCHSTATE_SEARCHING_SINGLENUCL){
+		ss->boostedNucl = ss->ctx.chartSelectedNucl;
 	}else{
-		//assuming results are already sorted...
-		//overwrite the lowest ranked result with the new result
-		memcpy(&ss->updatedResults[MAX_SEARCH_RESULTS-1],res,sizeof(search_result));
+		ss->boostedNucl = MAXNUMNUCL;
 	}
-	
-	//sort the results by relevance
-	//SDL_Log("Results: %u\n",ss->numUpdatedResults);
-	/*for(uint8_t i=0;i<ss->numUpdatedResults;i++){
-		SDL_Log("  Result %u - rel: %f\n",i,(double)ss->updatedResults[i].relevance);
-	}*/
-	SDL_qsort(&ss->updatedResults,ss->numUpdatedResults,sizeof(ss->updatedResults[0]),compareRelevance);
+	ss->boostedResultType = SEARCHAGENT_TOKENIZE; //default value
+	ss->broadSearch = 0;
+	ss->completeThreadResults = 0; //no other search threads running, so no need to lock
+	ss->publishedThreadResults = 0;
+}
+
+//finds the slots in a search agent's result cache holding the results for each search value,
+//setting up new slots for values which aren't cached (or if the cached results were found with
+//different search parameters)
+//valSlots: slot for each search value
+//searchVals, searchSlots: values which need to be searched for (in the same order as vals), and their slots
+//agentPar: any parameter specific to the agent which the results depend on
+//returns the number of values which need to be searched for
+static uint8_t getTokenCacheSlots(search_token_cache *cache, const search_context *ctx, const search_state *ss, const uint8_t agentPar, const double *vals, const uint8_t numVals, search_token_cache_slot *valSlots[MAX_SEARCH_TOKENS], double searchVals[MAX_SEARCH_TOKENS], search_token_cache_slot *searchSlots[MAX_SEARCH_TOKENS]){
+
+	search_token_cache_key key;
+	SDL_memset(&key,0,sizeof(key)); //so that padding can be compared
+	key.chartPosX = ctx->chartPosX;
+	key.chartPosY = ctx->chartPosY;
+	key.chartZoomScale = ctx->chartZoomScale;
+	key.chartSelectedNucl = ctx->chartSelectedNucl;
+	key.boostedNucl = ss->boostedNucl;
+	key.boostedResultType = ss->boostedResultType;
+	key.broadSearch = ss->broadSearch;
+	key.searchInProgress = ctx->searchInProgress;
+	key.useLifetimes = ctx->useLifetimes;
+	key.selectedRxn = (ctx->searchInProgress == SEARCHSTATE_SEARCHING_SINGLENUCL) ? ctx->selectedRxn : 0;
+	key.agentPar = agentPar;
+	if(memcmp(&key,&cache->key,sizeof(key)) != 0){
+		//search parameters changed, cached results can't be used
+		for(uint8_t i=0; i<SEARCH_TOKEN_CACHE_SLOTS; i++){
+			cache->slot[i].used = 0;
+		}
+		memcpy(&cache->key,&key,sizeof(key));
+	}
+
+	//find cached values
+	uint8_t slotInUse[SEARCH_TOKEN_CACHE_SLOTS];
+	SDL_memset(slotInUse,0,sizeof(slotInUse));
+	for(uint8_t i=0; i<numVals; i++){
+		valSlots[i] = NULL;
+		for(uint8_t j=0; j<SEARCH_TOKEN_CACHE_SLOTS; j++){
+			if((cache->slot[j].used)&&(cache->slot[j].val == vals[i])){
+				valSlots[i] = &cache->slot[j];
+				slotInUse[j] = 1;
+				break;
+			}
+		}
+	}
+
+	//set up slots for the remaining values, replacing cached results
+	//which aren't needed for the current search
+	uint8_t numSearchVals = 0;
+	for(uint8_t i=0; i<numVals; i++){
+		if(valSlots[i] != NULL){
+			continue;
+		}
+		for(uint8_t j=0; j<numSearchVals; j++){
+			if(searchVals[j] == vals[i]){
+				valSlots[i] = searchSlots[j]; //duplicate value
+				break;
+			}
+		}
+		if(valSlots[i] != NULL){
+			continue;
+		}
+		uint8_t slotInd = SEARCH_TOKEN_CACHE_SLOTS;
+		for(uint8_t j=0; j<SEARCH_TOKEN_CACHE_SLOTS; j++){
+			if(!slotInUse[j]){
+				if(!cache->slot[j].used){
+					slotInd = j; //prefer empty slots
+					break;
+				}else if(slotInd == SEARCH_TOKEN_CACHE_SLOTS){
+					slotInd = j;
+				}
+			}
+		}
+		search_token_cache_slot *slot;
+		if(slotInd < SEARCH_TOKEN_CACHE_SLOTS){
+			slot = &cache->slot[slotInd];
+			slot->val = vals[i];
+			slot->res.numRes = 0;
+			SDL_memset(slot->res.hash,0,sizeof(slot->res.hash));
+			slotInUse[slotInd] = 1;
+		}else{
+			//more values than slots, the results for the remaining values are added
+			//to the last slot (only the best results overall are needed), which then
+			//doesn't hold the results for any single value and isn't kept
+			slot = &cache->slot[SEARCH_TOKEN_CACHE_SLOTS-1];
+			slot->val = NAN;
+		}
+		slot->used = 0; //results are incomplete until the search is finished
+		valSlots[i] = slot;
+		searchVals[numSearchVals] = vals[i];
+		searchSlots[numSearchVals] = slot;
+		numSearchVals++;
+	}
+
+	return numSearchVals;
+}
+
+//marks the results found for newly searched values as complete, and adds the results
+//for all search values (cached or not) to the results of a search thread
+static void appendTokenCacheResults(const search_context *ctx, search_state *ss, const uint8_t heapInd, search_token_cache_slot *valSlots[MAX_SEARCH_TOKENS], const uint8_t numVals, search_token_cache_slot *searchSlots[MAX_SEARCH_TOKENS], const uint8_t numSearchVals){
+
+	if(isSearchCancelled(ss)){
+		return; //results for the new values may be incomplete, leave them to be searched again
+	}
+
+	//single nuclide searches filtered by reaction (or coincidence) depend on the
+	//level display state, so their results aren't kept
+	const uint8_t keepResults = ((ctx->searchInProgress == SEARCHSTATE_SEARCHING_SINGLENUCL)&&(ctx->selectedRxn != 0)) ? 0 : 1;
+	for(uint8_t i=0; i<numSearchVals; i++){
+		searchSlots[i]->used = (keepResults && !isnan(searchSlots[i]->val)); //slots shared by several values aren't kept
+	}
+
+	//insertSearchResult keeps the most relevant copy of any result found for
+	//more than one value, so the slots can be added in any order
+	for(uint8_t i=0; i<numVals; i++){
+		if(valSlots[i] == NULL){
+			continue;
+		}
+		uint8_t dupSlot = 0;
+		for(uint8_t j=0; j<i; j++){
+			if(valSlots[j] == valSlots[i]){
+				dupSlot = 1; //already added (duplicate value, or shared slot)
+				break;
+			}
+		}
+		if(dupSlot){
+			continue;
+		}
+		for(uint8_t j=0; j<valSlots[i]->res.numRes; j++){
+			insertSearchResult(&ss->threadResults[heapInd].heap,&valSlots[i]->res.res[j]); //relevance was already boosted
+		}
+	}
+}
+
+//merges the results found by a set of search threads (bit pattern of ss->threadResults entries)
+//into the scratch heap merged, then sorts them by relevance, returns the number of merged results
+static uint8_t mergeThreadResults(const search_state *ss, const uint32_t threads, search_result_heap *merged){
+	merged->numRes = 0;
+	SDL_memset(merged->hash,0,sizeof(merged->hash));
+	for(uint8_t i=0; i<NUM_SEARCH_THREADS; i++){
+		if(threads & (uint32_t)(1U << i)){
+			//different agents can return the same result (eg. structured queries and level searches),
+			//the heap keeps the most relevant copy
+			for(uint8_t j=0; j<ss->threadResults[i].heap.numRes; j++){
+				insertSearchResult(merged,&ss->threadResults[i].heap.res[j]); //relevance was already boosted
+			}
+		}
+	}
+	SDL_qsort(merged->res,merged->numRes,sizeof(search_result),compareRelevance); //heap order isn't needed anymore
+	return merged->numRes;
+}
+
+//merges the results found by all search threads into ss->updatedResults,
+//sorted by relevance (called once all search threads are finished)
+void mergeSearchResults(search_state *restrict ss){
+	search_result_heap *merged = &ss->mergeHeaps[NUM_SEARCH_THREADS]; //main thread's scratch heap
+	ss->numUpdatedResults = mergeThreadResults(ss,(uint32_t)((1U << NUM_SEARCH_THREADS) - 1U),merged);
+	memcpy(ss->updatedResults,merged->res,ss->numUpdatedResults*sizeof(search_result));
+}
+
+//called by a search thread once it has finished, flags its results (bit pattern of
+//ss->threadResults entries) as complete, and publishes the merged results of all
+//threads finished so far, so that they can be shown while the other threads are
+//still searching (nothing is published until some results are found, so that the
+//results of the previous search are shown until then)
+void publishSearchResults(search_state *restrict ss, const uint32_t threads){
+	SDL_LockSpinlock(&ss->publishLock);
+	ss->completeThreadResults |= threads;
+	const uint32_t complete = ss->completeThreadResults;
+	SDL_UnlockSpinlock(&ss->publishLock);
+	//merge without holding the lock, in the scratch heap belonging to this thread's results
+	search_result_heap *merged = &ss->mergeHeaps[SDL_MostSignificantBitIndex32(threads)];
+	const uint8_t numRes = mergeThreadResults(ss,complete,merged);
+	if(numRes == 0){
+		return;
+	}
+	SDL_LockSpinlock(&ss->publishLock);
+	if((ss->publishedThreadResults & ~complete) == 0){ //another thread may have published results merged from more threads in the meantime
+		//write the back buffer (which the main thread isn't reading), then swap it to the front
+		const int backInd = 1 - SDL_GetAtomicInt(&ss->publishedResultsInd);
+		search_result_buffer *buf = &ss->publishedResults[backInd];
+		memcpy(buf->results,merged->res,numRes*sizeof(search_result));
+		buf->numResults = numRes;
+		buf->generation = ss->ctx.generation;
+		ss->publishedThreadResults = complete;
+		SDL_SetAtomicInt(&ss->publishedResultsInd,backInd);
+		SDL_AddAtomicInt(&ss->numPublishedResults,1);
+	}
+	SDL_UnlockSpinlock(&ss->publishLock);
+}
 
-	SDL_SignalSemaphore(ss->canUpdateResults); //signal that other threads can now update the results
+//called by the main thread during a search, copies the most recently published
+//results to ss->results, returns 1 if there were new results to show
+uint8_t getPublishedSearchResults(search_state *restrict ss){
+	const int numPublished = SDL_GetAtomicInt(&ss->numPublishedResults);
+	if(numPublished == ss->numShownPublishedResults){
+		return 0; //nothing new
+	}
+	search_result_buffer buf;
+	memcpy(&buf,&ss->publishedResults[SDL_GetAtomicInt(&ss->publishedResultsInd)],sizeof(search_result_buffer));
+	SDL_MemoryBarrierAcquire();
+	if(SDL_GetAtomicInt(&ss->numPublishedResults) != numPublished){
+		return 0; //buffer was re-used while being copied, the thread which did so will wake the main thread again
+	}
+	ss->numShownPublishedResults = numPublished;
+	if(buf.generation != ss->runningSearchGeneration){
+		return 0; //stale results from a previous (cancelled) search
+	}
+	memcpy(ss->results,buf.results,sizeof(buf.results));
+	ss->numResults = buf.numResults;
+	return 1;
 }
 
 //breaks the search string down into smaller tokens
@@ -95,7 +571,7 @@ void tokenizeSearchStr(search_state *restrict ss){
 	char searchStrCpy[SEARCH_STRING_MAX_SIZE], *tok;
 	char *saveptr = NULL;
 	uint8_t numTok = 0;
-	memcpy(searchStrCpy,ss->searchString,sizeof(ss->searchString));
+	memcpy(searchStrCpy,ss->ctx.searchString,sizeof(ss->ctx.searchString));
 	tok = SDL_strtok_r(searchStrCpy," ,",&saveptr);
 	while(tok!=NULL){
 		if(SDL_strlen(tok) > 0){
@@ -108,6 +584,7 @@ void tokenizeSearchStr(search_state *restrict ss){
 		tok=SDL_strtok_r(NULL," ,",&saveptr);
 	}
 	ss->numSearchTok = numTok;
+	compileQueryPlan(ss->ctx.searchString,&ss->queryPlan);
 
 	/*printf("%u search tokens:",ss->numSearchTok);
 	for(uint8_t i=0; i<ss->numSearchTok; i++){
@@ -117,8 +594,73 @@ void tokenizeSearchStr(search_state *restrict ss){
 
 }
 
-void searchELevel(const ndata *restrict ndat, const app_state *state, search_state *ss){
-	for(uint8_t i=0; i<state->ss.numSearchTok; i++){
+//returns 1 if a level is shown in the level list, given the reaction (or coincidence)
+//filter that the search was started with (see isLvlDisplayed)
+static uint8_t isSearchLvlDisplayed(const ndata *restrict ndat, const search_context *ctx, const uint16_t nuclInd, const uint16_t nuclLvlInd){
+	return isLvlDisplayedForRxn(ndat,ctx->selectedRxn,ctx->reactionModeInd,ctx->flaggedCoincLvls,nuclInd,nuclLvlInd);
+}
+
+//factor used to boost the relevance of results from nuclides close
+//to the area of the chart currently being viewed
+static float getProximityFactor(const ndata *restrict ndat, const search_context *ctx, const uint16_t nuclInd){
+	float proximityFactor = 0.0f;
+	if(ctx->chartZoomScale > 5.0f){
+		if(ctx->chartSelectedNucl != MAXNUMNUCL){
+			//offset proximity center point based on presence of nuclide info box
+			proximityFactor = SDL_sqrtf(fabsf((float)ndat->nuclData[nuclInd].Z - ctx->chartPosY - (16.0f/ctx->chartZoomScale)) + fabsf((float)ndat->nuclData[nuclInd].N - ctx->chartPosX) + 0.1f);
+		}else{
+			proximityFactor = SDL_sqrtf(fabsf((float)ndat->nuclData[nuclInd].Z - ctx->chartPosY) + fabsf((float)ndat->nuclData[nuclInd].N - ctx->chartPosX) + 0.1f);
+		}
+		if(proximityFactor < 2.0f){
+			proximityFactor = 2.0f;
+		}
+		proximityFactor = 1.0f*ctx->chartZoomScale/proximityFactor;
+		if(proximityFactor > 100.0f){
+			proximityFactor = 100.0f;
+		}
+	}
+	return proximityFactor;
+}
+
+//returns the half-width of the window around a value (with uncertainty err) in
+//which searched values match it: 3 sigma, and at least 0.5% of the value
+static double getMatchErrBound(const double value, const double err){
+	double errBound = 3.0*err;
+	if(errBound < value*0.005){
+		errBound = value*0.005;
+	}
+	return errBound;
+}
+
+//as getMatchErrBound, for energies in keV (the window is at least 3 keV wide on either side)
+static double getEnergyMatchErrBound(const double value, const double err){
+	double errBound = getMatchErrBound(value,err);
+	if(errBound < 3.0){
+		errBound = 3.0;
+	}
+	return errBound;
+}
+
+//returns the index of the first entry in the level energy index with energy >= eMin
+static uint32_t getFirstLvlIdxEntry(const ndata *restrict ndat, const double eMin){
+	uint32_t lo = 0;
+	uint32_t hi = ndat->numLvlIdx;
+	while(lo < hi){
+		uint32_t mid = lo + (hi - lo)/2;
+		if(ndat->lvlIdx[mid].energy < eMin){
+			lo = mid + 1;
+		}else{
+			hi = mid;
+		}
+	}
+	return lo;
+}
+
+//collects the values of all numeric search tokens (eg. energies), sorted and
+//without duplicates, returns the number of values
+static uint8_t getNumericSearchVals(const search_state *ss, double vals[MAX_SEARCH_TOKENS]){
+	uint8_t numVals = 0;
+	for(uint8_t i=0; i<ss->numSearchTok; i++){
 
 		//first, filter out any tokens with characters
 		uint8_t isNum = 1;
@@ -132,364 +674,597 @@ void searchELevel(const ndata *restrict ndat, const app_state *state, search_sta
 			continue; //check next search token
 		}
 
-		double eSearch = SDL_atof(ss->searchTok[i]);
-		if(eSearch > 0.0){
-			//valid energy
-			for(int16_t j=0; j<ndat->numNucl; j++){
+		const double val = SDL_atof(ss->searchTok[i]);
+		if(val > 0.0){
+			//insert in order
+			uint8_t pos = numVals;
+			while((pos > 0)&&(vals[pos-1] > val)){
+				pos--;
+			}
+			if((pos > 0)&&(vals[pos-1] == val)){
+				continue; //duplicate
+			}
+			SDL_memmove(&vals[pos+1],&vals[pos],(size_t)(numVals - pos)*sizeof(double));
+			vals[pos] = val;
+			numVals++;
+		}
+	}
+	return numVals;
+}
+
+//returns the number of sorted search values, starting from the specified one, whose
+//match windows are close enough together to be checked at once with the energy window kernel
+static uint8_t getSearchValGroupLen(const double *vals, const uint8_t numVals, const uint8_t first, const double maxErrBound){
+	uint8_t len = 1;
+	while(((first + len) < numVals)&&(len < EWM_MAX_QUERIES)&&((vals[first+len] - vals[first+len-1]) <= 2.0*maxErrBound)){
+		len++;
+	}
+	return len;
+}
 
-				if((ss->searchInProgress == SEARCHSTATE_SEARCHING_SINGLENUCL)&&(j!=ss->boostedNucl)){
-					//if doing a single-nuclide search, skip all other nuclides
-					continue;
-				}
+void searchELevel(const ndata *restrict ndat, const search_context *ctx, search_state *ss){
 
-				float proximityFactor = 0.0f;
-				if(state->ds.chartZoomScale > 5.0f){
-					if(state->chartSelectedNucl != MAXNUMNUCL){
-						//offset proximity center point based on presence of nuclide info box
-						proximityFactor = SDL_sqrtf(fabsf((float)ndat->nuclData[j].Z - state->ds.chartPosY - (16.0f/state->ds.chartZoomScale)) + fabsf((float)ndat->nuclData[j].N - state->ds.chartPosX) + 0.1f);
-					}else{
-						proximityFactor = SDL_sqrtf(fabsf((float)ndat->nuclData[j].Z - state->ds.chartPosY) + fabsf((float)ndat->nuclData[j].N - state->ds.chartPosX) + 0.1f);
-					}
-					if(proximityFactor < 2.0f){
-						proximityFactor = 2.0f;
-					}
-					proximityFactor = 1.0f*state->ds.chartZoomScale/proximityFactor;
-					if(proximityFactor > 100.0f){
-						proximityFactor = 100.0f;
-					}
-				}
+	if(ss->queryPlan.numClauses > 0){
+		return; //structured queries are handled by searchQuery
+	}
 
-				for(uint32_t k=ndat->nuclData[j].firstLevel; k<(ndat->nuclData[j].firstLevel + (uint32_t)ndat->nuclData[j].numLevels); k++){
-					
-					//for single nuclide searches, if a specific reaction is selected,
-					//do not search levels that are not populated in that reaction
-					if((ss->searchInProgress == SEARCHSTATE_SEARCHING_SINGLENUCL)&&(state->ds.selectedRxn != 0)){
-						if(isLvlDisplayed(ndat,state,(uint16_t)j,(uint16_t)(k -ndat->nuclData[j].firstLevel))==0){
+	double eVals[MAX_SEARCH_TOKENS];
+	const uint8_t numEVals = getNumericSearchVals(ss,eVals);
+
+	//only search for energies which don't have cached results
+	search_token_cache_slot *valSlots[MAX_SEARCH_TOKENS], *searchSlots[MAX_SEARCH_TOKENS];
+	double eSearch[MAX_SEARCH_TOKENS];
+	const uint8_t numESearch = getTokenCacheSlots(&ss->tokenCache[TOKENCACHE_ELEVEL],ctx,ss,0,eVals,numEVals,valSlots,eSearch,searchSlots);
+
+	double maxErrBound = (double)ndat->lvlIdxMaxErrBound;
+	double errScale = 1.0;
+	if(ss->broadSearch == 1){
+		maxErrBound = maxErrBound*5.0;
+		errScale = 5.0;
+	}
+
+	ewm_layout layout;
+	layout.stride = sizeof(level_index_entry);
+	layout.valOffset = offsetof(level_index_entry,energy);
+	layout.errOffset = offsetof(level_index_entry,errBound);
+	layout.errIsDouble = 0;
+	uint8_t groupStart = 0;
+	while(groupStart < numESearch){
+		//look up only the levels which could match the energies, checking
+		//energies with overlapping windows together
+		const uint8_t groupLen = getSearchValGroupLen(eSearch,numESearch,groupStart,maxErrBound);
+		const uint32_t firstEnt = getFirstLvlIdxEntry(ndat,eSearch[groupStart] - maxErrBound);
+		const uint32_t lastEnt = getFirstLvlIdxEntry(ndat,nextafter(eSearch[groupStart+groupLen-1] + maxErrBound,(double)INFINITY));
+		for(uint32_t blockStart=firstEnt; blockStart<lastEnt; blockStart+=SEARCH_MATCH_BLOCK_SIZE){
+			if(isSearchCancelled(ss)){
+				return;
+			}
+			const uint32_t blockLen = ((lastEnt - blockStart) < SEARCH_MATCH_BLOCK_SIZE) ? (lastEnt - blockStart) : SEARCH_MATCH_BLOCK_SIZE;
+			const uint32_t numWords = EWM_NUM_MASK_WORDS(blockLen);
+			uint64_t masks[EWM_MAX_QUERIES*EWM_NUM_MASK_WORDS(SEARCH_MATCH_BLOCK_SIZE)];
+			layout.base = &ndat->lvlIdx[blockStart];
+			ewm_matchBlock(&layout,blockLen,0.0,errScale,&eSearch[groupStart],groupLen,masks);
+			for(uint8_t q=0; q<groupLen; q++){
+				for(uint32_t w=0; w<numWords; w++){
+					uint64_t bits = masks[q*numWords + w];
+					for(uint32_t b=0; bits!=0; b++, bits>>=1){
+						if((bits & 1U) == 0){
 							continue;
 						}
-					}
-								
-					if((((ndat->levels[k].energy.format >> 5U) & 15U)) == VALUETYPE_NUMBER){ //ignore variable energy
-						double rawEVal = getRawValFromDB(&ndat->levels[k].energy);
-						double rawErrVal = getRawErrFromDB(&ndat->levels[k].energy);
-						if(rawEVal > 0.0){
-							double errBound = 3.0*rawErrVal;
-							if(errBound < rawEVal*0.005){
-								errBound = rawEVal*0.005;
-							}
-							if(errBound < 3.0){
-								errBound = 3.0;
-							}
-							if(ss->broadSearch == 1){
-								errBound = errBound*5.0;
-							}
-							if(((rawEVal - errBound) <= eSearch)&&((rawEVal + errBound) >= eSearch)){
-								//energy matches query
-								search_result res;
-								res.relevance = 0.6f; //base value
-								res.relevance += proximityFactor;
-								res.relevance -= (float)(rawErrVal/rawEVal); //weight by size of error bars
-								res.relevance /= (1.0f + (float)fabs(0.1*(eSearch - rawEVal))); //weight by distance from value
-								res.resultType = SEARCHAGENT_ELEVEL;
-								res.resultVal[0] = (uint32_t)j; //nuclide index
-								res.resultVal[1] = (uint32_t)k; //level index
-								//SDL_Log("Found level %u\n",res.resultVal[1]);
-								sortAndAppendResult(ss,&res);
+						//energy matches query
+						const level_index_entry *ent = &ndat->lvlIdx[blockStart + w*64U + b];
+						const uint16_t j = ent->nuclInd;
+						const uint32_t k = ent->lvlInd;
+
+						if((ctx->searchInProgress == SEARCHSTATE_SEARCHING_SINGLENUCL)&&(j!=ss->boostedNucl)){
+							//if doing a single-nuclide search, skip all other nuclides
+							continue;
+						}
+
+						//for single nuclide searches, if a specific reaction is selected,
+						//do not search levels that are not populated in that reaction
+						if((ctx->searchInProgress == SEARCHSTATE_SEARCHING_SINGLENUCL)&&(ctx->selectedRxn != 0)){
+							if(isSearchLvlDisplayed(ndat,ctx,j,(uint16_t)(k -ndat->nuclData[j].firstLevel))==0){
+								continue;
 							}
 						}
+
+						const double rawEVal = ent->energy;
+						const double rawErrVal = getRawErrFromDB(&ndat->levels[k].energy);
+						search_result res;
+						res.relevance = 0.6f; //base value
+						res.relevance += getProximityFactor(ndat,ctx,j);
+						res.relevance -= (float)(rawErrVal/rawEVal); //weight by size of error bars
+						res.relevance /= (1.0f + (float)fabs(0.1*(eSearch[groupStart+q] - rawEVal))); //weight by distance from value
+						res.resultType = SEARCHAGENT_ELEVEL;
+						res.resultVal[0] = (uint32_t)j; //nuclide index
+						res.resultVal[1] = k; //level index
+						//SDL_Log("Found level %u\n",res.resultVal[1]);
+						appendSearchResultToHeap(ss,&searchSlots[groupStart+q]->res,&res);
 					}
 				}
 			}
 		}
+		groupStart = (uint8_t)(groupStart + groupLen);
+	}
+
+	appendTokenCacheResults(ctx,ss,SEARCHAGENT_ELEVEL,valSlots,numEVals,searchSlots,numESearch);
+}
+
+//returns the index of the results (in ss->threadResults) written by a chunk of a search agent
+//(the first chunk of every agent uses the agent's own results, additional chunks of the chunked
+//agents use the results after those of the agents)
+uint8_t getSearchResultHeapInd(const uint8_t agent, const uint8_t chunkInd){
+	if(chunkInd == 0){
+		return agent;
+	}
+	switch(agent){
+		case SEARCHAGENT_ELEVELDIFF:
+			return (uint8_t)(SEARCHAGENT_ENUM_LENGTH + chunkInd - 1);
+		case SEARCHAGENT_GAMMACASCADE:
+			return (uint8_t)(SEARCHAGENT_ENUM_LENGTH + (NUM_SEARCH_CHUNKS - 1) + chunkInd - 1);
+		default:
+			return agent; //agent isn't split into chunks
+	}
+}
+
+//splits the nuclear data into chunks for the slowest search agents, balanced so that each
+//chunk has roughly the same number of levels and transitions (the work done by the level
+//energy difference and gamma cascade searches), heavy nuclides may be split across chunks
+void setSearchChunks(const ndata *restrict ndat, search_state *restrict ss){
+	uint64_t totalWork = 0;
+	for(uint16_t j=0; j<ndat->numNucl; j++){
+		const nucl_level_index_entry *nuclEnt = &ndat->nuclLvlIdx[ndat->nuclData[j].firstLevel];
+		for(uint16_t k=0; k<ndat->numNuclLvlIdx[j]; k++){
+			totalWork += 1U + ndat->levels[nuclEnt[k].lvlInd].numTran;
+		}
+	}
+	uint8_t chunkInd = 0;
+	uint64_t work = 0;
+	for(uint16_t j=0; j<ndat->numNucl; j++){
+		const nucl_level_index_entry *nuclEnt = &ndat->nuclLvlIdx[ndat->nuclData[j].firstLevel];
+		for(uint16_t k=0; k<ndat->numNuclLvlIdx[j]; k++){
+			while((chunkInd < NUM_SEARCH_CHUNKS)&&(work >= (totalWork*chunkInd)/NUM_SEARCH_CHUNKS)){
+				//start the next chunk at this entry
+				ss->chunk[chunkInd].firstNucl = j;
+				ss->chunk[chunkInd].firstEnt = k;
+				chunkInd++;
+			}
+			work += 1U + ndat->levels[nuclEnt[k].lvlInd].numTran;
+		}
+	}
+	//remaining chunks (if there are fewer entries than chunks) are empty
+	while(chunkInd <= NUM_SEARCH_CHUNKS){
+		ss->chunk[chunkInd].firstNucl = (uint16_t)ndat->numNucl;
+		ss->chunk[chunkInd].firstEnt = 0;
+		chunkInd++;
 	}
+	ss->chunk[0].firstNucl = 0; //nuclides before the first entry belong to the first chunk
+	ss->chunk[0].firstEnt = 0;
 }
 
-void searchELevelDiff(const ndata *restrict ndat, const app_state *state, search_state *ss){
+//searches for level energy differences, only the levels in one chunk of the data
+//(ss->chunk) are searched, so that the search can be split across multiple threads
+void searchELevelDiff(const ndata *restrict ndat, const search_context *ctx, search_state *ss, const uint8_t chunkInd){
 
-	//only search this type if asked to
-	if(ss->boostedResultType != SEARCHAGENT_ELEVELDIFF){
+	if(ss->queryPlan.numClauses > 0){
+		return; //structured queries are handled by searchQuery
+	}
+
+	if(chunkInd >= NUM_SEARCH_CHUNKS){
+		SDL_Log("ERROR: searchELevelDiff - invalid chunk index (%u).\n",chunkInd);
 		return;
 	}
 
-	for(uint8_t i=0; i<ss->numSearchTok; i++){
+	//each chunk runs on its own thread, with its own results
+	const uint8_t heapInd = getSearchResultHeapInd(SEARCHAGENT_ELEVELDIFF,chunkInd);
+	const search_chunk *chunkStart = &ss->chunk[chunkInd];
+	const search_chunk *chunkEnd = &ss->chunk[chunkInd+1];
 
-		//first, filter out any tokens with characters
-		uint8_t isNum = 1;
-		for(uint16_t j=0; j<SDL_strlen(ss->searchTok[i]); j++){
-			if(isalpha(ss->searchTok[i][j])){
-				isNum = 0;
-				break;
+	double eVals[MAX_SEARCH_TOKENS];
+	const uint8_t numEVals = getNumericSearchVals(ss,eVals);
+
+	//only search for energies which don't have cached results
+	search_token_cache_slot *valSlots[MAX_SEARCH_TOKENS], *searchSlots[MAX_SEARCH_TOKENS];
+	double eSearchVals[MAX_SEARCH_TOKENS];
+	const uint8_t numESearch = getTokenCacheSlots(&ss->tokenCache[TOKENCACHE_ELEVELDIFF+chunkInd],ctx,ss,NUM_SEARCH_CHUNKS,eVals,numEVals,valSlots,eSearchVals,searchSlots);
+
+	const double errScale = (ss->broadSearch == 1) ? 5.0 : 1.0;
+	for(uint8_t i=0; i<numESearch; i++){
+		const double eSearch = eSearchVals[i];
+		for(uint16_t j=chunkStart->firstNucl; (j<ndat->numNucl)&&(j<=chunkEnd->firstNucl); j++){
+
+			if((ctx->searchInProgress == SEARCHSTATE_SEARCHING_SINGLENUCL)&&(j!=ss->boostedNucl)){
+				//if doing a single-nuclide search, skip all other nuclides
+				continue;
 			}
-		}
-		if(isNum == 0){
-			continue; //check next search token
-		}
 
-		double eSearch = SDL_atof(ss->searchTok[i]);
-		if(eSearch > 0.0){
-			//valid energy
-			for(uint16_t j=0; j<ndat->numNucl; j++){
+			if(isSearchCancelled(ss)){
+				return;
+			}
 
-				if((ss->searchInProgress == SEARCHSTATE_SEARCHING_SINGLENUCL)&&(j!=ss->boostedNucl)){
-					//if doing a single-nuclide search, skip all other nuclides
-					continue;
-				}
+			//range of level energy differences which could match the query, based
+			//on the largest level energy uncertainty in the nuclide
+			const double maxPairErrBound = errScale*6.0*ndat->nuclLvlIdxMaxErr[j];
+			double diffMin = eSearch - maxPairErrBound;
+			if(diffMin > eSearch/(1.0 + errScale*0.005)){
+				diffMin = eSearch/(1.0 + errScale*0.005);
+			}
+			double diffMax = eSearch + maxPairErrBound;
+			if(diffMax < eSearch/(1.0 - errScale*0.005)){
+				diffMax = eSearch/(1.0 - errScale*0.005);
+			}
+			diffMin -= 1.0E-6; //rounding margin
+			diffMax += 1.0E-6;
 
-				float proximityFactor = 0.0f;
-				if(state->ds.chartZoomScale > 5.0f){
-					if(state->chartSelectedNucl != MAXNUMNUCL){
-						//offset proximity center point based on presence of nuclide info box
-						proximityFactor = SDL_sqrtf(fabsf((float)ndat->nuclData[j].Z - state->ds.chartPosY - (16.0f/state->ds.chartZoomScale)) + fabsf((float)ndat->nuclData[j].N - state->ds.chartPosX) + 0.1f);
-					}else{
-						proximityFactor = SDL_sqrtf(fabsf((float)ndat->nuclData[j].Z - state->ds.chartPosY) + fabsf((float)ndat->nuclData[j].N - state->ds.chartPosX) + 0.1f);
-					}
-					if(proximityFactor < 2.0f){
-						proximityFactor = 2.0f;
-					}
-					proximityFactor = 1.0f*state->ds.chartZoomScale/proximityFactor;
-					if(proximityFactor > 100.0f){
-						proximityFactor = 100.0f;
+			float proximityFactor = getProximityFactor(ndat,ctx,j);
+			
+			//slide a window over the energy-sorted levels of the nuclide
+			const nucl_level_index_entry *nuclEnt = &ndat->nuclLvlIdx[ndat->nuclData[j].firstLevel];
+			const uint16_t numEnt = ndat->numNuclLvlIdx[j];
+			const uint16_t firstEnt = (j == chunkStart->firstNucl) ? chunkStart->firstEnt : 0;
+			const uint16_t lastEnt = (j == chunkEnd->firstNucl) ? chunkEnd->firstEnt : numEnt; //levels from here on are in the next chunk
+			uint16_t windowStart = 0;
+			for(uint16_t k=firstEnt; k<lastEnt; k++){
+
+				//for single nuclide searches, if a specific reaction is selected,
+				//do not search levels that are not populated in that reaction
+				if((ctx->searchInProgress == SEARCHSTATE_SEARCHING_SINGLENUCL)&&(ctx->selectedRxn != 0)){
+					if(isSearchLvlDisplayed(ndat,ctx,j,(uint16_t)(nuclEnt[k].lvlInd -ndat->nuclData[j].firstLevel))==0){
+						continue;
 					}
 				}
-				
-				uint32_t lastLvlInd = (ndat->nuclData[j].firstLevel + (uint32_t)ndat->nuclData[j].numLevels);
-				for(uint32_t k=ndat->nuclData[j].firstLevel; k<lastLvlInd; k++){
 
-					//for single nuclide searches, if a specific reaction is selected,
-					//do not search levels that are not populated in that reaction
-					if((ss->searchInProgress == SEARCHSTATE_SEARCHING_SINGLENUCL)&&(state->ds.selectedRxn != 0)){
-						if(isLvlDisplayed(ndat,state,(uint16_t)j,(uint16_t)(k -ndat->nuclData[j].firstLevel))==0){
-							continue;
-						}
+				while((windowStart < numEnt)&&((nuclEnt[windowStart].energy - nuclEnt[k].energy) < diffMin)){
+					windowStart++;
+				}
+				for(uint16_t l=((windowStart > k) ? windowStart : (uint16_t)(k+1)); l<numEnt; l++){
+					
+					double diffVal = nuclEnt[l].energy - nuclEnt[k].energy;
+					if(diffVal > diffMax){
+						break; //past the end of the window
 					}
+					const double errBound = getMatchErrBound(diffVal,nuclEnt[l].err + nuclEnt[k].err)*errScale;
 
-					if((((ndat->levels[k].energy.format >> 5U) & 15U)) == VALUETYPE_NUMBER){ //ignore variable energy
-						for(uint32_t l=k+1; l<lastLvlInd; l++){
-							if((((ndat->levels[l].energy.format >> 5U) & 15U)) == VALUETYPE_NUMBER){ //ignore variable energy
-
-								double diffVal = SDL_fabs(getRawValFromDB(&ndat->levels[l].energy) - getRawValFromDB(&ndat->levels[k].energy));
-								double errBound = 3.0*(getRawErrFromDB(&ndat->levels[l].energy) + getRawErrFromDB(&ndat->levels[k].energy));
-								if(errBound < diffVal*0.005){
-									errBound = diffVal*0.005;
-								}
-								if(ss->broadSearch == 1){
-									errBound = errBound*5.0;
-								}
-
-								if((diffVal - errBound) > eSearch){
-									//level energy difference is too high
-									//assume levels are ordered by energy
-									break;
-								}else if(diffVal > 0.0){
-									if((diffVal + errBound) >= eSearch){
-										//energy matches query
-										search_result res;
-										res.relevance = 1.0f; //base value
-										res.relevance += proximityFactor;
-										res.relevance -= (float)(errBound/diffVal); //weight by size of error bars
-										res.relevance -= (float)(getRawValFromDB(&ndat->levels[l].energy)/1000000.0); //weight by level energy (prefer lower levels)
-										res.relevance /= (1.0f + (float)fabs(0.1*(eSearch - diffVal))); //weight by distance from value
-										//SDL_Log("relevance: %f\n",(double)res.relevance);
-										if(res.relevance > 0.9f){
-											res.resultType = SEARCHAGENT_ELEVELDIFF;
-											res.resultVal[0] = (uint32_t)j; //nuclide index
-											res.resultVal[1] = (uint32_t)k; //level index
-											res.resultVal[2] = (uint32_t)l; //level index
-											//SDL_Log("Found level %u\n",res.resultVal[1]);
-											sortAndAppendResult(ss,&res);
-										}
-									}
-								}
+					if((diffVal > 0.0)&&((diffVal - errBound) <= eSearch)&&((diffVal + errBound) >= eSearch)){
+						//energy matches query
+						search_result res;
+						res.relevance = 1.0f; //base value
+						res.relevance += proximityFactor;
+						res.relevance -= (float)(errBound/diffVal); //weight by size of error bars
+						res.relevance -= (float)(nuclEnt[l].energy/1000000.0); //weight by level energy (prefer lower levels)
+						res.relevance /= (1.0f + (float)fabs(0.1*(eSearch - diffVal))); //weight by distance from value
+						//SDL_Log("relevance: %f\n",(double)res.relevance);
+						if(res.relevance > 0.9f){
+							if(ss->boostedResultType != SEARCHAGENT_ELEVELDIFF){
+								//level differences match many queries by chance,
+								//so rank them below other results unless asked for
+								res.relevance *= 0.1f;
 							}
+							res.resultType = SEARCHAGENT_ELEVELDIFF;
+							res.resultVal[0] = (uint32_t)j; //nuclide index
+							res.resultVal[1] = nuclEnt[k].lvlInd; //level index
+							res.resultVal[2] = nuclEnt[l].lvlInd; //level index
+							//SDL_Log("Found level %u\n",res.resultVal[1]);
+							appendSearchResultToHeap(ss,&searchSlots[i]->res,&res);
 						}
 					}
 				}
 			}
 		}
 	}
-}
 
-void searchEGamma(const ndata *restrict ndat, const app_state *state, search_state *ss){
-	for(uint8_t i=0; i<ss->numSearchTok; i++){
+	appendTokenCacheResults(ctx,ss,heapInd,valSlots,numEVals,searchSlots,numESearch);
+}
 
-		//first, filter out any tokens with characters
-		uint8_t isNum = 1;
-		for(uint16_t j=0; j<SDL_strlen(ss->searchTok[i]); j++){
-			if(isalpha(ss->searchTok[i][j])){
-				isNum = 0;
-				break;
-			}
-		}
-		if(isNum == 0){
-			continue; //check next search token
+//returns the index of the first entry in the gamma energy index with energy >= eMin
+static uint32_t getFirstGammaIdxEntry(const ndata *restrict ndat, const double eMin){
+	uint32_t lo = 0;
+	uint32_t hi = ndat->numGammaIdx;
+	while(lo < hi){
+		uint32_t mid = lo + (hi - lo)/2;
+		if(ndat->gammaIdx[mid].energy < eMin){
+			lo = mid + 1;
+		}else{
+			hi = mid;
 		}
+	}
+	return lo;
+}
 
-		double eSearch = SDL_atof(ss->searchTok[i]);
-		if(eSearch > 0.0){
-			//valid energy
-			for(int16_t j=0; j<ndat->numNucl; j++){
+//gets the escape peak offset of a gamma index entry match (0 for the full energy peak,
+//511 or 1022 for single or double escape peaks), or -1 if there is no match, given
+//whether the full energy, single escape, and double escape energies are within the window
+static int getGammaIdxEntryMatch(const gamma_index_entry *restrict ent, const uint8_t fullMatch, const uint8_t seMatch, const uint8_t deMatch){
+	if(fullMatch){
+		return 0;
+	}else if((ent->energy > 1022.0)&&(seMatch)){
+		return 511;
+	}else if((ent->energy > 1022.0)&&(deMatch)){
+		return 1022;
+	}
+	return -1;
+}
 
-				if((ss->searchInProgress == SEARCHSTATE_SEARCHING_SINGLENUCL)&&(j!=ss->boostedNucl)){
-					//if doing a single-nuclide search, skip all other nuclides
-					continue;
-				}
+void searchEGamma(const ndata *restrict ndat, const search_context *ctx, search_state *ss){
 
-				float proximityFactor = 0.0f;
-				if(state->ds.chartZoomScale > 5.0f){
-					if(state->chartSelectedNucl != MAXNUMNUCL){
-						//offset proximity center point based on presence of nuclide info box
-						proximityFactor = SDL_sqrtf(fabsf((float)ndat->nuclData[j].Z - state->ds.chartPosY - (16.0f/state->ds.chartZoomScale)) + fabsf((float)ndat->nuclData[j].N - state->ds.chartPosX) + 0.1f);
-					}else{
-						proximityFactor = SDL_sqrtf(fabsf((float)ndat->nuclData[j].Z - state->ds.chartPosY) + fabsf((float)ndat->nuclData[j].N - state->ds.chartPosX) + 0.1f);
-					}
-					if(proximityFactor < 2.0f){
-						proximityFactor = 2.0f;
-					}
-					proximityFactor = 1.0f*state->ds.chartZoomScale/proximityFactor;
-					if(proximityFactor > 100.0f){
-						proximityFactor = 100.0f;
-					}
+	if(ss->queryPlan.numClauses > 0){
+		return; //structured queries are handled by searchQuery
+	}
+	
+	//escape peak offsets to check, in order of priority
+	const int escapeOffsets[3] = {0,511,1022};
+
+	double eVals[MAX_SEARCH_TOKENS];
+	const uint8_t numEVals = getNumericSearchVals(ss,eVals);
+
+	//only search for energies which don't have cached results
+	search_token_cache_slot *valSlots[MAX_SEARCH_TOKENS], *searchSlots[MAX_SEARCH_TOKENS];
+	double eSearch[MAX_SEARCH_TOKENS];
+	const uint8_t numESearch = getTokenCacheSlots(&ss->tokenCache[TOKENCACHE_EGAMMA],ctx,ss,0,eVals,numEVals,valSlots,eSearch,searchSlots);
+
+	double maxErrBound = (double)ndat->gammaIdxMaxErrBound;
+	double errScale = 1.0;
+	if(ss->broadSearch == 1){
+		maxErrBound = maxErrBound*5.0;
+		errScale = 5.0;
+	}
+
+	ewm_layout layout;
+	layout.stride = sizeof(gamma_index_entry);
+	layout.valOffset = offsetof(gamma_index_entry,energy);
+	layout.errOffset = offsetof(gamma_index_entry,errBound);
+	layout.errIsDouble = 0;
+	uint8_t groupStart = 0;
+	while(groupStart < numESearch){
+		const uint8_t groupLen = getSearchValGroupLen(eSearch,numESearch,groupStart,maxErrBound);
+		for(uint8_t esc=0; esc<3; esc++){
+			//look up only the transitions which could match the full energy,
+			//single escape, or double escape peak, checking energies with
+			//overlapping windows together
+			const uint32_t firstEnt = getFirstGammaIdxEntry(ndat,eSearch[groupStart] + (double)escapeOffsets[esc] - maxErrBound);
+			const uint32_t lastEnt = getFirstGammaIdxEntry(ndat,nextafter(eSearch[groupStart+groupLen-1] + (double)escapeOffsets[esc] + maxErrBound,(double)INFINITY));
+			for(uint32_t blockStart=firstEnt; blockStart<lastEnt; blockStart+=SEARCH_MATCH_BLOCK_SIZE){
+				if(isSearchCancelled(ss)){
+					return;
 				}
-				
-				for(uint32_t k=ndat->nuclData[j].firstLevel; k<(ndat->nuclData[j].firstLevel + (uint32_t)ndat->nuclData[j].numLevels); k++){
-					
-					//for single nuclide searches, if a specific reaction is selected,
-					//do not search levels that are not populated in that reaction
-					if((ss->searchInProgress == SEARCHSTATE_SEARCHING_SINGLENUCL)&&(state->ds.selectedRxn != 0)){
-						if(isLvlDisplayed(ndat,state,(uint16_t)j,(uint16_t)(k -ndat->nuclData[j].firstLevel))==0){
-							continue;
-						}
-					}
-					
-					for(uint32_t l=ndat->levels[k].firstTran; l<(ndat->levels[k].firstTran + (uint32_t)ndat->levels[k].numTran); l++){
-						if((((ndat->tran[l].energy.format >> 5U) & 15U)) != VALUETYPE_X){ //ignore variable energy
-							double rawEVal = getRawValFromDB(&ndat->tran[l].energy);
-							double rawErrVal = getRawErrFromDB(&ndat->tran[l].energy);
-							if(rawEVal > 0.0){
-								double errBound = 3.0*rawErrVal;
-								if(errBound < rawEVal*0.005){
-									errBound = rawEVal*0.005;
-								}
-								if(errBound < 3.0){
-									errBound = 3.0;
-								}
-								if(ss->broadSearch == 1){
-									errBound = errBound*5.0;
+				const uint32_t blockLen = ((lastEnt - blockStart) < SEARCH_MATCH_BLOCK_SIZE) ? (lastEnt - blockStart) : SEARCH_MATCH_BLOCK_SIZE;
+				const uint32_t numWords = EWM_NUM_MASK_WORDS(blockLen);
+				//masks for the full energy peak, and (if needed) the higher priority escape peaks
+				uint64_t masks[3][EWM_MAX_QUERIES*EWM_NUM_MASK_WORDS(SEARCH_MATCH_BLOCK_SIZE)];
+				layout.base = &ndat->gammaIdx[blockStart];
+				for(uint8_t e=0; e<=esc; e++){
+					ewm_matchBlock(&layout,blockLen,(double)escapeOffsets[e],errScale,&eSearch[groupStart],groupLen,masks[e]);
+				}
+				for(uint8_t q=0; q<groupLen; q++){
+					for(uint32_t w=0; w<numWords; w++){
+						uint64_t bits = masks[esc][q*numWords + w];
+						for(uint32_t b=0; bits!=0; b++, bits>>=1){
+							if((bits & 1U) == 0){
+								continue;
+							}
+							const gamma_index_entry *ent = &ndat->gammaIdx[blockStart + w*64U + b];
+							const uint16_t j = ent->nuclInd;
+							const uint32_t k = ent->lvlInd;
+							const uint32_t l = ent->tranInd;
+
+							if((ctx->searchInProgress == SEARCHSTATE_SEARCHING_SINGLENUCL)&&(j!=ss->boostedNucl)){
+								//if doing a single-nuclide search, skip all other nuclides
+								continue;
+							}
+
+							const uint64_t bit = (uint64_t)1 << b;
+							const uint8_t fullMatch = (masks[0][q*numWords + w] & bit) != 0;
+							const uint8_t seMatch = (esc >= 1) ? ((masks[1][q*numWords + w] & bit) != 0) : 0;
+							const uint8_t deMatch = (esc >= 2) ? ((masks[2][q*numWords + w] & bit) != 0) : 0;
+							if(getGammaIdxEntryMatch(ent,fullMatch,seMatch,deMatch) != escapeOffsets[esc]){
+								continue; //doesn't match, or matches with a different (higher priority) peak type
+							}
+
+							//for single nuclide searches, if a specific reaction is selected,
+							//do not search levels that are not populated in that reaction
+							if((ctx->searchInProgress == SEARCHSTATE_SEARCHING_SINGLENUCL)&&(ctx->selectedRxn != 0)){
+								if(isSearchLvlDisplayed(ndat,ctx,j,(uint16_t)(k -ndat->nuclData[j].firstLevel))==0){
+									continue;
 								}
-								if(((rawEVal - errBound) <= eSearch)&&((rawEVal + errBound) >= eSearch)){
-									//energy matches query
-									search_result res;
-									res.relevance = 0.5f; //base value
-									res.relevance += proximityFactor;
-									res.relevance -= (float)(rawErrVal/rawEVal); //weight by size of error bars
-									res.relevance /= (1.0f + (float)fabs(0.1*(eSearch - rawEVal))); //weight by distance from value
-									//SDL_Log("proximity factor: %f\n",(double)proximityFactor);
-									uint8_t intensityType = (uint8_t)((ndat->tran[l].energy.format >> 5U) & 15U);
-									switch(intensityType){
-										case VALUETYPE_NUMBER:
-										case VALUETYPE_GREATERTHAN:
-										case VALUETYPE_GREATEROREQUALTHAN:
-										case VALUETYPE_APPROX:
-											{//prevent -Wjump-misses-init
-												float intensityFactor = (float)getRawValFromDB(&ndat->tran[l].intensity)/100.0f;
-												if(intensityFactor > 1.0f){
-													intensityFactor = 1.0f;
-												}
-												res.relevance *= intensityFactor;
-											}
-											break;
-										default:
-											res.relevance *= 0.01f;
-											break;
-									}
-									res.resultType = SEARCHAGENT_EGAMMA;
-									res.resultVal[0] = (uint32_t)j; //nuclide index
-									res.resultVal[1] = (uint32_t)l; //transition index
-									res.resultVal[2] = (uint32_t)k; //level index
-									res.resultVal[3] = 0; //normal gamma energy result
-									//SDL_Log("Found transition %u\n",res.resultVal[1]);
-									sortAndAppendResult(ss,&res);
-								}else if((rawEVal > 1022.0)&&((((rawEVal - 511.0) - errBound) <= eSearch)&&(((rawEVal - 511.0) + errBound) >= eSearch))){
-									//energy matches query
-									search_result res;
-									res.relevance = 0.4f; //base value
-									res.relevance += proximityFactor;
-									res.relevance -= (float)(rawErrVal/rawEVal); //weight by size of error bars
-									res.relevance /= (3.0f + (float)fabs(0.1*(eSearch - (rawEVal - 511.0)))); //weight by distance from value
-									//SDL_Log("proximity factor: %f\n",(double)proximityFactor);
-									uint8_t intensityType = (uint8_t)((ndat->tran[l].energy.format >> 5U) & 15U);
-									switch(intensityType){
-										case VALUETYPE_NUMBER:
-										case VALUETYPE_GREATERTHAN:
-										case VALUETYPE_GREATEROREQUALTHAN:
-										case VALUETYPE_APPROX:
-											{//prevent -Wjump-misses-init
-												float intensityFactor = (float)getRawValFromDB(&ndat->tran[l].intensity)/100.0f;
-												if(intensityFactor > 1.0f){
-													intensityFactor = 1.0f;
-												}
-												res.relevance *= intensityFactor;
-											}
-											break;
-										default:
-											res.relevance *= 0.01f;
-											break;
-									}
-									res.resultType = SEARCHAGENT_EGAMMA;
-									res.resultVal[0] = (uint32_t)j; //nuclide index
-									res.resultVal[1] = (uint32_t)l; //transition index
-									res.resultVal[2] = (uint32_t)k; //level index
-									res.resultVal[3] = 511; //flag as a single escape peak
-									//SDL_Log("Found transition %u\n",res.resultVal[1]);
-									sortAndAppendResult(ss,&res);
-								}else if((rawEVal > 1022.0)&&((((rawEVal - 1022.0) - errBound) <= eSearch)&&(((rawEVal - 1022.0) + errBound) >= eSearch))){
-									//energy matches query
-									search_result res;
-									res.relevance = 0.4f; //base value
-									res.relevance += proximityFactor;
-									res.relevance -= (float)(rawErrVal/rawEVal); //weight by size of error bars
-									res.relevance /= (4.0f + (float)fabs(0.1*(eSearch - (rawEVal - 1022.0)))); //weight by distance from value
-									//SDL_Log("proximity factor: %f\n",(double)proximityFactor);
-									uint8_t intensityType = (uint8_t)((ndat->tran[l].energy.format >> 5U) & 15U);
-									switch(intensityType){
-										case VALUETYPE_NUMBER:
-										case VALUETYPE_GREATERTHAN:
-										case VALUETYPE_GREATEROREQUALTHAN:
-										case VALUETYPE_APPROX:
-											{//prevent -Wjump-misses-init
-												float intensityFactor = (float)getRawValFromDB(&ndat->tran[l].intensity)/100.0f;
-												if(intensityFactor > 1.0f){
-													intensityFactor = 1.0f;
-												}
-												res.relevance *= intensityFactor;
-											}
-											break;
-										default:
-											res.relevance *= 0.01f;
-											break;
+							}
+
+							//energy matches query
+							const double eQuery = eSearch[groupStart+q];
+							const double rawEVal = ent->energy;
+							const double rawErrVal = getRawErrFromDB(&ndat->tran[l].energy);
+							search_result res;
+							res.relevance = 0.5f; //base value
+							if(escapeOffsets[esc] != 0){
+								res.relevance = 0.4f; //base value (escape peaks)
+							}
+							res.relevance += getProximityFactor(ndat,ctx,j);
+							res.relevance -= (float)(rawErrVal/rawEVal); //weight by size of error bars
+							if(escapeOffsets[esc] == 0){
+								res.relevance /= (1.0f + (float)fabs(0.1*(eQuery - rawEVal))); //weight by distance from value
+							}else if(escapeOffsets[esc] == 511){
+								res.relevance /= (3.0f + (float)fabs(0.1*(eQuery - (rawEVal - 511.0)))); //weight by distance from value
+							}else{
+								res.relevance /= (4.0f + (float)fabs(0.1*(eQuery - (rawEVal - 1022.0)))); //weight by distance from value
+							}
+							uint8_t intensityType = (uint8_t)((ndat->tran[l].energy.format >> 5U) & 15U);
+							switch(intensityType){
+								case VALUETYPE_NUMBER:
+								case VALUETYPE_GREATERTHAN:
+								case VALUETYPE_GREATEROREQUALTHAN:
+								case VALUETYPE_APPROX:
+									{//prevent -Wjump-misses-init
+										float intensityFactor = (float)getRawValFromDB(&ndat->tran[l].intensity)/100.0f;
+										if(intensityFactor > 1.0f){
+											intensityFactor = 1.0f;
+										}
+										res.relevance *= intensityFactor;
 									}
-									res.resultType = SEARCHAGENT_EGAMMA;
-									res.resultVal[0] = (uint32_t)j; //nuclide index
-									res.resultVal[1] = (uint32_t)l; //transition index
-									res.resultVal[2] = (uint32_t)k; //level index
-									res.resultVal[3] = 1022; //flag as a double escape peak
-									//SDL_Log("Found transition %u\n",res.resultVal[1]);
-									sortAndAppendResult(ss,&res);
-								}
+									break;
+								default:
+									res.relevance *= 0.01f;
+									break;
 							}
+							res.resultType = SEARCHAGENT_EGAMMA;
+							res.resultVal[0] = (uint32_t)j; //nuclide index
+							res.resultVal[1] = l; //transition index
+							res.resultVal[2] = k; //level index
+							res.resultVal[3] = (uint32_t)escapeOffsets[esc]; //0 for normal gamma energy result, 511 or 1022 for single or double escape peak
+							//SDL_Log("Found transition %u\n",res.resultVal[1]);
+							appendSearchResultToHeap(ss,&searchSlots[groupStart+q]->res,&res);
 						}
 					}
 				}
 			}
 		}
+		groupStart = (uint8_t)(groupStart + groupLen);
+	}
+
+	appendTokenCacheResults(ctx,ss,SEARCHAGENT_EGAMMA,valSlots,numEVals,searchSlots,numESearch);
+}
+
+//flags all levels in the nuclide being searched which are fed (directly or via
+//intermediate levels) by the specified level, ie. which are below it in a cascade
+//lvl: level index relative to the first level of the nuclide
+static void setCascadeCoincLvls(const ndata *restrict ndat, cascade_search_data *restrict cd, const uint32_t lvl){
+	const uint32_t firstLevel = ndat->nuclData[cd->nuclInd].firstLevel;
+	SDL_memset(cd->coincLvls,0,sizeof(uint64_t)*((lvl/64)+1));
+	cd->coincLvls[lvl/64] |= (uint64_t)((uint64_t)(1) << (lvl%64));
+	for(uint32_t m=lvl+1; m>0; m--){
+		const uint32_t l = m-1;
+		if(cd->coincLvls[l/64] & (uint64_t)((uint64_t)(1) << (l%64))){
+			for(uint32_t t=ndat->levels[firstLevel+l].firstTran; t<(ndat->levels[firstLevel+l].firstTran + (uint32_t)ndat->levels[firstLevel+l].numTran); t++){
+				const uint16_t offset = ndat->tran[t].finalLvlOffset;
+				if((offset > 0)&&(offset <= l)){ //offset of 0 means the final level is unknown
+					cd->coincLvls[(l-offset)/64] |= (uint64_t)((uint64_t)(1) << ((l-offset)%64));
+				}
+			}
+		}
+	}
+}
+
+//recursively builds cascades downward from the transitions already chosen,
+//using candidate transitions for the query gammas not yet matched, and
+//keeps the highest relevance cascade matching all query gammas
+static void extendCascade(const ndata *restrict ndat, cascade_search_data *restrict cd, const uint8_t depth, const uint32_t usedGammas){
+	
+	cd->numNodesVisited++;
+
+	if(depth >= cd->numGammas){
+		//full cascade identified
+		double intensityFactor = 0.0;
+		double energyFactor = 1.0;
+		uint8_t numGaps = 0;
+		for(uint8_t d=0; d<depth; d++){
+			const cascade_candidate *cand = &cd->cand[cd->chainCand[d]];
+			intensityFactor += getRawValFromDB(&ndat->tran[cand->tranInd].intensity);
+			energyFactor *= (1.0 + fabs(0.1*(cd->gammaE[cand->gamma] - getRawValFromDB(&ndat->tran[cand->tranInd].energy))));
+			if(d > 0){
+				if(cand->initialLvl != cd->cand[cd->chainCand[d-1]].finalLvl){
+					numGaps++; //cascade members are coincident but not consecutive
+				}
+			}
+		}
+		float relevance = 1.0f; //base value
+		relevance += (float)intensityFactor/100.0f; //weight by intensity of gammas (and implicitly by multiplicity of cascade)
+		relevance /= (float)(energyFactor); //weight by distance of energies from search values
+		relevance /= (1.0f + 0.5f*(float)numGaps); //prefer cascades where the gammas directly feed each other
+		if(relevance > cd->bestRelevance){
+			cd->bestRelevance = relevance;
+			for(uint8_t d=0; d<depth; d++){
+				cd->bestTran[d] = cd->cand[cd->chainCand[d]].tranInd;
+			}
+		}
+		return;
+	}
+
+	if(cd->numNodesVisited > MAX_CASCADE_SEARCH_NODES){
+		return; //pathological case, give up on finding a better cascade
+	}
+
+	//continue with the candidates for the remaining query gammas that lie below the last transition
+	const uint64_t *reach = &cd->reach[(size_t)cd->chainCand[depth-1]*cd->reachWords];
+	for(uint32_t c=0; c<cd->numCand; c++){
+		if((reach[c/64] & (uint64_t)((uint64_t)(1) << (c%64)))&&(!(usedGammas & (uint32_t)(1U << cd->cand[c].gamma)))){
+			cd->chainCand[depth] = c;
+			extendCascade(ndat,cd,(uint8_t)(depth+1),(uint32_t)(usedGammas | (uint32_t)(1U << cd->cand[c].gamma)));
+		}
+	}
+}
+
+static int SDLCALL compareCascadeCandidates(const void *a, const void *b){
+	cascade_candidate *candA = ((cascade_candidate*)(intptr_t)(a)); //get the candidate (double cast to avoid warning)
+	cascade_candidate *candB = ((cascade_candidate*)(intptr_t)(b)); //get the candidate (double cast to avoid warning)
+	if(candA->nuclInd != candB->nuclInd){
+		return (candA->nuclInd < candB->nuclInd) ? -1 : 1;
+	}else if(candA->gamma != candB->gamma){
+		return (candA->gamma < candB->gamma) ? -1 : 1;
+	}else if(candA->tranInd != candB->tranInd){
+		return (candA->tranInd < candB->tranInd) ? -1 : 1;
+	}
+	return 0;
+}
+
+//sets up the bit-pattern for each candidate transition in a nuclide of the candidates which lie
+//below it in a cascade, so that the level scheme is only walked once per distinct final level,
+//rather than at every step of the cascade search
+//returns 0 if the bit-patterns couldn't be allocated
+static uint8_t setCascadeReach(const ndata *restrict ndat, cascade_search_data *restrict cd, cascade_search_buffers *restrict buf){
+	cd->reachWords = (cd->numCand + 63)/64;
+	const size_t reachSize = (size_t)cd->numCand*cd->reachWords;
+	if(reachSize > buf->reachSize){
+		uint64_t *reach = (uint64_t*)SDL_realloc(buf->reach,reachSize*sizeof(uint64_t));
+		if(reach == NULL){
+			return 0;
+		}
+		buf->reach = reach;
+		buf->reachSize = reachSize;
+	}
+	SDL_memset(buf->reach,0,reachSize*sizeof(uint64_t));
+	uint32_t coincLvl = MAX_UINT32_VAL; //level that cd->coincLvls is currently set up for
+	for(uint32_t c=0; c<cd->numCand; c++){
+		const uint32_t finalLvl = cd->cand[c].finalLvl;
+		if(finalLvl == cd->cand[c].initialLvl){
+			continue; //final level unknown, can't continue the cascade
+		}
+		if(finalLvl != coincLvl){
+			setCascadeCoincLvls(ndat,cd,finalLvl);
+			coincLvl = finalLvl;
+		}
+		uint64_t *reach = &buf->reach[(size_t)c*cd->reachWords];
+		for(uint32_t d=0; d<cd->numCand; d++){
+			const uint32_t initialLvl = cd->cand[d].initialLvl;
+			if((initialLvl <= finalLvl)&&(cd->coincLvls[initialLvl/64] & (uint64_t)((uint64_t)(1) << (initialLvl%64)))){
+				reach[d/64] |= (uint64_t)((uint64_t)(1) << (d%64));
+			}
+		}
 	}
+	cd->reach = buf->reach;
+	return 1;
 }
 
-void searchGammaCascade(const ndata *restrict ndat, const app_state *state, search_state *ss){
+//searches for gamma cascades, only the nuclides in one chunk of the data (ss->chunk, each
+//nuclide belongs to the chunk containing its first level) are searched, so that the search
+//can be split across multiple threads
+void searchGammaCascade(const ndata *restrict ndat, const search_context *ctx, search_state *ss, const uint8_t chunkInd){
+
+	if(ss->queryPlan.numClauses > 0){
+		return; //structured queries are handled by searchQuery
+	}
+
+	if(chunkInd >= NUM_SEARCH_CHUNKS){
+		SDL_Log("ERROR: searchGammaCascade - invalid chunk index (%u).\n",chunkInd);
+		return;
+	}
+
+	//each chunk runs on its own thread, with its own results
+	const uint8_t heapInd = getSearchResultHeapInd(SEARCHAGENT_GAMMACASCADE,chunkInd);
+	const uint16_t firstNucl = (uint16_t)(ss->chunk[chunkInd].firstNucl + ((ss->chunk[chunkInd].firstEnt > 0) ? 1 : 0));
+	const uint16_t lastNucl = (uint16_t)(ss->chunk[chunkInd+1].firstNucl + ((ss->chunk[chunkInd+1].firstEnt > 0) ? 1 : 0));
+	cascade_search_buffers *buf = &ss->cascadeBuf[chunkInd];
 	
-	uint8_t numCascadeGammas = 0;
-	double cascadeGammas[MAX_CASCADE_GAMMAS];
-	uint32_t matchedTran[MAX_CASCADE_GAMMAS];
+	cascade_search_data cd;
+	cd.numGammas = 0;
 
 	for(uint8_t i=0; i<ss->numSearchTok; i++){
 
@@ -505,10 +1280,10 @@ void searchGammaCascade(const ndata *restrict ndat, const app_state *state, sear
 		if(isNum == 0){
 			continue; //check next search token
 		}else{
-			cascadeGammas[numCascadeGammas] = SDL_atof(ss->searchTok[i]);
-			if(cascadeGammas[numCascadeGammas] > 0.0){
-				numCascadeGammas++;
-				if(numCascadeGammas >= MAX_CASCADE_GAMMAS){
+			cd.gammaE[cd.numGammas] = SDL_atof(ss->searchTok[i]);
+			if(cd.gammaE[cd.numGammas] > 0.0){
+				cd.numGammas++;
+				if(cd.numGammas >= MAX_CASCADE_GAMMAS){
 					break; //array is full
 				}
 			}
@@ -516,150 +1291,292 @@ void searchGammaCascade(const ndata *restrict ndat, const app_state *state, sear
 
 	}
 
-	if(numCascadeGammas > 1){
-		//search for nuclides containing all of the cascade's gammas in coincidenc
-		for(int16_t i=0; i<ndat->numNucl; i++){
+	if(cd.numGammas > 1){
+		//search for nuclides containing all of the cascade's gammas in coincidence
+		const double errScale = (ss->broadSearch == 1) ? 5.0 : 1.0;
+		const double maxErrBound = (double)ndat->gammaIdxMaxErrBound*errScale;
 
-			if((ss->searchInProgress == SEARCHSTATE_SEARCHING_SINGLENUCL)&&(i!=ss->boostedNucl)){
-				//if doing a single-nuclide search, skip all other nuclides
-				continue;
+		//use the gamma energy index to find nuclides which have transitions
+		//matching every query gamma
+		uint64_t candNucl[(MAXNUMNUCL+63)/64];
+		uint64_t gammaNucl[(MAXNUMNUCL+63)/64];
+		SDL_memset(candNucl,0xFF,sizeof(candNucl));
+		for(uint8_t g=0; g<cd.numGammas; g++){
+			SDL_memset(gammaNucl,0,sizeof(gammaNucl));
+			for(uint32_t m=getFirstGammaIdxEntry(ndat,cd.gammaE[g] - maxErrBound); m<ndat->numGammaIdx; m++){
+				const gamma_index_entry *ent = &ndat->gammaIdx[m];
+				if(ent->energy > (cd.gammaE[g] + maxErrBound)){
+					break; //past the end of the window
+				}
+				if(fabs(ent->energy - cd.gammaE[g]) <= (double)ent->errBound*errScale){
+					gammaNucl[ent->nuclInd/64] |= (uint64_t)((uint64_t)(1) << (ent->nuclInd%64));
+				}
+			}
+			for(uint16_t w=0; w<((MAXNUMNUCL+63)/64); w++){
+				candNucl[w] &= gammaNucl[w];
+			}
+		}
+
+		//get the matching transitions in those of the nuclides which are in this chunk
+		uint32_t numCand = 0;
+		for(uint8_t g=0; g<cd.numGammas; g++){
+			for(uint32_t m=getFirstGammaIdxEntry(ndat,cd.gammaE[g] - maxErrBound); m<ndat->numGammaIdx; m++){
+				const gamma_index_entry *ent = &ndat->gammaIdx[m];
+				if(ent->energy > (cd.gammaE[g] + maxErrBound)){
+					break; //past the end of the window
+				}
+				const uint16_t i = ent->nuclInd;
+				if((i < firstNucl)||(i >= lastNucl)||(!(candNucl[i/64] & (uint64_t)((uint64_t)(1) << (i%64))))){
+					continue;
+				}
+				if((ctx->searchInProgress == SEARCHSTATE_SEARCHING_SINGLENUCL)&&(i!=ss->boostedNucl)){
+					//if doing a single-nuclide search, skip all other nuclides
+					continue;
+				}
+				if(fabs(ent->energy - cd.gammaE[g]) > (double)ent->errBound*errScale){
+					continue;
+				}
+				if(numCand >= buf->candSize){
+					const uint32_t candSize = (buf->candSize > 0) ? 2*buf->candSize : 256;
+					cascade_candidate *cand = (cascade_candidate*)SDL_realloc(buf->cand,candSize*sizeof(cascade_candidate));
+					if(cand == NULL){
+						SDL_Log("ERROR: searchGammaCascade - couldn't allocate memory.\n");
+						return;
+					}
+					buf->cand = cand;
+					buf->candSize = candSize;
+				}
+				cascade_candidate *cand = &buf->cand[numCand];
+				const uint32_t lvl = ent->lvlInd - ndat->nuclData[i].firstLevel;
+				cand->tranInd = ent->tranInd;
+				cand->initialLvl = lvl;
+				if(ndat->tran[ent->tranInd].finalLvlOffset <= lvl){
+					cand->finalLvl = lvl - ndat->tran[ent->tranInd].finalLvlOffset;
+				}else{
+					cand->finalLvl = lvl; //invalid final level, treat as unknown
+				}
+				cand->nuclInd = i;
+				cand->gamma = g;
+				numCand++;
+			}
+		}
+		SDL_qsort(buf->cand,numCand,sizeof(cascade_candidate),compareCascadeCandidates);
+
+		for(uint32_t nuclStart=0; nuclStart<numCand; nuclStart+=cd.numCand){
+
+			if(isSearchCancelled(ss)){
+				return;
+			}
+
+			//candidates in this nuclide
+			const uint16_t i = buf->cand[nuclStart].nuclInd;
+			cd.nuclInd = i;
+			cd.cand = &buf->cand[nuclStart];
+			cd.numCand = 0;
+			while(((nuclStart + cd.numCand) < numCand)&&(cd.cand[cd.numCand].nuclInd == i)){
+				cd.numCand++;
+			}
+			if(setCascadeReach(ndat,&cd,buf) == 0){
+				SDL_Log("ERROR: searchGammaCascade - couldn't allocate memory.\n");
+				return;
 			}
 
-			if(ndat->nuclData[i].numLevels > 1){
+			float proximityFactor = getProximityFactor(ndat,ctx,i);
 
-				float proximityFactor = 0.0f;
-				if(state->ds.chartZoomScale > 5.0f){
-					if(state->chartSelectedNucl != MAXNUMNUCL){
-						//offset proximity center point based on presence of nuclide info box
-						proximityFactor = SDL_sqrtf(fabsf((float)ndat->nuclData[i].Z - state->ds.chartPosY - (16.0f/state->ds.chartZoomScale)) + fabsf((float)ndat->nuclData[i].N - state->ds.chartPosX) + 0.1f);
-					}else{
-						proximityFactor = SDL_sqrtf(fabsf((float)ndat->nuclData[i].Z - state->ds.chartPosY) + fabsf((float)ndat->nuclData[i].N - state->ds.chartPosX) + 0.1f);
+			//find the best cascade starting from each candidate transition
+			for(uint32_t c=0; c<cd.numCand; c++){
+
+				//for single nuclide searches, if a specific reaction is selected,
+				//do not search levels that are not populated in that reaction
+				if((ctx->searchInProgress == SEARCHSTATE_SEARCHING_SINGLENUCL)&&(ctx->selectedRxn != 0)){
+					if(isSearchLvlDisplayed(ndat,ctx,i,(uint16_t)(cd.cand[c].initialLvl))==0){
+						continue;
 					}
-					if(proximityFactor < 2.0f){
-						proximityFactor = 2.0f;
+				}
+
+				cd.bestRelevance = 0.0f;
+				cd.numNodesVisited = 0;
+				cd.chainCand[0] = c;
+				extendCascade(ndat,&cd,1,(uint32_t)(1U << cd.cand[c].gamma));
+
+				if(cd.bestRelevance > 0.0f){
+					search_result res;
+					res.relevance = cd.bestRelevance;
+					res.relevance += proximityFactor;
+					res.resultType = SEARCHAGENT_GAMMACASCADE;
+					res.resultVal[0] = (uint32_t)i; //nuclide index
+					for(uint8_t ind=0; ind<cd.numGammas; ind++){
+						res.resultVal[ind+1] = cd.bestTran[ind]; //transition indices, from the top of the cascade down
 					}
-					proximityFactor = 1.0f*state->ds.chartZoomScale/proximityFactor;
-					if(proximityFactor > 100.0f){
-						proximityFactor = 100.0f;
+					if((cd.numGammas+1) < SEARCH_RESULT_DATASIZE){
+						res.resultVal[cd.numGammas+1] = UNUSED_SEARCH_RESULT; //truncate results
 					}
+					//SDL_Log("Found cascade in nuclide %u starting with transition %u\n",res.resultVal[0],res.resultVal[1]);
+					appendSearchResult(ss,heapInd,&res);
 				}
-				
-				for(uint32_t j=(ndat->nuclData[i].firstLevel + (uint32_t)(ndat->nuclData[i].numLevels - 1)); j>=ndat->nuclData[i].firstLevel; j--){
-					if(j==0){
-						break; //safety valve
-					}
-					
-					//for single nuclide searches, if a specific reaction is selected,
-					//do not search levels that are not populated in that reaction
-					if((ss->searchInProgress == SEARCHSTATE_SEARCHING_SINGLENUCL)&&(state->ds.selectedRxn != 0)){
-						if(isLvlDisplayed(ndat,state,(uint16_t)i,(uint16_t)(j -ndat->nuclData[i].firstLevel))==0){
+			}
+		}
+
+		//SDL_Log("Gamma cascade search finished.\n");
+	}
+
+}
+
+//returns the half-life unit (values from value_unit_enum) corresponding to a
+//search token, or VALUE_UNIT_NOVAL if the token isn't a unit of time
+static uint8_t getTimeUnitFromStr(const char *str){
+	if((SDL_strcmp(str,"us")==0)||(SDL_strcmp(str,"µs")==0)){
+		return VALUE_UNIT_MICROSECONDS;
+	}else if(SDL_strcmp(str,"min")==0){
+		return VALUE_UNIT_MINUTES;
+	}
+	for(uint8_t i=VALUE_UNIT_YEARS; i<=VALUE_UNIT_ATTOSECONDS; i++){
+		if(SDL_strcmp(str,getValueUnitShortStr(i))==0){
+			return i;
+		}
+	}
+	return VALUE_UNIT_NOVAL;
+}
+
+//returns the index of the first sorted entry in the half-life index with half-life >= hlMin (in seconds)
+static uint32_t getFirstHlIdxEntry(const ndata *restrict ndat, const double hlMin){
+	uint32_t lo = 0;
+	uint32_t hi = ndat->numHlIdxSorted;
+	while(lo < hi){
+		uint32_t mid = lo + (hi - lo)/2;
+		if(ndat->hlIdx[mid].hlSeconds < hlMin){
+			lo = mid + 1;
+		}else{
+			hi = mid;
+		}
+	}
+	return lo;
+}
+
+//appends a half-life index entry which matches a query value (in the units
+//that the entry is quoted in) to a heap of results
+static void appendHlIdxResult(const ndata *restrict ndat, const search_context *ctx, search_state *ss, search_result_heap *heap, const halflife_index_entry *restrict ent, const double hlSearch){
+	const uint16_t j = ent->nuclInd;
+	const uint32_t k = ent->lvlInd;
+
+	if((ctx->searchInProgress == SEARCHSTATE_SEARCHING_SINGLENUCL)&&(j!=ss->boostedNucl)){
+		//if doing a single-nuclide search, skip all other nuclides
+		return;
+	}
+
+	//for single nuclide searches, if a specific reaction is selected,
+	//do not search levels that are not populated in that reaction
+	if((ctx->searchInProgress == SEARCHSTATE_SEARCHING_SINGLENUCL)&&(ctx->selectedRxn != 0)){
+		if(isSearchLvlDisplayed(ndat,ctx,j,(uint16_t)(k -ndat->nuclData[j].firstLevel))==0){
+			return;
+		}
+	}
+
+	//half-life matches query
+	const double rawHlVal = ent->hlVal;
+	const double rawErrVal = getRawErrFromDB(&ndat->levels[k].halfLife);
+	search_result res;
+	//set base value differently for different types of states
+	if(k != (ndat->nuclData[j].firstLevel + ndat->nuclData[j].gsLevel)){
+		//de-prioritize short lived excited states
+		if(ent->hlSeconds<1.0E-6){
+			res.relevance = 0.07f; 
+		}else{
+			res.relevance = 0.7f; 
+		}
+	}else{
+		res.relevance = 0.7f;
+	}
+	res.relevance += getProximityFactor(ndat,ctx,j);
+	res.relevance -= (float)(rawErrVal/rawHlVal); //weight by size of error bars
+	res.relevance /= (1.0f + (float)fabs(0.1*(hlSearch - rawHlVal))); //weight by distance from value
+	res.resultType = SEARCHAGENT_HALFLIFE;
+	res.resultVal[0] = (uint32_t)j; //nuclide index
+	res.resultVal[1] = k; //level index
+	//SDL_Log("Found level %u\n",res.resultVal[1]);
+	appendSearchResultToHeap(ss,heap,&res);
+}
+
+//checks a single half-life index entry against a query value (in the units
+//that the entry is quoted in), and appends it to the results if it matches
+static void checkHlIdxEntry(const ndata *restrict ndat, const search_context *ctx, search_state *ss, search_result_heap *heap, const halflife_index_entry *restrict ent, const double hlSearch){
+	double errBound = ent->errBound;
+	if(ss->broadSearch == 1){
+		errBound = errBound*5.0;
+	}
+	if(((ent->hlVal - errBound) <= hlSearch)&&((ent->hlVal + errBound) >= hlSearch)){
+		appendHlIdxResult(ndat,ctx,ss,heap,ent,hlSearch);
+	}
+}
+
+//checks the half-life index entries [firstEnt,lastEnt) against several query values at once
+//(compared against the quoted value of each half-life), using the energy window kernel, and
+//appends the matches to the results for each value (hlSlots), only entries quoted in the
+//specified unit are checked (any unit if VALUE_UNIT_NOVAL)
+static void checkHlIdxEntries(const ndata *restrict ndat, const search_context *ctx, search_state *ss, const uint32_t firstEnt, const uint32_t lastEnt, const double *hlSearch, search_token_cache_slot *hlSlots[], const uint8_t numHlSearch, const uint8_t unit){
+	ewm_layout layout;
+	layout.stride = sizeof(halflife_index_entry);
+	layout.valOffset = offsetof(halflife_index_entry,hlVal);
+	layout.errOffset = offsetof(halflife_index_entry,errBound);
+	layout.errIsDouble = 1;
+	const double errScale = (ss->broadSearch == 1) ? 5.0 : 1.0;
+	for(uint8_t groupStart=0; groupStart<numHlSearch; groupStart=(uint8_t)(groupStart + EWM_MAX_QUERIES)){
+		const uint8_t groupLen = ((numHlSearch - groupStart) < EWM_MAX_QUERIES) ? (uint8_t)(numHlSearch - groupStart) : EWM_MAX_QUERIES;
+		for(uint32_t blockStart=firstEnt; blockStart<lastEnt; blockStart+=SEARCH_MATCH_BLOCK_SIZE){
+			if(isSearchCancelled(ss)){
+				return;
+			}
+			const uint32_t blockLen = ((lastEnt - blockStart) < SEARCH_MATCH_BLOCK_SIZE) ? (lastEnt - blockStart) : SEARCH_MATCH_BLOCK_SIZE;
+			const uint32_t numWords = EWM_NUM_MASK_WORDS(blockLen);
+			uint64_t masks[EWM_MAX_QUERIES*EWM_NUM_MASK_WORDS(SEARCH_MATCH_BLOCK_SIZE)];
+			layout.base = &ndat->hlIdx[blockStart];
+			ewm_matchBlock(&layout,blockLen,0.0,errScale,&hlSearch[groupStart],groupLen,masks);
+			for(uint8_t q=0; q<groupLen; q++){
+				for(uint32_t w=0; w<numWords; w++){
+					uint64_t bits = masks[q*numWords + w];
+					for(uint32_t b=0; bits!=0; b++, bits>>=1){
+						if((bits & 1U) == 0){
 							continue;
 						}
-					}
-					
-					for(uint32_t k=ndat->levels[j].firstTran; k<(ndat->levels[j].firstTran + (uint32_t)ndat->levels[j].numTran); k++){
-						if((((ndat->tran[k].energy.format >> 5U) & 15U)) != VALUETYPE_X){ //ignore variable energy
-							double rawEVal = getRawValFromDB(&ndat->tran[k].energy);
-							double rawErrVal = getRawErrFromDB(&ndat->tran[k].energy);
-							if(rawEVal > 0.0){
-								double errBound = 3.0*rawErrVal;
-								if(errBound < rawEVal*0.005){
-									errBound = rawEVal*0.005;
-								}
-								if(ss->broadSearch == 1){
-									errBound = errBound*5.0;
-								}
-								
-								for(uint8_t l=0; l<numCascadeGammas; l++){
-									if(((rawEVal - errBound) <= cascadeGammas[l])&&((rawEVal + errBound) >= cascadeGammas[l])){
-										//energy matches query
-										matchedTran[0] = k;
-										uint8_t numGammasMatched = 1;
-										uint8_t gammasMatched = 0; //bit-pattern of matched gammas
-										gammasMatched |= (uint8_t)(1U << l);
-										double intensityFactor = getRawValFromDB(&ndat->tran[k].intensity);
-										double energyFactor = (1.0 + fabs(0.1*(cascadeGammas[l] - rawEVal)));
-										double rawLvlE = getRawValFromDB(&ndat->levels[j].energy) - rawEVal;
-										//search the lower levels for other cascade members
-										for(uint32_t m=(uint32_t)(j-1); m>=ndat->nuclData[i].firstLevel; m--){
-											if(numGammasMatched < numCascadeGammas){
-												if(SDL_fabs(getRawValFromDB(&ndat->levels[m].energy) - rawLvlE) < errBound){
-													uint8_t nextCascMemberFound = 0;
-													for(uint32_t n=ndat->levels[m].firstTran; n<(ndat->levels[m].firstTran + (uint32_t)ndat->levels[m].numTran); n++){
-														if((((ndat->tran[n].energy.format >> 5U) & 15U)) != VALUETYPE_X){ //ignore variable energy
-															rawEVal = getRawValFromDB(&ndat->tran[n].energy);
-															rawErrVal = getRawErrFromDB(&ndat->tran[n].energy);
-															if(rawEVal > 0.0){
-																errBound = 3.0*rawErrVal;
-																if(errBound < 5.0){
-																	errBound = 5.0;
-																}
-															}
-															
-															for(uint8_t p=0; p<numCascadeGammas; p++){
-																if(!(gammasMatched & (1U << p))){
-																	//matches energy of cascade member not previously found
-																	if(((rawEVal - errBound) <= cascadeGammas[p])&&((rawEVal + errBound) >= cascadeGammas[p])){
-																		//energy matches query
-																		nextCascMemberFound = 1;
-																		matchedTran[numGammasMatched] = n;
-																		numGammasMatched++;
-																		gammasMatched |= (uint8_t)(1U << p);
-																		intensityFactor += getRawValFromDB(&ndat->tran[n].intensity);
-																		energyFactor *= (1.0 + fabs(0.1*(cascadeGammas[p] - rawEVal)));
-																		rawLvlE = getRawValFromDB(&ndat->levels[m].energy) - rawEVal;
-																		break;
-																	}
-																}
-															}
-														}
-														if(nextCascMemberFound){
-															break;
-														}
-													}
-												}
-											}
-										}
-										if(numGammasMatched == numCascadeGammas){
-											//full cascade identified
-											search_result res;
-											res.relevance = 1.0f; //base value
-											res.relevance += (float)intensityFactor/100.0f; //weight by intensity of gammas (and implicitly by multiplicity of cascade)
-											res.relevance /= (float)(energyFactor); //weight by distance of energies from search values
-											res.relevance += proximityFactor;
-											res.resultType = SEARCHAGENT_GAMMACASCADE;
-											res.resultVal[0] = (uint32_t)i; //nuclide index
-											for(uint8_t ind=1; ind<=numGammasMatched; ind++){
-												if((ind < SEARCH_RESULT_DATASIZE)&&(ind <= MAX_CASCADE_GAMMAS)){
-													res.resultVal[ind] = matchedTran[ind-1]; //transition index (first cascade member)
-												}
-											}
-											if((numGammasMatched+1) < SEARCH_RESULT_DATASIZE){
-												res.resultVal[numGammasMatched+1] = UNUSED_SEARCH_RESULT; //truncate results
-											}
-											//SDL_Log("Found cascade in nuclide %u starting with transition %u\n",res.resultVal[0],res.resultVal[1]);
-											sortAndAppendResult(ss,&res);
-										}
-									}
-								}
-
-							}
+						const halflife_index_entry *ent = &ndat->hlIdx[blockStart + w*64U + b];
+						if((unit == VALUE_UNIT_NOVAL)||(ent->unit == unit)){
+							appendHlIdxResult(ndat,ctx,ss,&hlSlots[groupStart+q]->res,ent,hlSearch[groupStart+q]);
 						}
 					}
 				}
 			}
-			
 		}
-
-		//SDL_Log("Gamma cascade search finished.\n");
 	}
+}
 
+//converts a query half-life in seconds to the units of an index entry,
+//returns 0.0 if the entry isn't quoted in units of time or width
+static double getHlSearchValInUnit(const double hlSearchSeconds, const uint8_t unit){
+	if(unit == VALUE_UNIT_STABLE){
+		return 0.0;
+	}
+	double unitSeconds = getHalfLifeSecondsFromVal(1.0,unit);
+	if(unitSeconds <= 0.0){
+		return 0.0;
+	}
+	if((unit == VALUE_UNIT_EV)||(unit == VALUE_UNIT_KEV)||(unit == VALUE_UNIT_MEV)){
+		return unitSeconds/hlSearchSeconds; //width is inversely proportional to half-life
+	}
+	return hlSearchSeconds/unitSeconds;
 }
 
-void searchHalfLife(const ndata *restrict ndat, const app_state *state, search_state *ss){
+void searchHalfLife(const ndata *restrict ndat, const search_context *ctx, search_state *ss){
+
+	if(ss->queryPlan.numClauses > 0){
+		return; //structured queries are handled by searchQuery
+	}
+
+	double hlUnitlessVals[MAX_SEARCH_TOKENS];
+	uint8_t numUnitlessHlVals = 0;
 	for(uint8_t i=0; i<ss->numSearchTok; i++){
 
-		//first, filter out any tokens with characters
+		//first, check for tokens with characters, which are only
+		//accepted if they are a number directly followed by a time unit (eg. '10ms')
 		uint8_t isNum = 1;
 		for(uint16_t j=0; j<SDL_strlen(ss->searchTok[i]); j++){
 			if(isalpha(ss->searchTok[i][j])){
@@ -667,143 +1584,1810 @@ void searchHalfLife(const ndata *restrict ndat, const app_state *state, search_s
 				break;
 			}
 		}
+		double hlSearch;
+		uint8_t hlUnit = VALUE_UNIT_NOVAL;
 		if(isNum == 0){
-			continue; //check next search token
+			char *unitStr;
+			hlSearch = SDL_strtod(ss->searchTok[i],&unitStr);
+			if(unitStr == ss->searchTok[i]){
+				continue; //check next search token
+			}
+			hlUnit = getTimeUnitFromStr(unitStr);
+			if(hlUnit == VALUE_UNIT_NOVAL){
+				continue; //check next search token
+			}
+		}else{
+			hlSearch = SDL_atof(ss->searchTok[i]);
+			if((i+1) < ss->numSearchTok){
+				//number may be followed by a separate unit token (eg. '10 ms')
+				hlUnit = getTimeUnitFromStr(ss->searchTok[i+1]);
+			}
 		}
-
-		double hlSearch = SDL_atof(ss->searchTok[i]);
+		
 		if(hlSearch > 0.0){
-			//valid energy
-			if(state->ds.useLifetimes){
+			//valid half-life
+			if(ctx->useLifetimes){
 				hlSearch /= 1.4427; //convert lifetime to half-life
 			}
-			for(int16_t j=0; j<ndat->numNucl; j++){
-
-				if((ss->searchInProgress == SEARCHSTATE_SEARCHING_SINGLENUCL)&&(j!=ss->boostedNucl)){
-					//if doing a single-nuclide search, skip all other nuclides
-					continue;
-				}
-
-				float proximityFactor = 0.0f;
-				if(state->ds.chartZoomScale > 5.0f){
-					if(state->chartSelectedNucl != MAXNUMNUCL){
-						//offset proximity center point based on presence of nuclide info box
-						proximityFactor = SDL_sqrtf(fabsf((float)ndat->nuclData[j].Z - state->ds.chartPosY - (16.0f/state->ds.chartZoomScale)) + fabsf((float)ndat->nuclData[j].N - state->ds.chartPosX) + 0.1f);
-					}else{
-						proximityFactor = SDL_sqrtf(fabsf((float)ndat->nuclData[j].Z - state->ds.chartPosY) + fabsf((float)ndat->nuclData[j].N - state->ds.chartPosX) + 0.1f);
-					}
-					if(proximityFactor < 2.0f){
-						proximityFactor = 2.0f;
-					}
-					proximityFactor = 1.0f*state->ds.chartZoomScale/proximityFactor;
-					if(proximityFactor > 100.0f){
-						proximityFactor = 100.0f;
+			if(hlUnit != VALUE_UNIT_NOVAL){
+				//query with units, compare against half-lives in any units
+				const double hlSearchSeconds = getHalfLifeSecondsFromVal(hlSearch,hlUnit);
+				uint32_t firstEnt = 0;
+				uint32_t lastEnt = ndat->numHlIdx;
+				if(ss->broadSearch == 0){
+					//sorted entries matching the query must lie within a factor of
+					//2 of it (see HLIDX_MAX_REL_ERRBOUND), rounding margin added
+					const double hlMax = 2.0000001*hlSearchSeconds;
+					for(uint32_t m=getFirstHlIdxEntry(ndat,hlSearchSeconds/2.0000001); m<ndat->numHlIdxSorted; m++){
+						if(((m % SEARCH_CANCEL_CHECK_INTERVAL) == 0)&&(isSearchCancelled(ss))){
+							return;
+						}
+						if(ndat->hlIdx[m].hlSeconds > hlMax){
+							break; //past the end of the window
+						}
+						checkHlIdxEntry(ndat,ctx,ss,&ss->threadResults[SEARCHAGENT_HALFLIFE].heap,&ndat->hlIdx[m],getHlSearchValInUnit(hlSearchSeconds,ndat->hlIdx[m].unit));
 					}
+					firstEnt = ndat->numHlIdxSorted; //only unsorted entries remain to be checked
 				}
-				
-				//SDL_Log("proximityFactor: %f\n",(double)proximityFactor);
-				for(uint32_t k=ndat->nuclData[j].firstLevel; k<(ndat->nuclData[j].firstLevel + (uint32_t)ndat->nuclData[j].numLevels); k++){
-					
-					//for single nuclide searches, if a specific reaction is selected,
-					//do not search levels that are not populated in that reaction
-					if((ss->searchInProgress == SEARCHSTATE_SEARCHING_SINGLENUCL)&&(state->ds.selectedRxn != 0)){
-						if(isLvlDisplayed(ndat,state,(uint16_t)j,(uint16_t)(k -ndat->nuclData[j].firstLevel))==0){
-							continue;
-						}
+				for(uint32_t m=firstEnt; m<lastEnt; m++){
+					if(((m % SEARCH_CANCEL_CHECK_INTERVAL) == 0)&&(isSearchCancelled(ss))){
+						return;
 					}
-					
-					uint8_t hlValueType = (uint8_t)((ndat->levels[k].halfLife.format >> 5U) & 15U);
-					if((hlValueType == VALUETYPE_NUMBER)||(hlValueType == VALUETYPE_ASYMERROR)){
-						double rawHlVal = getRawValFromDB(&ndat->levels[k].halfLife);
-						if(rawHlVal > 0.0){
-							double rawErrVal = getRawErrFromDB(&ndat->levels[k].halfLife);
-							double errBound = 3.0*rawErrVal;
-							if(errBound < rawHlVal*0.005){
-								errBound = rawHlVal*0.005;
-							}
-							if(ss->broadSearch == 1){
-								errBound = errBound*5.0;
-							}
-							if(((rawHlVal - errBound) <= hlSearch)&&((rawHlVal + errBound) >= hlSearch)){
-								//energy matches query
-								search_result res;
-								//set base value differently for different types of states
-								if(k != (ndat->nuclData[j].firstLevel + ndat->nuclData[j].gsLevel)){
-									//de-prioritize short lived excited states
-									if(getLevelHalfLifeSeconds(ndat,k)<1.0E-6){
-										res.relevance = 0.07f; 
-									}else{
-										res.relevance = 0.7f; 
-									}
-								}else{
-									res.relevance = 0.7f;
-								}
-								res.relevance += proximityFactor;
-								res.relevance -= (float)(rawErrVal/rawHlVal); //weight by size of error bars
-								res.relevance /= (1.0f + (float)fabs(0.1*(hlSearch - rawHlVal))); //weight by distance from value
-								res.resultType = SEARCHAGENT_HALFLIFE;
-								res.resultVal[0] = (uint32_t)j; //nuclide index
-								res.resultVal[1] = (uint32_t)k; //level index
-								//SDL_Log("Found transition %u\n",res.resultVal[1]);
-								sortAndAppendResult(ss,&res);
-							}
-						}
+					double hlSearchInUnit = getHlSearchValInUnit(hlSearchSeconds,ndat->hlIdx[m].unit);
+					if(hlSearchInUnit > 0.0){
+						checkHlIdxEntry(ndat,ctx,ss,&ss->threadResults[SEARCHAGENT_HALFLIFE].heap,&ndat->hlIdx[m],hlSearchInUnit);
 					}
 				}
+			}else if(numUnitlessHlVals < MAX_SEARCH_TOKENS){
+				//unitless query, checked below along with any others
+				hlUnitlessVals[numUnitlessHlVals] = hlSearch;
+				numUnitlessHlVals++;
 			}
 		}
 	}
-}
 
-void searchNuclides(const ndata *restrict ndat, search_state *restrict ss){
-	char nuclAStr[8], nuclElemName[32];
-	for(uint8_t i=0; i<ss->numSearchTok; i++){
-		uint8_t foundNucl = 0;
-		uint8_t len = (uint8_t)SDL_strlen(ss->searchTok[i]);
-		if(isdigit(ss->searchTok[i][0])){
-			//look for nuclide names starting with a digit (eg. 32Si)
-			for(uint8_t j=1; j<len; j++){
-				if(j>=7){
-					break;
+	//unitless queries, compare against the quoted value of each half-life
+	//(only searching for values which don't have cached results)
+	search_token_cache_slot *valSlots[MAX_SEARCH_TOKENS], *hlSlots[MAX_SEARCH_TOKENS];
+	double hlUnitlessSearch[MAX_SEARCH_TOKENS];
+	const uint8_t numUnitlessHlSearch = getTokenCacheSlots(&ss->tokenCache[TOKENCACHE_HALFLIFE],ctx,ss,0,hlUnitlessVals,numUnitlessHlVals,valSlots,hlUnitlessSearch,hlSlots);
+	if(numUnitlessHlSearch == 0){
+		//nothing to search for
+	}else if(ss->broadSearch == 0){
+		for(uint8_t i=0; i<numUnitlessHlSearch; i++){
+			//for each unit, look up the window in seconds where sorted entries quoted
+			//in that unit could match (within a factor of 2, see HLIDX_MAX_REL_ERRBOUND)
+			for(uint8_t u=VALUE_UNIT_YEARS; u<=VALUE_UNIT_MEV; u++){
+				double hlLim1 = getHalfLifeSecondsFromVal(hlUnitlessSearch[i]/2.0000001,u);
+				double hlLim2 = getHalfLifeSecondsFromVal(hlUnitlessSearch[i]*2.0000001,u);
+				if((hlLim1 <= 0.0)||(hlLim2 <= 0.0)){
+					continue; //not a unit of time or width
 				}
-				if(ss->searchTok[i][j] == '-'){
-					memcpy(&nuclAStr,&ss->searchTok[i],(size_t)j);
-					nuclAStr[j] = '\0'; //terminate string at end
-					if((len > (j+1))&&((len-j+1)<32)){
-						memcpy(&nuclElemName,&(ss->searchTok[i][j+1]),(size_t)(len-j+1));
-						nuclElemName[len-j+1] = '\0'; //terminate string at end
-						foundNucl = 1;
-						break;
-					}
-				}else if(!(isdigit(ss->searchTok[i][j]))){
-					memcpy(&nuclAStr,&ss->searchTok[i],(size_t)j);
-					nuclAStr[j] = '\0'; //terminate string at end
-					if((len > j)&&((len-j)<32)){
-						memcpy(&nuclElemName,&(ss->searchTok[i][j]),(size_t)(len-j));
-						nuclElemName[len-j] = '\0'; //terminate string at end
-						foundNucl = 1;
-						break;
-					}
+				double hlMin = (hlLim1 < hlLim2) ? hlLim1 : hlLim2; //width units are inverted
+				double hlMax = (hlLim1 < hlLim2) ? hlLim2 : hlLim1;
+				const uint32_t firstEnt = getFirstHlIdxEntry(ndat,hlMin);
+				uint32_t lastEnt = firstEnt;
+				while((lastEnt < ndat->numHlIdxSorted)&&(ndat->hlIdx[lastEnt].hlSeconds <= hlMax)){
+					lastEnt++; //find the end of the window
 				}
+				checkHlIdxEntries(ndat,ctx,ss,firstEnt,lastEnt,&hlUnitlessSearch[i],&hlSlots[i],1,u);
 			}
-			if(foundNucl == 0){
-				//try looking at the full string, for special cases
-				SDL_strlcpy(nuclElemName,ss->searchTok[i],31);
-				SDL_strlcpy(nuclAStr,"-1",7); //mark special case
-				//SDL_Log("Parsing special case: %s\n",ss->searchTok[i]);
+		}
+		//check unsorted entries
+		checkHlIdxEntries(ndat,ctx,ss,ndat->numHlIdxSorted,ndat->numHlIdx,hlUnitlessSearch,hlSlots,numUnitlessHlSearch,VALUE_UNIT_NOVAL);
+	}else{
+		//broad search error bounds are too wide for the windowed lookup
+		checkHlIdxEntries(ndat,ctx,ss,0,ndat->numHlIdx,hlUnitlessSearch,hlSlots,numUnitlessHlSearch,VALUE_UNIT_NOVAL);
+	}
+
+	appendTokenCacheResults(ctx,ss,SEARCHAGENT_HALFLIFE,valSlots,numUnitlessHlVals,hlSlots,numUnitlessHlSearch);
+}
+
+//adds a result to a local list of the best results found by a search agent,
+//replacing the lowest relevance result if the list is full
+//(allows agents to refine their best candidates before appending them to their results)
+//results should already be boosted (see boostSearchResult), so that boosted results aren't
+//dropped in favour of results which would end up less relevant
+static void addTopResult(search_result topRes[MAX_SEARCH_RESULTS], uint8_t *numTopRes, const search_result *res){
+	if(*numTopRes < MAX_SEARCH_RESULTS){
+		memcpy(&topRes[*numTopRes],res,sizeof(search_result));
+		(*numTopRes)++;
+	}else{
+		uint8_t minInd = 0;
+		for(uint8_t i=1; i<*numTopRes; i++){
+			if(topRes[i].relevance < topRes[minInd].relevance){
+				minInd = i;
 			}
-		}else if(isalpha(ss->searchTok[i][0])){
-			//look for nuclide names starting with a letter (eg. si32)
-			for(uint8_t j=1; j<len; j++){
-				if(j>=32){
-					break;
-				}
-				if(ss->searchTok[i][j] == '-'){
-					memcpy(&nuclElemName,&ss->searchTok[i],(size_t)j);
-					nuclElemName[j] = '\0'; //terminate string at end
-					if((len > (j+1))&&((len-j+1)<8)){
-						memcpy(&nuclAStr,&(ss->searchTok[i][j+1]),(size_t)(len-j+1));
-						nuclAStr[len-j+1] = '\0'; //terminate string at end
+		}
+		if(res->relevance > topRes[minInd].relevance){
+			memcpy(&topRes[minInd],res,sizeof(search_result));
+		}
+	}
+}
+
+//finds the range [first,last) of words in the comment text index which are
+//equal to a word (or start with it, if prefix is set)
+static uint32_t getCommentIdxTermRange(const ndata *restrict ndat, const char *word, const uint8_t prefix, uint32_t *last){
+	const size_t wordLen = SDL_strlen(word);
+	uint32_t lo = 0;
+	uint32_t hi = ndat->numCommentIdxTerms;
+	while(lo < hi){
+		const uint32_t mid = lo + (hi - lo)/2;
+		if(SDL_strcmp(&ndat->commentIdxTermBuf[ndat->commentIdxTerms[mid].strPos],word) < 0){
+			lo = mid + 1;
+		}else{
+			hi = mid;
+		}
+	}
+	*last = lo;
+	while(*last < ndat->numCommentIdxTerms){
+		const char *term = &ndat->commentIdxTermBuf[ndat->commentIdxTerms[*last].strPos];
+		if(prefix){
+			if(SDL_strncmp(term,word,wordLen)!=0){
+				break;
+			}
+		}else if(SDL_strcmp(term,word)!=0){
+			break;
+		}
+		(*last)++;
+	}
+	return lo;
+}
+
+//decodes the postings list of a word in the comment text index, returns the
+//number of comments written to docsOut
+static uint32_t decodeCommentIdxPostings(const ndata *restrict ndat, const uint32_t termInd, uint32_t *docsOut){
+	uint32_t pos = ndat->commentIdxTerms[termInd].postingsPos;
+	uint32_t doc = 0;
+	for(uint32_t i=0; i<ndat->commentIdxTerms[termInd].numDocs; i++){
+		uint32_t delta = 0;
+		uint8_t shift = 0;
+		while(ndat->commentIdxPostings[pos] & 128U){
+			delta |= (uint32_t)(ndat->commentIdxPostings[pos] & 127U) << shift;
+			shift = (uint8_t)(shift + 7);
+			pos++;
+		}
+		delta |= (uint32_t)(ndat->commentIdxPostings[pos]) << shift;
+		pos++;
+		doc += delta;
+		docsOut[i] = doc;
+	}
+	return ndat->commentIdxTerms[termInd].numDocs;
+}
+
+//finds the position in a comment where a sequence of words appears
+//(the last word may be incomplete if lastIsPrefix is set)
+//returns MAX_UINT32_VAL if the sequence isn't found
+static uint32_t findCommentPhrase(const char *str, const uint32_t strInd, char words[MAX_SEARCH_TOKENS][COMMENT_IDX_MAX_WORD_LEN], const uint8_t numWords, const uint8_t lastIsPrefix){
+	char word[COMMENT_IDX_MAX_WORD_LEN];
+	uint32_t phraseStart;
+	uint32_t pos = getNextCommentWord(str,strInd,word,&phraseStart);
+	while(pos > 0){
+		uint32_t wordPos = pos;
+		uint32_t wordStart = phraseStart;
+		uint8_t numMatched = 0;
+		while(numMatched < numWords){
+			uint8_t match;
+			if((lastIsPrefix)&&(numMatched == (numWords-1))){
+				match = (SDL_strncmp(word,words[numMatched],SDL_strlen(words[numMatched]))==0);
+			}else{
+				match = (SDL_strcmp(word,words[numMatched])==0);
+			}
+			if(!match){
+				break;
+			}
+			numMatched++;
+			if(numMatched < numWords){
+				wordPos = getNextCommentWord(str,wordPos,word,&wordStart);
+				if(wordPos == 0){
+					break;
+				}
+			}
+		}
+		if(numMatched == numWords){
+			return phraseStart;
+		}
+		pos = getNextCommentWord(str,pos,word,&phraseStart);
+	}
+	return MAX_UINT32_VAL;
+}
+
+//full-text search of level and transition ENSDF comments (eg. 'superdeformed',
+//'g-factor', 'Coulomb excitation'), comments containing all of the words in
+//the query are found using the comment text index, and those containing the
+//words as a phrase are ranked highest
+void searchComments(const ndata *restrict ndat, const search_context *ctx, search_state *ss){
+
+	if(ss->queryPlan.numClauses > 0){
+		return; //structured queries are handled by searchQuery
+	}
+
+	if(ndat->numCommentIdxTerms == 0){
+		return;
+	}
+
+	//get words from the query, skipping tokens with numbers in them (nuclide
+	//names, energies, half-lives), which are handled by the other search agents
+	char words[MAX_SEARCH_TOKENS][COMMENT_IDX_MAX_WORD_LEN];
+	uint8_t numWords = 0;
+	uint16_t numLetters = 0;
+	uint8_t lastIsPrefix = 0;
+	for(uint8_t i=0; i<ss->numSearchTok; i++){
+		uint8_t hasDigit = 0;
+		for(uint8_t j=0; ss->searchTok[i][j]!='\0'; j++){
+			if(isdigit(ss->searchTok[i][j])){
+				hasDigit = 1;
+				break;
+			}
+		}
+		lastIsPrefix = 0;
+		if(hasDigit){
+			continue;
+		}
+		if(numWords >= MAX_SEARCH_TOKENS){
+			break; //no room for more words
+		}
+		uint32_t wordStart;
+		uint32_t pos = getNextCommentWord(ss->searchTok[i],0,words[numWords],&wordStart);
+		while((pos > 0)&&(numWords < MAX_SEARCH_TOKENS)){
+			numLetters = (uint16_t)(numLetters + SDL_strlen(words[numWords]));
+			numWords++;
+			lastIsPrefix = 1;
+			if(numWords < MAX_SEARCH_TOKENS){
+				pos = getNextCommentWord(ss->searchTok[i],pos,words[numWords],&wordStart);
+			}
+		}
+	}
+	if((numWords == 0)||(numLetters < 4)){
+		return; //too short to search comments without flooding the results
+	}
+	//the last word is treated as incomplete (still being typed) unless it is
+	//short or followed by a space
+	const size_t searchStrLen = SDL_strlen(ctx->searchString);
+	if((SDL_strlen(words[numWords-1]) < 3)||(searchStrLen == 0)||(!isalnum(ctx->searchString[searchStrLen-1]))){
+		lastIsPrefix = 0;
+	}
+
+	//look up words
+	uint32_t firstTerm[MAX_SEARCH_TOKENS], lastTerm[MAX_SEARCH_TOKENS];
+	uint32_t rarestTerm = MAX_UINT32_VAL;
+	for(uint8_t i=0; i<numWords; i++){
+		const uint8_t prefix = (uint8_t)((lastIsPrefix)&&(i == (numWords-1)));
+		firstTerm[i] = getCommentIdxTermRange(ndat,words[i],prefix,&lastTerm[i]);
+		if(firstTerm[i] >= lastTerm[i]){
+			return; //word doesn't appear in any comment
+		}
+		if((lastTerm[i] - firstTerm[i]) == 1){
+			if((rarestTerm == MAX_UINT32_VAL)||(ndat->commentIdxTerms[firstTerm[i]].numDocs < ndat->commentIdxTerms[rarestTerm].numDocs)){
+				rarestTerm = firstTerm[i];
+			}
+		}
+	}
+
+	//candidate comments (the buffers are kept between searches, since the comment text index doesn't change)
+	if(ss->commentCand == NULL){
+		ss->commentCand = (uint32_t*)SDL_malloc((ndat->numCommentIdxDocs+1)*sizeof(uint32_t));
+		ss->commentTermDocs = (uint32_t*)SDL_malloc((ndat->numCommentIdxDocs+1)*sizeof(uint32_t));
+		ss->commentPrefixDocs = (uint8_t*)SDL_malloc((ndat->numCommentIdxDocs+1)*sizeof(uint8_t));
+		if((ss->commentCand == NULL)||(ss->commentTermDocs == NULL)||(ss->commentPrefixDocs == NULL)){
+			SDL_Log("ERROR: searchComments - couldn't allocate memory.\n");
+			SDL_free(ss->commentCand);
+			SDL_free(ss->commentTermDocs);
+			SDL_free(ss->commentPrefixDocs);
+			ss->commentCand = NULL;
+			return;
+		}
+	}
+	uint32_t *cand = ss->commentCand;
+	uint32_t *termDocs = ss->commentTermDocs;
+	uint8_t *prefixDocs = ss->commentPrefixDocs;
+	uint32_t numCand = 0;
+	const uint8_t prefixWord = (uint8_t)(numWords-1);
+	const uint8_t usePrefixDocs = (uint8_t)((lastTerm[prefixWord] - firstTerm[prefixWord]) > 1);
+	if(usePrefixDocs){
+		//comments containing any of the words starting with the incomplete word
+		SDL_memset(prefixDocs,0,ndat->numCommentIdxDocs*sizeof(uint8_t));
+		for(uint32_t i=firstTerm[prefixWord]; i<lastTerm[prefixWord]; i++){
+			const uint32_t numDocs = decodeCommentIdxPostings(ndat,i,termDocs);
+			for(uint32_t j=0; j<numDocs; j++){
+				prefixDocs[termDocs[j]] = 1;
+			}
+		}
+	}
+	if(rarestTerm != MAX_UINT32_VAL){
+		numCand = decodeCommentIdxPostings(ndat,rarestTerm,cand);
+	}else{
+		for(uint32_t i=0; i<ndat->numCommentIdxDocs; i++){
+			if(prefixDocs[i]){
+				cand[numCand] = i;
+				numCand++;
+			}
+		}
+	}
+	//intersect with the comments containing the other words
+	for(uint8_t i=0; i<numWords; i++){
+		if((lastTerm[i] - firstTerm[i]) != 1){
+			continue; //incomplete word, handled below
+		}
+		if(firstTerm[i] == rarestTerm){
+			continue;
+		}
+		const uint32_t numDocs = decodeCommentIdxPostings(ndat,firstTerm[i],termDocs);
+		uint32_t numKept = 0;
+		uint32_t k = 0;
+		for(uint32_t j=0; j<numCand; j++){
+			while((k < numDocs)&&(termDocs[k] < cand[j])){
+				k++;
+			}
+			if((k < numDocs)&&(termDocs[k] == cand[j])){
+				cand[numKept] = cand[j];
+				numKept++;
+			}
+		}
+		numCand = numKept;
+	}
+	if((usePrefixDocs)&&(rarestTerm != MAX_UINT32_VAL)){
+		uint32_t numKept = 0;
+		for(uint32_t j=0; j<numCand; j++){
+			if(prefixDocs[cand[j]]){
+				cand[numKept] = cand[j];
+				numKept++;
+			}
+		}
+		numCand = numKept;
+	}
+
+	//rank candidates, keeping only the best results
+	search_result topRes[MAX_SEARCH_RESULTS];
+	uint8_t numTopRes = 0;
+	for(uint32_t i=0; i<numCand; i++){
+		if(((i % SEARCH_CANCEL_CHECK_INTERVAL) == 0)&&(isSearchCancelled(ss))){
+			break; //results won't be used
+		}
+		const comment_index_doc *doc = &ndat->commentIdxDocs[cand[i]];
+		if((ctx->searchInProgress == SEARCHSTATE_SEARCHING_SINGLENUCL)&&(doc->nuclInd!=ss->boostedNucl)){
+			//if doing a single-nuclide search, skip all other nuclides
+			continue;
+		}
+		if((ctx->searchInProgress == SEARCHSTATE_SEARCHING_SINGLENUCL)&&(ctx->selectedRxn != 0)){
+			if(isSearchLvlDisplayed(ndat,ctx,doc->nuclInd,(uint16_t)(doc->lvlInd - ndat->nuclData[doc->nuclInd].firstLevel))==0){
+				continue;
+			}
+		}
+		const uint32_t strInd = getCommentIdxDocStrInd(ndat,cand[i]);
+		if(strInd == MAX_UINT32_VAL){
+			continue;
+		}
+		search_result res;
+		res.relevance = 0.3f; //base value
+		uint32_t matchPos = strInd; //for single words, found after ranking (every candidate contains the word)
+		if(numWords > 1){
+			matchPos = findCommentPhrase(ndat->ensdfStrBuf,strInd,words,numWords,lastIsPrefix);
+			if(matchPos != MAX_UINT32_VAL){
+				res.relevance += 0.3f; //words appear together, as in the query
+			}else{
+				matchPos = findCommentPhrase(ndat->ensdfStrBuf,strInd,words,1,0);
+				if(matchPos == MAX_UINT32_VAL){
+					matchPos = strInd;
+				}
+			}
+		}else{
+			res.relevance += 0.3f;
+		}
+		res.relevance += getProximityFactor(ndat,ctx,doc->nuclInd);
+		res.resultType = SEARCHAGENT_COMMENT;
+		res.resultVal[0] = doc->nuclInd; //nuclide index
+		res.resultVal[1] = doc->lvlInd; //level index
+		res.resultVal[2] = doc->tranInd; //transition index (MAX_UINT32_VAL for level comments)
+		res.resultVal[3] = matchPos; //position of the matching text in ensdfStrBuf
+		boostSearchResult(ss,&res);
+		addTopResult(topRes,&numTopRes,&res);
+	}
+
+	for(uint8_t i=0; i<numTopRes; i++){
+		if(numWords == 1){
+			const uint32_t matchPos = findCommentPhrase(ndat->ensdfStrBuf,topRes[i].resultVal[3],words,1,lastIsPrefix);
+			if(matchPos != MAX_UINT32_VAL){
+				topRes[i].resultVal[3] = matchPos;
+			}
+		}
+		insertSearchResult(&ss->threadResults[SEARCHAGENT_COMMENT].heap,&topRes[i]); //relevance was already boosted
+	}
+}
+
+//finds the range [first,last) of reaction types in the reaction catalogue which
+//are equal to a key (or start with it, if prefix is set)
+static uint16_t getRxnCatalogueTypeRange(const ndata *restrict ndat, const char *key, const uint8_t prefix, uint16_t *last){
+	const size_t keyLen = SDL_strlen(key);
+	uint16_t lo = 0;
+	uint16_t hi = ndat->numRxnCatalogueTypes;
+	while(lo < hi){
+		const uint16_t mid = (uint16_t)(lo + (hi - lo)/2);
+		if(SDL_strcmp(ndat->rxnCatalogueTypes[mid].key,key) < 0){
+			lo = (uint16_t)(mid + 1);
+		}else{
+			hi = mid;
+		}
+	}
+	*last = lo;
+	while(*last < ndat->numRxnCatalogueTypes){
+		const char *typeKey = ndat->rxnCatalogueTypes[*last].key;
+		if(prefix){
+			if(SDL_strncmp(typeKey,key,keyLen)!=0){
+				break;
+			}
+		}else if(SDL_strcmp(typeKey,key)!=0){
+			break;
+		}
+		(*last)++;
+	}
+	return lo;
+}
+
+//adds results for all nuclides populated by a reaction type in the reaction catalogue
+static void checkRxnCatalogueType(const ndata *restrict ndat, const search_context *ctx, search_state *ss, const uint16_t typeInd, const char *target, search_result topRes[MAX_SEARCH_RESULTS], uint8_t *numTopRes){
+	if(isSearchCancelled(ss)){
+		return;
+	}
+	const rxn_catalogue_type *type = &ndat->rxnCatalogueTypes[typeInd];
+	char key[RXN_CATALOGUE_KEY_LEN], rxnTarget[RXN_CATALOGUE_TARGET_LEN];
+	for(uint32_t i=type->firstEntry; i<(type->firstEntry + type->numEntries); i++){
+		const rxn_catalogue_entry *ent = &ndat->rxnCatalogueEntries[i];
+		if((ctx->searchInProgress == SEARCHSTATE_SEARCHING_SINGLENUCL)&&(ent->nuclInd!=ss->boostedNucl)){
+			//if doing a single-nuclide search, skip all other nuclides
+			continue;
+		}
+		const uint32_t rxnInd = ndat->nuclData[ent->nuclInd].firstRxn + (uint32_t)ent->rxnLocalInd;
+		if(target[0] != '\0'){
+			//only keep reactions on the requested target (or decays of the requested parent)
+			getRxnCatalogueKey(key,rxnTarget,&ndat->ensdfStrBuf[ndat->rxn[rxnInd].rxnStrBufStartPos]);
+			if(SDL_strcmp(rxnTarget,target)!=0){
+				continue;
+			}
+		}
+		//reactions populating more of the level scheme are more relevant
+		uint16_t numPopulated = 0;
+		const uint32_t firstLevel = ndat->nuclData[ent->nuclInd].firstLevel;
+		for(uint32_t j=firstLevel; j<(firstLevel + ndat->nuclData[ent->nuclInd].numLevels); j++){
+			if(ndat->levels[j].populatingRxns & ((uint64_t)(1) << ent->rxnLocalInd)){
+				numPopulated++;
+			}
+		}
+		if(numPopulated == 0){
+			continue;
+		}
+		search_result res;
+		res.relevance = 0.3f + 0.3f*((float)numPopulated/(float)ndat->nuclData[ent->nuclInd].numLevels);
+		if(target[0] != '\0'){
+			res.relevance += 0.3f;
+		}
+		res.relevance += getProximityFactor(ndat,ctx,ent->nuclInd);
+		res.resultType = SEARCHAGENT_REACTION;
+		res.resultVal[0] = ent->nuclInd; //nuclide index
+		res.resultVal[1] = ent->rxnLocalInd; //reaction index within the nuclide
+		boostSearchResult(ss,&res);
+		addTopResult(topRes,numTopRes,&res);
+	}
+}
+
+//searches the reaction catalogue for a reaction in the search string
+//(eg. '(p,g)', 'p,γ', '26Mg(p,g)', 'β- decay', '152Eu b- decay', 'Coulomb excitation')
+void searchReactions(const ndata *restrict ndat, const search_context *ctx, search_state *ss){
+
+	if(ndat->numRxnCatalogueTypes == 0){
+		return;
+	}
+
+	//commas separate search tokens, so reactions are read from the full search string
+	char query[SEARCH_STRING_MAX_SIZE];
+	SDL_strlcpy(query,ctx->searchString,SEARCH_STRING_MAX_SIZE);
+	const char *commaPos = SDL_strchr(ctx->searchString,',');
+	if((commaPos != NULL)&&(SDL_strchr(ctx->searchString,'(') == NULL)){
+		//add the brackets around a projectile and ejectile typed without them (eg. 'p,g')
+		size_t start = (size_t)(commaPos - ctx->searchString);
+		while((start > 0)&&(ctx->searchString[start-1] != ' ')){
+			start--;
+		}
+		size_t end = (size_t)(commaPos - ctx->searchString);
+		while((ctx->searchString[end] != '\0')&&(ctx->searchString[end] != ' ')){
+			end++;
+		}
+		if((end + 3) < SEARCH_STRING_MAX_SIZE){
+			SDL_snprintf(query,SEARCH_STRING_MAX_SIZE,"%.*s(%.*s)%s",(int)start,ctx->searchString,(int)(end-start),&ctx->searchString[start],&ctx->searchString[end]);
+		}
+	}
+
+	char key[RXN_CATALOGUE_KEY_LEN], target[RXN_CATALOGUE_TARGET_LEN];
+	const uint8_t keyLen = getRxnCatalogueKey(key,target,query);
+	if(keyLen == 0){
+		return;
+	}
+
+	search_result topRes[MAX_SEARCH_RESULTS];
+	uint8_t numTopRes = 0;
+	uint16_t firstType, lastType;
+	if(key[0] == '('){
+		//projectile and ejectile
+		firstType = getRxnCatalogueTypeRange(ndat,key,0,&lastType);
+		for(uint16_t i=firstType; i<lastType; i++){
+			checkRxnCatalogueType(ndat,ctx,ss,i,target,topRes,&numTopRes);
+		}
+	}else if((keyLen >= 6)&&(SDL_strcmp(&key[keyLen-5],"decay")==0)){
+		//decay, if the sign isn't specified (eg. 'beta decay') check both signs
+		firstType = getRxnCatalogueTypeRange(ndat,key,0,&lastType);
+		for(uint16_t i=firstType; i<lastType; i++){
+			checkRxnCatalogueType(ndat,ctx,ss,i,target,topRes,&numTopRes);
+		}
+		if((key[keyLen-6] != '-')&&(key[keyLen-6] != '+')&&(keyLen < (RXN_CATALOGUE_KEY_LEN-1))){
+			char signedKey[RXN_CATALOGUE_KEY_LEN];
+			for(uint8_t j=0; j<2; j++){
+				SDL_snprintf(signedKey,RXN_CATALOGUE_KEY_LEN,"%.*s%cdecay",(int)(keyLen-5),key,(j==0) ? '-' : '+');
+				firstType = getRxnCatalogueTypeRange(ndat,signedKey,0,&lastType);
+				for(uint16_t i=firstType; i<lastType; i++){
+					checkRxnCatalogueType(ndat,ctx,ss,i,target,topRes,&numTopRes);
+				}
+			}
+		}
+	}else{
+		//named reaction (eg. 'Coulomb excitation'), may be incomplete
+		if(keyLen < 5){
+			return; //too short to tell apart from other search terms
+		}
+		for(uint8_t i=0; i<keyLen; i++){
+			if(!SDL_isalpha((unsigned char)key[i])){
+				return; //names of reactions contain only letters
+			}
+		}
+		firstType = getRxnCatalogueTypeRange(ndat,key,1,&lastType);
+		for(uint16_t i=firstType; i<lastType; i++){
+			const char *typeKey = ndat->rxnCatalogueTypes[i].key;
+			if((typeKey[0] == '(')||(SDL_strstr(typeKey,"decay")!=NULL)){
+				continue;
+			}
+			checkRxnCatalogueType(ndat,ctx,ss,i,target,topRes,&numTopRes);
+		}
+	}
+
+	for(uint8_t i=0; i<numTopRes; i++){
+		insertSearchResult(&ss->threadResults[SEARCHAGENT_REACTION].heap,&topRes[i]); //relevance was already boosted
+	}
+}
+
+//parses a spin-parity search token (eg. '9/2+', '0+', '(3/2)-', '9/2'), which
+//must contain a parity or a half-integer spin to be told apart from energies
+//returns 1 if the token is a spin-parity value, 0 otherwise
+static uint8_t getSpinParFromStr(const char *str, uint16_t *twoJ, int8_t *par){
+	uint8_t pos = 0;
+	if((str[pos] == '(')||(str[pos] == '[')){
+		pos++; //tentative or assumed value
+	}
+	uint16_t spinVal = 0;
+	uint8_t numDigits = 0;
+	while(isdigit((unsigned char)str[pos])){
+		spinVal = (uint16_t)(spinVal*10U + (uint16_t)(str[pos] - '0'));
+		numDigits++;
+		pos++;
+	}
+	if((numDigits == 0)||(numDigits > 3)){
+		return 0;
+	}
+	uint8_t halfInt = 0;
+	if((str[pos] == '/')&&(str[pos+1] == '2')){
+		if((spinVal % 2U) == 0){
+			return 0; //not a half-integer
+		}
+		halfInt = 1;
+		pos = (uint8_t)(pos + 2);
+	}
+	if((str[pos] == ')')||(str[pos] == ']')){
+		pos++;
+	}
+	*par = 0;
+	if(str[pos] == '+'){
+		*par = 1;
+		pos++;
+	}else if(str[pos] == '-'){
+		*par = -1;
+		pos++;
+	}
+	if((str[pos] == ')')||(str[pos] == ']')){
+		pos++;
+	}
+	if((str[pos] != '\0')||((halfInt == 0)&&(*par == 0))){
+		return 0;
+	}
+	*twoJ = halfInt ? spinVal : (uint16_t)(2U*spinVal);
+	return 1;
+}
+
+//parses a spin bound (eg. '20', '21/2', '10.5'), returns 1 if successful
+static uint8_t getSpinBoundFromStr(const char *str, uint16_t *twoJ){
+	char *endStr;
+	double spin = SDL_strtod(str,&endStr);
+	if((endStr == str)||(spin < 0.0)){
+		return 0;
+	}
+	if(SDL_strcmp(endStr,"/2")==0){
+		spin /= 2.0;
+	}else if(*endStr != '\0'){
+		return 0;
+	}
+	const double twoJVal = SDL_floor(2.0*spin + 0.5);
+	*twoJ = (twoJVal > SPIDX_MAX_TWOJ) ? SPIDX_MAX_TWOJ : (uint16_t)twoJVal;
+	return 1;
+}
+
+//searches for levels by spin-parity (eg. '9/2+', '0+ isomer', 'high-spin > 20',
+//'J>=10 1ms'), optionally constrained by level energy and half-life
+void searchSpinParity(const ndata *restrict ndat, const search_context *ctx, search_state *ss){
+
+	if(ss->queryPlan.numClauses > 0){
+		return; //structured queries are handled by searchQuery
+	}
+
+	if(ndat->numSpIdx == 0){
+		return;
+	}
+
+	//parse the query
+	uint16_t jpTwoJ[MAX_SEARCH_TOKENS];
+	int8_t jpPar[MAX_SEARCH_TOKENS];
+	uint8_t numJp = 0;
+	uint16_t minTwoJ = 0;
+	uint16_t maxTwoJ = SPIDX_MAX_TWOJ;
+	uint8_t hasSpinBound = 0;
+	uint8_t isomerOnly = 0;
+	double eSearch = 0.0;
+	double hlSearchSeconds = 0.0;
+	static const char *const spinKeywords[4] = {"high-spin","highspin","spin","j"};
+	for(uint8_t i=0; i<ss->numSearchTok; i++){
+		const char *tok = ss->searchTok[i];
+		if(getSpinParFromStr(tok,&jpTwoJ[numJp],&jpPar[numJp])){
+			numJp++;
+			continue;
+		}
+		if((SDL_strcasecmp(tok,"isomer")==0)||(SDL_strcasecmp(tok,"isomers")==0)){
+			isomerOnly = 1;
+			continue;
+		}
+		//spin bounds, the keyword, comparison and value may be separate tokens
+		uint8_t isSpinKeyword = 0;
+		for(uint8_t j=0; j<4; j++){
+			const size_t kwLen = SDL_strlen(spinKeywords[j]);
+			if(SDL_strncasecmp(tok,spinKeywords[j],kwLen)==0){
+				const char *cmpStr = &tok[kwLen];
+				if((*cmpStr == '\0')&&((i+1) < ss->numSearchTok)){
+					const char nextChar = ss->searchTok[i+1][0];
+					if((nextChar == '>')||(nextChar == '<')||(nextChar == '=')){
+						i++;
+						cmpStr = ss->searchTok[i];
+					}
+				}
+				if((*cmpStr != '>')&&(*cmpStr != '<')&&(*cmpStr != '=')){
+					break;
+				}
+				isSpinKeyword = 1;
+				const char cmp = *cmpStr;
+				cmpStr++;
+				uint8_t inclusive = (uint8_t)(cmp == '=');
+				if(*cmpStr == '='){
+					inclusive = 1;
+					cmpStr++;
+				}
+				if((*cmpStr == '\0')&&((i+1) < ss->numSearchTok)){
+					i++;
+					cmpStr = ss->searchTok[i];
+				}
+				uint16_t twoJ;
+				if(getSpinBoundFromStr(cmpStr,&twoJ)){
+					hasSpinBound = 1;
+					if(cmp == '>'){
+						minTwoJ = inclusive ? twoJ : (uint16_t)(twoJ + 1);
+					}else if(cmp == '<'){
+						if((twoJ == 0)&&(!inclusive)){
+							return; //no possible spins
+						}
+						maxTwoJ = inclusive ? twoJ : (uint16_t)(twoJ - 1);
+					}else{
+						minTwoJ = twoJ;
+						maxTwoJ = twoJ;
+					}
+				}
+				break;
+			}
+		}
+		if(isSpinKeyword){
+			continue;
+		}
+		//energy or half-life (eg. '1000', '10ms', '10 ms')
+		char *unitStr;
+		const double val = SDL_strtod(tok,&unitStr);
+		if((unitStr != tok)&&(val > 0.0)){
+			uint8_t hlUnit = VALUE_UNIT_NOVAL;
+			if(*unitStr != '\0'){
+				hlUnit = getTimeUnitFromStr(unitStr);
+			}else if((i+1) < ss->numSearchTok){
+				hlUnit = getTimeUnitFromStr(ss->searchTok[i+1]);
+			}
+			if(hlUnit != VALUE_UNIT_NOVAL){
+				hlSearchSeconds = getHalfLifeSecondsFromVal(ctx->useLifetimes ? val/1.4427 : val,hlUnit);
+			}else if(*unitStr == '\0'){
+				eSearch = val;
+			}
+		}
+	}
+	if((numJp == 0)&&(hasSpinBound == 0)){
+		return; //no spin-parity in the query
+	}
+	if(maxTwoJ < minTwoJ){
+		return;
+	}
+
+	//look up levels for each (2J, parity) combination matching the query
+	search_result topRes[MAX_SEARCH_RESULTS];
+	uint8_t numTopRes = 0;
+	const double hlWindowFac = (ss->broadSearch == 1) ? 10.0 : 2.0;
+	for(uint16_t twoJ=minTwoJ; twoJ<=maxTwoJ; twoJ++){
+		for(int8_t par=-1; par<=1; par++){
+			float parFac = 1.0f;
+			if(numJp > 0){
+				uint8_t keyMatches = 0;
+				for(uint8_t j=0; j<numJp; j++){
+					if(jpTwoJ[j] == twoJ){
+						if((jpPar[j] == 0)||(jpPar[j] == par)){
+							keyMatches = 1;
+							parFac = 1.0f;
+							break;
+						}else if(par == 0){
+							keyMatches = 1; //requested parity, level parity unknown
+							parFac = 0.5f;
+						}
+					}
+				}
+				if(!keyMatches){
+					continue;
+				}
+			}
+			if(isSearchCancelled(ss)){
+				return;
+			}
+			const uint16_t key = getSpinParIdxKey(twoJ,par);
+			for(uint32_t m=ndat->spIdxStart[key]; m<ndat->spIdxStart[key+1]; m++){
+				const spinpar_index_entry *ent = &ndat->spIdx[m];
+				const uint16_t j = ent->nuclInd;
+				const uint32_t k = ent->lvlInd;
+				if((ctx->searchInProgress == SEARCHSTATE_SEARCHING_SINGLENUCL)&&(j!=ss->boostedNucl)){
+					//if doing a single-nuclide search, skip all other nuclides
+					continue;
+				}
+				if((ctx->searchInProgress == SEARCHSTATE_SEARCHING_SINGLENUCL)&&(ctx->selectedRxn != 0)){
+					if(isSearchLvlDisplayed(ndat,ctx,j,(uint16_t)(k - ndat->nuclData[j].firstLevel))==0){
+						continue;
+					}
+				}
+				if((isomerOnly)||(hlSearchSeconds > 0.0)){
+					const double hl = getLevelHalfLifeSeconds(ndat,k);
+					if(isomerOnly){
+						if((k == (ndat->nuclData[j].firstLevel + ndat->nuclData[j].gsLevel))||(hl < ISOMER_MVAL_HL_THRESHOLD)){
+							continue;
+						}
+					}
+					if(hlSearchSeconds > 0.0){
+						if((hl < hlSearchSeconds/hlWindowFac)||(hl > hlSearchSeconds*hlWindowFac)){
+							continue;
+						}
+					}
+				}
+				const double lvlE = getLevelEnergykeV(ndat,k);
+				if(eSearch > 0.0){
+					double errBound = getEnergyMatchErrBound(lvlE,getRawErrFromDB(&ndat->levels[k].energy));
+					if(ss->broadSearch == 1){
+						errBound = errBound*5.0;
+					}
+					if(fabs(lvlE - eSearch) > errBound){
+						continue;
+					}
+				}
+
+				search_result res;
+				res.relevance = 0.5f; //base value
+				if(ent->tentative == TENTATIVESP_NONE){
+					res.relevance += 0.2f; //firm assignment
+				}
+				res.relevance *= parFac;
+				res.relevance += getProximityFactor(ndat,ctx,j);
+				if(eSearch > 0.0){
+					res.relevance /= (1.0f + (float)fabs(0.1*(eSearch - lvlE))); //weight by distance from value
+				}else if(lvlE > 0.0){
+					res.relevance /= (1.0f + (float)(lvlE/10000.0)); //prefer low-lying levels
+				}
+				res.resultType = SEARCHAGENT_SPINPAR;
+				res.resultVal[0] = (uint32_t)j; //nuclide index
+				res.resultVal[1] = k; //level index
+				boostSearchResult(ss,&res);
+				//levels with several spin-parity values may match more than once
+				uint8_t isDuplicate = 0;
+				for(uint8_t n=0; n<numTopRes; n++){
+					if(topRes[n].resultVal[1] == k){
+						if(res.relevance > topRes[n].relevance){
+							topRes[n].relevance = res.relevance;
+						}
+						isDuplicate = 1;
+						break;
+					}
+				}
+				if(!isDuplicate){
+					addTopResult(topRes,&numTopRes,&res);
+				}
+			}
+		}
+	}
+
+	for(uint8_t i=0; i<numTopRes; i++){
+		insertSearchResult(&ss->threadResults[SEARCHAGENT_SPINPAR].heap,&topRes[i]); //relevance was already boosted
+	}
+}
+
+//returns the field of a structured query corresponding to a name (eg. 'E', 'Eg', 'T'),
+//or QUERYFIELD_ENUM_LENGTH if the name isn't recognized
+static uint8_t getQueryFieldFromStr(const char *str){
+	if((SDL_strcasecmp(str,"e")==0)||(SDL_strcasecmp(str,"el")==0)||(SDL_strcasecmp(str,"elevel")==0)){
+		return QUERYFIELD_ELEVEL;
+	}else if((SDL_strcasecmp(str,"t")==0)||(SDL_strcasecmp(str,"hl")==0)||(SDL_strcasecmp(str,"halflife")==0)){
+		return QUERYFIELD_HALFLIFE;
+	}else if((SDL_strcasecmp(str,"j")==0)||(SDL_strcasecmp(str,"jpi")==0)||(SDL_strcasecmp(str,"spin")==0)){
+		return QUERYFIELD_SPIN;
+	}else if((SDL_strcasecmp(str,"p")==0)||(SDL_strcasecmp(str,"pi")==0)||(SDL_strcasecmp(str,"parity")==0)){
+		return QUERYFIELD_PARITY;
+	}else if((SDL_strcasecmp(str,"eg")==0)||(SDL_strcasecmp(str,"egamma")==0)){
+		return QUERYFIELD_EGAMMA;
+	}else if((SDL_strcasecmp(str,"ig")==0)||(SDL_strcasecmp(str,"igamma")==0)){
+		return QUERYFIELD_IGAMMA;
+	}else if(SDL_strcasecmp(str,"z")==0){
+		return QUERYFIELD_Z;
+	}else if(SDL_strcasecmp(str,"n")==0){
+		return QUERYFIELD_N;
+	}else if(SDL_strcasecmp(str,"a")==0){
+		return QUERYFIELD_A;
+	}
+	return QUERYFIELD_ENUM_LENGTH;
+}
+
+//parses a single value of a structured query predicate (eg. '1.5MeV', '100ns', '21/2', '+'),
+//converting to keV (energies), seconds (half-lives), or 2J (spins)
+//parity is set for spin values with a parity (eg. '9/2+'), returns 1 if successful
+static uint8_t getQueryVal(const char *str, const uint8_t field, double *val, int8_t *parity){
+	*parity = 0;
+	if(field == QUERYFIELD_PARITY){
+		if((SDL_strcmp(str,"+")==0)||(SDL_strcmp(str,"+1")==0)||(SDL_strcmp(str,"1")==0)){
+			*val = 1.0;
+			return 1;
+		}else if((SDL_strcmp(str,"-")==0)||(SDL_strcmp(str,"-1")==0)){
+			*val = -1.0;
+			return 1;
+		}
+		return 0;
+	}else if(field == QUERYFIELD_SPIN){
+		uint16_t twoJ;
+		if(getSpinBoundFromStr(str,&twoJ)){
+			*val = (double)twoJ;
+			return 1;
+		}else if(getSpinParFromStr(str,&twoJ,parity)){
+			*val = (double)twoJ;
+			return 1;
+		}
+		return 0;
+	}
+	char *endStr;
+	*val = SDL_strtod(str,&endStr);
+	if(endStr == str){
+		return 0;
+	}
+	if(*endStr == '\0'){
+		return 1; //no unit (keV, seconds, or unitless)
+	}
+	if((field == QUERYFIELD_ELEVEL)||(field == QUERYFIELD_EGAMMA)){
+		if(SDL_strcasecmp(endStr,"kev")==0){
+			return 1;
+		}else if(SDL_strcasecmp(endStr,"mev")==0){
+			*val *= 1000.0;
+			return 1;
+		}else if(SDL_strcasecmp(endStr,"ev")==0){
+			*val *= 0.001;
+			return 1;
+		}
+	}else if(field == QUERYFIELD_HALFLIFE){
+		const uint8_t unit = getTimeUnitFromStr(endStr);
+		if(unit != VALUE_UNIT_NOVAL){
+			*val = getHalfLifeSecondsFromVal(*val,unit);
+			return 1;
+		}
+	}
+	return 0; //unrecognized unit
+}
+
+//parses the two values of a range in a structured query (eg. '1000..2000', '100ns-10us'),
+//a unit given only for the second value also applies to the first (eg. '1-3MeV')
+//returns 1 if successful
+static uint8_t getQueryRangeVals(const char *str1, const char *str2, const uint8_t field, double *val1, double *val2){
+	int8_t parity1, parity2;
+	if((getQueryVal(str2,field,val2,&parity2) == 0)||(parity2 != 0)){
+		return 0;
+	}
+	char valStr[32];
+	SDL_strlcpy(valStr,str1,sizeof(valStr));
+	if((field == QUERYFIELD_ELEVEL)||(field == QUERYFIELD_EGAMMA)||(field == QUERYFIELD_HALFLIFE)){
+		char *endStr1, *endStr2;
+		SDL_strtod(str1,&endStr1);
+		SDL_strtod(str2,&endStr2);
+		if((endStr1 != str1)&&(*endStr1 == '\0')){
+			SDL_strlcat(valStr,endStr2,sizeof(valStr)); //no unit for the first value
+		}
+	}
+	if((getQueryVal(valStr,field,val1,&parity1) == 0)||(parity1 != 0)){
+		return 0;
+	}
+	return 1;
+}
+
+//finds the '-' separating the values of a range written as 'a-b' (eg. '1000-3000',
+//'100ns-10us'), ignoring signs and exponents, returns NULL if there is none
+static char *getQueryRangeSep(char *str){
+	for(uint8_t i=1; str[i]!='\0'; i++){
+		if((str[i] == '-')&&(str[i-1] != 'e')&&(str[i-1] != 'E')){
+			return &str[i];
+		}
+	}
+	return NULL;
+}
+
+//parses the nuclide or element a structured query is restricted to
+//(eg. '178Hf', 'Hf'), returns 1 if successful
+static uint8_t getQueryScope(const char *str, int16_t *Z, int16_t *A){
+	uint16_t massNum = 0;
+	uint8_t pos = 0;
+	while(isdigit((unsigned char)str[pos])){
+		if(pos >= 3){
+			return 0;
+		}
+		massNum = (uint16_t)(massNum*10U + (uint16_t)(str[pos] - '0'));
+		pos++;
+	}
+	const uint8_t elemZ = elemStrToZ(&str[pos]);
+	if((elemZ == 255)||(elemZ == 0)){
+		return 0; //not an element (the neutron can't be searched this way)
+	}
+	if((pos > 0)&&(massNum < elemZ)){
+		return 0;
+	}
+	*Z = (int16_t)elemZ;
+	*A = (int16_t)massNum;
+	return 1;
+}
+
+//compiles a structured query (eg. 'E>1000 AND T<1us OR J=9/2+ in 178Hf') into a plan
+//clauses are separated by 'OR', predicates within a clause are combined with AND
+//(either implicitly or with 'AND'), and nuclide/element names restrict the whole query
+//ranges can also be given as 'E:1000-3000', 'T:>1ms' (an inclusive bound), or 'T:1ms'
+//(same as 'T=1ms'), eg. 'E:1-3MeV T:100ns-10us', '178Hf T:>1s'
+//if the string isn't a valid structured query, plan->numClauses is set to 0
+void compileQueryPlan(const char *str, query_plan *plan){
+	SDL_memset(plan,0,sizeof(query_plan));
+	uint8_t numClauses = 1;
+	uint8_t hasScopeKeyword = 0;
+	const char *pos = str;
+	while(1){
+		while((*pos == ' ')||(*pos == ',')||(*pos == '\t')){
+			pos++;
+		}
+		if(*pos == '\0'){
+			break;
+		}
+		if((*pos == '&')||(*pos == '|')){
+			const char opChar = *pos;
+			pos++;
+			if(*pos == opChar){
+				pos++; //'&&' or '||'
+			}
+			if(opChar == '|'){
+				if((plan->clause[numClauses-1].numPreds == 0)||(numClauses >= MAX_QUERY_CLAUSES)){
+					plan->numClauses = 0;
+					return;
+				}
+				numClauses++;
+			}
+			continue;
+		}
+
+		//read a word (field name, keyword, or nuclide/element)
+		char word[16];
+		uint8_t wordLen = 0;
+		while(isalnum((unsigned char)*pos)){
+			if(wordLen >= 15){
+				plan->numClauses = 0;
+				return;
+			}
+			word[wordLen] = *pos;
+			wordLen++;
+			pos++;
+		}
+		word[wordLen] = '\0';
+		if(wordLen == 0){
+			plan->numClauses = 0;
+			return; //unexpected character
+		}
+		const char *opPos = pos;
+		while(*opPos == ' '){
+			opPos++;
+		}
+		if((*opPos != '<')&&(*opPos != '>')&&(*opPos != '=')&&(*opPos != '!')&&(*opPos != ':')){
+			//not followed by an operator
+			if(hasScopeKeyword == 0){
+				if(SDL_strcasecmp(word,"and")==0){
+					continue;
+				}else if(SDL_strcasecmp(word,"or")==0){
+					if((plan->clause[numClauses-1].numPreds == 0)||(numClauses >= MAX_QUERY_CLAUSES)){
+						plan->numClauses = 0;
+						return;
+					}
+					numClauses++;
+					continue;
+				}else if((SDL_strcasecmp(word,"in")==0)&&(SDL_strcmp(word,"In")!=0)){ //'In' is indium
+					hasScopeKeyword = 1;
+					continue;
+				}
+			}
+			hasScopeKeyword = 0;
+			if((plan->numScopes >= MAX_QUERY_SCOPES)||(getQueryScope(word,&plan->scopeZ[plan->numScopes],&plan->scopeA[plan->numScopes]) == 0)){
+				plan->numClauses = 0;
+				return;
+			}
+			plan->numScopes++;
+			continue;
+		}
+		if(hasScopeKeyword){
+			plan->numClauses = 0;
+			return; //'in' must be followed by a nuclide or element
+		}
+
+		//predicate
+		const uint8_t field = getQueryFieldFromStr(word);
+		if(field == QUERYFIELD_ENUM_LENGTH){
+			plan->numClauses = 0;
+			return;
+		}
+		char op[3] = {opPos[0],'\0','\0'};
+		opPos++;
+		const uint8_t isRangeOp = (op[0] == ':'); //'E:1000-3000', 'T:>1ms', etc.
+		if(isRangeOp){
+			if((*opPos == '<')||(*opPos == '>')){
+				op[0] = *opPos; //bounds are inclusive
+				op[1] = '=';
+				opPos++;
+			}else{
+				op[0] = '=';
+			}
+		}else if(*opPos == '='){
+			op[1] = '=';
+			opPos++;
+		}
+		if(SDL_strcmp(op,"!")==0){
+			plan->numClauses = 0;
+			return;
+		}
+		while(*opPos == ' '){
+			opPos++;
+		}
+		char valStr[32];
+		uint8_t valLen = 0;
+		while((*opPos != '\0')&&(*opPos != ' ')&&(*opPos != ',')&&(*opPos != '&')&&(*opPos != '|')){
+			if(valLen >= 31){
+				plan->numClauses = 0;
+				return;
+			}
+			valStr[valLen] = *opPos;
+			valLen++;
+			opPos++;
+		}
+		valStr[valLen] = '\0';
+		pos = opPos;
+
+		query_clause *cl = &plan->clause[numClauses-1];
+		if(cl->numPreds >= (MAX_QUERY_CLAUSE_PREDS-1)){
+			plan->numClauses = 0;
+			return; //leave space for a parity predicate
+		}
+		query_pred *pr = &cl->pred[cl->numPreds];
+		pr->field = field;
+		pr->minVal = -(double)INFINITY;
+		pr->maxVal = (double)INFINITY;
+		double val;
+		int8_t parity;
+		char *rangeSep = SDL_strstr(valStr,"..");
+		uint8_t rangeSepLen = 2;
+		if((rangeSep == NULL)&&(isRangeOp)&&(op[1] == '\0')&&(field != QUERYFIELD_SPIN)&&(field != QUERYFIELD_PARITY)){
+			rangeSep = getQueryRangeSep(valStr);
+			rangeSepLen = 1;
+		}
+		if(rangeSep != NULL){
+			//range of values, eg. 'E=1000..2000', 'E:1000-2000'
+			if((SDL_strcmp(op,"=")!=0)&&(SDL_strcmp(op,"==")!=0)&&(SDL_strcmp(op,"!=")!=0)){
+				plan->numClauses = 0;
+				return;
+			}
+			*rangeSep = '\0';
+			double val2;
+			if(getQueryRangeVals(valStr,&rangeSep[rangeSepLen],field,&val,&val2) == 0){
+				plan->numClauses = 0;
+				return;
+			}
+			parity = 0;
+			pr->minVal = (val < val2) ? val : val2;
+			pr->maxVal = (val < val2) ? val2 : val;
+			pr->negate = (op[0] == '!');
+		}else{
+			if(getQueryVal(valStr,field,&val,&parity) == 0){
+				plan->numClauses = 0;
+				return;
+			}
+			if((SDL_strcmp(op,"=")==0)||(SDL_strcmp(op,"==")==0)||(SDL_strcmp(op,"!=")==0)){
+				if((field == QUERYFIELD_ELEVEL)||(field == QUERYFIELD_EGAMMA)){
+					const double errBound = getEnergyMatchErrBound(val,0.0);
+					pr->minVal = val - errBound;
+					pr->maxVal = val + errBound;
+				}else if(field == QUERYFIELD_HALFLIFE){
+					pr->minVal = val/2.0;
+					pr->maxVal = val*2.0;
+				}else{
+					pr->minVal = val;
+					pr->maxVal = val;
+				}
+				pr->negate = (op[0] == '!');
+			}else if(op[0] == '<'){
+				pr->maxVal = val;
+				pr->maxExcl = (op[1] != '=');
+			}else if(op[0] == '>'){
+				pr->minVal = val;
+				pr->minExcl = (op[1] != '=');
+			}else{
+				plan->numClauses = 0;
+				return;
+			}
+			if((field == QUERYFIELD_PARITY)&&(pr->minVal != pr->maxVal)){
+				plan->numClauses = 0;
+				return; //parity can only be compared for (in)equality
+			}
+		}
+		cl->numPreds++;
+		if((parity != 0)&&(pr->negate)){
+			plan->numClauses = 0;
+			return; //ambiguous (eg. 'J!=9/2+')
+		}
+		if(parity != 0){
+			//spin with a parity (eg. 'J=9/2+')
+			pr = &cl->pred[cl->numPreds];
+			pr->field = QUERYFIELD_PARITY;
+			pr->minVal = (double)parity;
+			pr->maxVal = (double)parity;
+			cl->numPreds++;
+		}
+	}
+	if((hasScopeKeyword)||(plan->clause[numClauses-1].numPreds == 0)){
+		plan->numClauses = 0;
+		return;
+	}
+	plan->numClauses = numClauses;
+}
+
+//predicate of a structured query, lowered to bounds on one of the query columns
+typedef struct
+{
+	const float *col; //column scanned, indexed by level or transition
+	uint8_t field; //field of the predicate, values from query_field_enum
+	uint8_t colByLvl; //1 if the column is indexed by level (and the rows being scanned are transitions)
+	float lo, hi; //inclusive bounds
+	uint8_t negate;
+	float selectivity; //estimated fraction of rows matching
+}query_scan_pred;
+
+#define QUERY_SELECTIVITY_SAMPLES 512 //number of rows sampled to estimate the selectivity of each predicate
+
+//scans the rows [first,last) with a predicate, appending matching rows to the selection
+//written without branches in the loop body so that the compiler can vectorize it
+static uint32_t scanQueryPredRange(const query_scan_pred *qp, const uint32_t *restrict tranLvl, const uint32_t first, const uint32_t last, uint32_t *restrict sel, uint32_t numSel){
+	const float *restrict col = qp->col;
+	const float lo = qp->lo;
+	const float hi = qp->hi;
+	if(qp->colByLvl){
+		for(uint32_t i=first; i<last; i++){
+			const float v = col[tranLvl[i]];
+			sel[numSel] = i;
+			numSel += (uint32_t)(((v >= lo)&(v <= hi)) ^ qp->negate) & (uint32_t)(!isnan(v)); //unknown values never match
+		}
+	}else if(qp->negate){
+		for(uint32_t i=first; i<last; i++){
+			sel[numSel] = i;
+			numSel += (uint32_t)((col[i] < lo)|(col[i] > hi));
+		}
+	}else{
+		for(uint32_t i=first; i<last; i++){
+			sel[numSel] = i;
+			numSel += (uint32_t)((col[i] >= lo)&(col[i] <= hi));
+		}
+	}
+	return numSel;
+}
+
+//filters the selected rows with a predicate, in place, returning the number of rows remaining
+static uint32_t filterQueryPredSel(const query_scan_pred *qp, const uint32_t *restrict tranLvl, uint32_t *restrict sel, const uint32_t numSel){
+	const float *restrict col = qp->col;
+	const float lo = qp->lo;
+	const float hi = qp->hi;
+	uint32_t numRemaining = 0;
+	for(uint32_t m=0; m<numSel; m++){
+		const uint32_t row = sel[m];
+		const float v = qp->colByLvl ? col[tranLvl[row]] : col[row];
+		sel[numRemaining] = row;
+		numRemaining += (uint32_t)(((v >= lo)&(v <= hi)) ^ qp->negate) & (uint32_t)(!isnan(v)); //unknown values never match
+	}
+	return numRemaining;
+}
+
+//lowers a predicate on a level or transition field to a column scan
+//tranRows: 1 if the rows being scanned are transitions
+static void getQueryScanPred(const ndata *restrict ndat, const search_context *ctx, const query_pred *pr, const uint8_t tranRows, query_scan_pred *qp){
+	double minVal = pr->minVal;
+	double maxVal = pr->maxVal;
+	qp->field = pr->field;
+	qp->colByLvl = tranRows;
+	switch(pr->field){
+		case QUERYFIELD_HALFLIFE:
+			qp->col = ndat->qColLvlLogHl;
+			if(ctx->useLifetimes){
+				//convert lifetime to half-life
+				minVal /= 1.4427;
+				maxVal /= 1.4427;
+			}
+			minVal = (minVal > 0.0) ? SDL_log10(minVal) : -(double)INFINITY;
+			maxVal = (maxVal > 0.0) ? SDL_log10(maxVal) : -(double)INFINITY;
+			break;
+		case QUERYFIELD_SPIN:
+			qp->col = ndat->qColLvlTwoJ;
+			break;
+		case QUERYFIELD_PARITY:
+			qp->col = ndat->qColLvlPar;
+			break;
+		case QUERYFIELD_EGAMMA:
+			qp->col = ndat->qColTranE;
+			qp->colByLvl = 0;
+			break;
+		case QUERYFIELD_IGAMMA:
+			qp->col = ndat->qColTranI;
+			qp->colByLvl = 0;
+			break;
+		case QUERYFIELD_ELEVEL:
+		default:
+			qp->col = ndat->qColLvlE;
+			break;
+	}
+	qp->lo = (float)minVal;
+	qp->hi = (float)maxVal;
+	if(pr->minExcl){
+		qp->lo = nextafterf(qp->lo,INFINITY);
+	}
+	if(pr->maxExcl){
+		qp->hi = nextafterf(qp->hi,-INFINITY);
+	}
+	qp->negate = pr->negate;
+
+	//estimate the selectivity from an evenly spaced sample of rows
+	const uint32_t numRows = tranRows ? ndat->numTran : ndat->numLvls;
+	uint32_t sel[QUERY_SELECTIVITY_SAMPLES];
+	uint32_t numSamples = 0;
+	const uint32_t stride = (numRows > QUERY_SELECTIVITY_SAMPLES) ? (numRows/QUERY_SELECTIVITY_SAMPLES) : 1;
+	for(uint32_t i=0; (i<numRows)&&(numSamples<QUERY_SELECTIVITY_SAMPLES); i+=stride){
+		sel[numSamples] = i;
+		numSamples++;
+	}
+	qp->selectivity = (numSamples > 0) ? (float)filterQueryPredSel(qp,ndat->qColTranLvl,sel,numSamples)/(float)numSamples : 1.0f;
+}
+
+//gets the levels in the cells of the (energy, half-life) grid index overlapping the bounds of
+//a level energy and a half-life predicate (a superset of the levels matching both predicates)
+static uint32_t getQueryEHlGridRows(const ndata *restrict ndat, const query_scan_pred *eQp, const query_scan_pred *tQp, uint32_t *restrict sel){
+	//one extra bin is taken on each side, since the bounds are rounded to single precision
+	const uint16_t eBinMin = getEHlGridEBin((double)eQp->lo);
+	const uint16_t eBinMax = getEHlGridEBin((double)eQp->hi);
+	const uint16_t tBinMin = getEHlGridTBin(SDL_pow(10.0,(double)tQp->lo));
+	const uint16_t tBinMax = getEHlGridTBin(SDL_pow(10.0,(double)tQp->hi));
+	uint32_t numSel = 0;
+	for(uint16_t eBin=((eBinMin > 0) ? (uint16_t)(eBinMin-1) : 0); (eBin<=(eBinMax+1))&&(eBin<EHL_GRID_E_BINS); eBin++){
+		const uint32_t firstCell = (uint32_t)eBin*EHL_GRID_T_BINS + ((tBinMin > 0) ? (uint32_t)(tBinMin-1) : 0);
+		const uint32_t lastCell = (uint32_t)eBin*EHL_GRID_T_BINS + ((tBinMax < (EHL_GRID_T_BINS-1)) ? (uint32_t)(tBinMax+1) : (EHL_GRID_T_BINS-1));
+		//cells with consecutive half-life bins are adjacent in the index
+		const uint32_t numRows = ndat->eHlGridStart[lastCell+1] - ndat->eHlGridStart[firstCell];
+		memcpy(&sel[numSel],&ndat->eHlGrid[ndat->eHlGridStart[firstCell]],numRows*sizeof(uint32_t));
+		numSel += numRows;
+	}
+	return numSel;
+}
+
+//checks whether a nuclide matches the scope and nuclide predicates of a structured query clause
+static uint8_t isQueryNuclMatch(const ndata *restrict ndat, const query_plan *plan, const query_clause *cl, const uint16_t nuclInd){
+	const int16_t Z = ndat->nuclData[nuclInd].Z;
+	const int16_t A = (int16_t)(ndat->nuclData[nuclInd].Z + ndat->nuclData[nuclInd].N);
+	if(plan->numScopes > 0){
+		uint8_t inScope = 0;
+		for(uint8_t i=0; i<plan->numScopes; i++){
+			if((plan->scopeZ[i] == Z)&&((plan->scopeA[i] == 0)||(plan->scopeA[i] == A))){
+				inScope = 1;
+				break;
+			}
+		}
+		if(inScope == 0){
+			return 0;
+		}
+	}
+	for(uint8_t i=0; i<cl->numPreds; i++){
+		const query_pred *pr = &cl->pred[i];
+		double val;
+		if(pr->field == QUERYFIELD_Z){
+			val = (double)Z;
+		}else if(pr->field == QUERYFIELD_N){
+			val = (double)ndat->nuclData[nuclInd].N;
+		}else if(pr->field == QUERYFIELD_A){
+			val = (double)A;
+		}else{
+			continue;
+		}
+		uint8_t inBounds = 1;
+		if((val < pr->minVal)||(val > pr->maxVal)||((pr->minExcl)&&(val == pr->minVal))||((pr->maxExcl)&&(val == pr->maxVal))){
+			inBounds = 0;
+		}
+		if(inBounds == pr->negate){
+			return 0;
+		}
+	}
+	return 1;
+}
+
+//searches for levels or gamma-rays matching a structured query, eg. 'E>1000 AND T<1us OR J=9/2+ in 178Hf'
+//each clause is run as a pipeline of column scans, with the most selective predicates applied first
+//(levels restricted by both energy and half-life are instead looked up in the (energy, half-life) grid index)
+void searchQuery(const ndata *restrict ndat, const search_context *ctx, search_state *ss){
+
+	const query_plan *plan = &ss->queryPlan;
+	if(plan->numClauses == 0){
+		return;
+	}
+
+	const uint32_t maxRows = (ndat->numTran > ndat->numLvls) ? ndat->numTran : ndat->numLvls;
+	uint32_t *sel = (uint32_t*)SDL_malloc(((size_t)maxRows + 2*MAXNUMNUCL)*sizeof(uint32_t));
+	if(sel == NULL){
+		SDL_Log("ERROR: searchQuery - couldn't allocate memory.\n");
+		return;
+	}
+	uint32_t *rangeFirst = &sel[maxRows]; //ranges of rows belonging to the matching nuclides
+	uint32_t *rangeLast = &sel[maxRows + MAXNUMNUCL];
+
+	search_result topRes[MAX_SEARCH_RESULTS];
+	uint8_t numTopRes = 0;
+	for(uint8_t c=0; c<plan->numClauses; c++){
+		if(isSearchCancelled(ss)){
+			break; //results won't be used
+		}
+		const query_clause *cl = &plan->clause[c];
+
+		//rows are transitions if the clause has any transition predicates, levels otherwise
+		uint8_t tranRows = 0;
+		for(uint8_t i=0; i<cl->numPreds; i++){
+			if((cl->pred[i].field == QUERYFIELD_EGAMMA)||(cl->pred[i].field == QUERYFIELD_IGAMMA)){
+				tranRows = 1;
+			}
+		}
+
+		//lower the level and transition predicates, and order them by selectivity
+		query_scan_pred qp[MAX_QUERY_CLAUSE_PREDS];
+		uint8_t numQp = 0;
+		uint8_t allNucl = (uint8_t)((plan->numScopes == 0)&&(ctx->searchInProgress != SEARCHSTATE_SEARCHING_SINGLENUCL)); //1 if rows in all nuclides can match
+		for(uint8_t i=0; i<cl->numPreds; i++){
+			if((cl->pred[i].field == QUERYFIELD_Z)||(cl->pred[i].field == QUERYFIELD_N)||(cl->pred[i].field == QUERYFIELD_A)){
+				allNucl = 0;
+				continue; //applied per nuclide
+			}
+			getQueryScanPred(ndat,ctx,&cl->pred[i],tranRows,&qp[numQp]);
+			for(uint8_t j=numQp; (j>0)&&(qp[j].selectivity < qp[j-1].selectivity); j--){
+				const query_scan_pred tmp = qp[j];
+				qp[j] = qp[j-1];
+				qp[j-1] = tmp;
+			}
+			numQp++;
+		}
+
+		//non-negated level energy and half-life predicates (used to look up levels in the grid index, and to rank levels)
+		int8_t eQpInd = -1;
+		int8_t tQpInd = -1;
+		for(uint8_t i=0; i<numQp; i++){
+			if((tranRows == 0)&&(qp[i].negate == 0)){
+				if(qp[i].field == QUERYFIELD_ELEVEL){
+					eQpInd = (int8_t)i;
+				}else if(qp[i].field == QUERYFIELD_HALFLIFE){
+					tQpInd = (int8_t)i;
+				}
+			}
+		}
+
+		uint32_t numSel = 0;
+		uint8_t firstFilterQp = 1;
+		if((allNucl)&&(eQpInd >= 0)&&(tQpInd >= 0)&&(qp[tQpInd].hi < INFINITY)){
+			//only levels with known energy and (non-stable) half-life can match, which are
+			//all in the (energy, half-life) grid index, so only the overlapping cells are visited
+			numSel = getQueryEHlGridRows(ndat,&qp[eQpInd],&qp[tQpInd],sel);
+			firstFilterQp = 0;
+		}else{
+			//get the ranges of rows in the matching nuclides (merging adjacent ranges)
+			uint32_t numRanges = 0;
+			for(uint16_t j=0; j<ndat->numNucl; j++){
+				if((ctx->searchInProgress == SEARCHSTATE_SEARCHING_SINGLENUCL)&&(j!=ss->boostedNucl)){
+					//if doing a single-nuclide search, skip all other nuclides
+					continue;
+				}
+				if(ndat->nuclData[j].numLevels == 0){
+					continue;
+				}
+				if(isQueryNuclMatch(ndat,plan,cl,j) == 0){
+					continue;
+				}
+				uint32_t first = ndat->nuclData[j].firstLevel;
+				uint32_t last = first + (uint32_t)ndat->nuclData[j].numLevels;
+				if(tranRows){
+					const uint32_t lastLvl = last;
+					last = 0;
+					for(uint32_t k=first; k<lastLvl; k++){
+						if(ndat->levels[k].numTran > 0){
+							if(last == 0){
+								first = ndat->levels[k].firstTran;
+							}
+							last = ndat->levels[k].firstTran + (uint32_t)ndat->levels[k].numTran;
+						}
+					}
+					if(last == 0){
+						continue; //no transitions
+					}
+				}
+				if((numRanges > 0)&&(rangeLast[numRanges-1] == first)){
+					rangeLast[numRanges-1] = last;
+				}else{
+					rangeFirst[numRanges] = first;
+					rangeLast[numRanges] = last;
+					numRanges++;
+				}
+			}
+
+			//run the pipeline
+			for(uint32_t r=0; r<numRanges; r++){
+				if(numQp > 0){
+					numSel = scanQueryPredRange(&qp[0],ndat->qColTranLvl,rangeFirst[r],rangeLast[r],sel,numSel);
+				}else{
+					for(uint32_t i=rangeFirst[r]; i<rangeLast[r]; i++){
+						sel[numSel] = i;
+						numSel++;
+					}
+				}
+			}
+		}
+		for(uint8_t i=firstFilterQp; i<numQp; i++){
+			numSel = filterQueryPredSel(&qp[i],ndat->qColTranLvl,sel,numSel);
+		}
+
+		//rank the matching rows (levels by half-life if the clause has a half-life range)
+		float logHlRankMin = 0.0f;
+		float logHlRankRange = 1.0f;
+		if(tQpInd >= 0){
+			const float logHlMax = (float)(EHL_GRID_LOGT_MIN + EHL_GRID_T_BINS*EHL_GRID_LOGT_BIN);
+			logHlRankMin = (qp[tQpInd].lo > (float)EHL_GRID_LOGT_MIN) ? qp[tQpInd].lo : (float)EHL_GRID_LOGT_MIN;
+			const float logHlRankMax = (qp[tQpInd].hi < logHlMax) ? qp[tQpInd].hi : logHlMax;
+			if(logHlRankMax > logHlRankMin){
+				logHlRankRange = logHlRankMax - logHlRankMin;
+			}
+		}
+		for(uint32_t m=0; m<numSel; m++){
+			if(((m % SEARCH_CANCEL_CHECK_INTERVAL) == 0)&&(isSearchCancelled(ss))){
+				break; //results won't be used
+			}
+			const uint32_t k = tranRows ? ndat->qColTranLvl[sel[m]] : sel[m];
+			const uint16_t j = ndat->qColLvlNucl[k];
+			if((ctx->searchInProgress == SEARCHSTATE_SEARCHING_SINGLENUCL)&&(ctx->selectedRxn != 0)){
+				if(isSearchLvlDisplayed(ndat,ctx,j,(uint16_t)(k - ndat->nuclData[j].firstLevel))==0){
+					continue;
+				}
+			}
+			search_result res;
+			res.relevance = 0.5f + getProximityFactor(ndat,ctx,j);
+			if(tranRows){
+				//prefer strong gamma-rays
+				const float intensity = ndat->qColTranI[sel[m]];
+				if(!isnan(intensity)){
+					res.relevance += 0.3f*((intensity > 100.0f) ? 1.0f : intensity/100.0f);
+				}
+				res.resultType = SEARCHAGENT_EGAMMA; //shown in the same way as gamma energy search results
+				res.resultVal[0] = (uint32_t)j; //nuclide index
+				res.resultVal[1] = sel[m]; //transition index
+				res.resultVal[2] = k; //level index
+				res.resultVal[3] = 0;
+			}else if(tQpInd >= 0){
+				//prefer longer half-lives within the range
+				float hlFrac = (ndat->qColLvlLogHl[k] - logHlRankMin)/logHlRankRange;
+				if(hlFrac > 1.0f){
+					hlFrac = 1.0f; //includes stable levels
+				}else if(hlFrac < 0.0f){
+					hlFrac = 0.0f;
+				}
+				res.relevance += 0.3f*hlFrac;
+				res.resultType = SEARCHAGENT_HALFLIFE; //shown in the same way as half-life search results
+				res.resultVal[0] = (uint32_t)j; //nuclide index
+				res.resultVal[1] = k; //level index
+			}else{
+				//prefer low-lying levels
+				const float energy = ndat->qColLvlE[k];
+				if(!isnan(energy)){
+					res.relevance += 0.3f/(1.0f + energy/1000.0f);
+				}
+				res.resultType = SEARCHAGENT_ELEVEL; //shown in the same way as level energy search results
+				res.resultVal[0] = (uint32_t)j; //nuclide index
+				res.resultVal[1] = k; //level index
+			}
+			if(plan->numClauses > 1){
+				//don't list rows matching multiple clauses more than once
+				uint8_t isDuplicate = 0;
+				for(uint8_t i=0; i<numTopRes; i++){
+					if(((topRes[i].resultType == SEARCHAGENT_EGAMMA) == tranRows)&&(topRes[i].resultVal[1] == res.resultVal[1])){
+						isDuplicate = 1;
+						break;
+					}
+				}
+				if(isDuplicate){
+					continue;
+				}
+			}
+			boostSearchResult(ss,&res);
+			addTopResult(topRes,&numTopRes,&res);
+		}
+	}
+	SDL_free(sel);
+
+	for(uint8_t i=0; i<numTopRes; i++){
+		insertSearchResult(&ss->threadResults[SEARCHAGENT_QUERY].heap,&topRes[i]); //relevance was already boosted
+	}
+}
+
+//ranks nuclides by abundance, then ground state half-life
+//returns a value between 0 and 1 (0.5 and above for stable/abundant nuclides)
+static float getNuclProminence(const ndata *restrict ndat, const uint16_t nuclInd){
+	float abundance = ndat->nuclData[nuclInd].abundance.val;
+	if(abundance > 0.0f){
+		return 0.5f + 0.5f*(abundance/100.0f); //100% abundance gives relevance = 1
+	}
+	double gsHlFac = getNuclLevelHalfLifeSeconds(ndat,nuclInd,ndat->nuclData[nuclInd].gsLevel);
+	if(gsHlFac <= 0.0){
+		return 0.0f;
+	}
+	//SDL_Log("%i %i: %e\n",ndat->nuclData[nuclInd].Z,ndat->nuclData[nuclInd].N,gsHlFac);
+	gsHlFac = 100.0 + SDL_log(gsHlFac); //SDL_log (logarithm), not SDL_Log (printf equivalent)
+	if(gsHlFac > 130.0){
+		gsHlFac = 130.0;
+	}else if(gsHlFac < 0.0){
+		gsHlFac = 0.0;
+	}
+	gsHlFac /= 130.0;
+	return (float)(0.5*gsHlFac);
+}
+
+//edit distance between a query and the closest prefix of a nuclide name index
+//entry (so that partial input like 'uran' matches 'uranium238' exactly),
+//returns maxDist+1 if the distance is larger than maxDist
+//matchLen is set to the length of the closest prefix
+static uint8_t getNuclNamePrefixDist(const char *query, const uint8_t qLen, const nucl_name_index_entry *restrict ent, const uint8_t maxDist, uint8_t *matchLen){
+	uint8_t row[NUCL_NAME_IDX_STR_LEN];
+	for(uint8_t i=0; i<=qLen; i++){
+		row[i] = i; //distance from the empty prefix
+	}
+	uint8_t bestDist = qLen;
+	*matchLen = 0;
+	uint8_t maxPrefixLen = (uint8_t)(qLen + maxDist);
+	if(maxPrefixLen > ent->len){
+		maxPrefixLen = ent->len;
+	}
+	for(uint8_t j=1; j<=maxPrefixLen; j++){
+		uint8_t diag = row[0];
+		row[0] = j;
+		uint8_t rowMin = row[0];
+		for(uint8_t i=1; i<=qLen; i++){
+			const uint8_t above = row[i];
+			uint8_t dist = (uint8_t)(diag + ((query[i-1] == ent->name[j-1]) ? 0 : 1)); //substitution
+			if((above + 1) < dist){
+				dist = (uint8_t)(above + 1); //insertion
+			}
+			if((row[i-1] + 1) < dist){
+				dist = (uint8_t)(row[i-1] + 1); //deletion
+			}
+			row[i] = dist;
+			diag = above;
+			if(dist < rowMin){
+				rowMin = dist;
+			}
+		}
+		if(row[qLen] < bestDist){
+			bestDist = row[qLen];
+			*matchLen = j;
+		}
+		if(rowMin > maxDist){
+			break; //no longer prefix can match
+		}
+	}
+	if(bestDist > maxDist){
+		return (uint8_t)(maxDist + 1);
+	}
+	return bestDist;
+}
+
+//typo-tolerant search of the nuclide name index, for partial or misspelled
+//nuclide and isomer names (eg. 'uran', 'hf178m', 'cobalt60')
+static void searchNuclNamesFuzzy(const ndata *restrict ndat, search_state *restrict ss, const char *tok){
+	char query[NUCL_NAME_IDX_STR_LEN];
+	const uint8_t qLen = getNuclNameIdxKey(query,tok);
+	if((qLen < 2)||(ndat->numNuclNameIdx == 0)){
+		return;
+	}
+	uint8_t hasLetter = 0;
+	for(uint8_t i=0; i<qLen; i++){
+		if((query[i] >= 'a')&&(query[i] <= 'z')){
+			hasLetter = 1;
+			break;
+		}
+	}
+	if(hasLetter == 0){
+		return; //numbers are handled by the other search agents
+	}
+	//allowed number of edits scales with query length
+	uint8_t maxDist = 0;
+	if(qLen > 6){
+		maxDist = 2;
+	}else if(qLen > 3){
+		maxDist = 1;
+	}
+
+	//a name within maxDist edits of the query shares all but at most 3*maxDist
+	//of the query's distinct trigrams, use this to skip most names without
+	//computing the edit distance
+	uint32_t qCodes[NUCL_NAME_IDX_STR_LEN];
+	uint8_t numQCodes = 0;
+	for(uint8_t i=0; i<qLen; i++){
+		const uint32_t code = getNuclNameTrigramCode(query,i);
+		uint8_t dup = 0;
+		for(uint8_t j=0; j<numQCodes; j++){
+			if(qCodes[j] == code){
+				dup = 1;
+				break;
+			}
+		}
+		if(dup == 0){
+			qCodes[numQCodes] = code;
+			numQCodes++;
+		}
+	}
+	uint8_t *numShared = NULL;
+	const int16_t minShared = (int16_t)(numQCodes - 3*maxDist);
+	if(minShared > 0){
+		if(ss->nuclNameShared == NULL){
+			ss->nuclNameShared = (uint8_t*)SDL_calloc(ndat->numNuclNameIdx,sizeof(uint8_t));
+			if(ss->nuclNameShared == NULL){
+				SDL_Log("ERROR: searchNuclNamesFuzzy - couldn't allocate memory.\n");
+				return;
+			}
+		}
+		numShared = ss->nuclNameShared;
+		for(uint8_t i=0; i<numQCodes; i++){
+			for(uint32_t j=ndat->nuclNameTrigramStart[qCodes[i]]; j<ndat->nuclNameTrigramStart[qCodes[i]+1]; j++){
+				numShared[ndat->nuclNameTrigramPostings[j]]++;
+			}
+		}
+	}
+
+	//spellings of the same nuclide/isomer are adjacent in the index, report the
+	//best matching spelling of each
+	float bestRel = 0.0f;
+	for(uint16_t i=0; i<ndat->numNuclNameIdx; i++){
+		const nucl_name_index_entry *ent = &ndat->nuclNameIdx[i];
+		if((numShared == NULL)||(numShared[i] >= minShared)){
+			uint8_t matchLen;
+			const uint8_t dist = getNuclNamePrefixDist(query,qLen,ent,maxDist,&matchLen);
+			if(dist <= maxDist){
+				float rel = 0.5f*(1.0f - (float)dist/(float)(maxDist+1)); //fuzzy matches rank below exact matches
+				rel *= 0.5f + 0.5f*((float)matchLen/(float)ent->len); //prefer complete names
+				rel *= 0.5f + 0.5f*getNuclProminence(ndat,ent->nuclInd);
+				if(rel > bestRel){
+					bestRel = rel;
+				}
+			}
+		}
+		if(((i+1) == ndat->numNuclNameIdx)||(ndat->nuclNameIdx[i+1].nuclInd != ent->nuclInd)||(ndat->nuclNameIdx[i+1].lvlInd != ent->lvlInd)){
+			if(bestRel > 0.0f){
+				search_result res;
+				res.relevance = bestRel;
+				if(ent->lvlInd < MAXNUMLVLS){
+					res.resultType = SEARCHAGENT_ELEVEL; //isomer
+					res.resultVal[0] = ent->nuclInd;
+					res.resultVal[1] = ent->lvlInd;
+				}else{
+					res.resultType = SEARCHAGENT_NUCLIDE;
+					res.resultVal[0] = ent->nuclInd;
+					res.resultVal[1] = 0;
+				}
+				appendSearchResult(ss,SEARCHAGENT_NUCLIDE,&res);
+			}
+			bestRel = 0.0f;
+		}
+	}
+	if(numShared != NULL){
+		//clear the counts for the next search
+		for(uint8_t i=0; i<numQCodes; i++){
+			for(uint32_t j=ndat->nuclNameTrigramStart[qCodes[i]]; j<ndat->nuclNameTrigramStart[qCodes[i]+1]; j++){
+				numShared[ndat->nuclNameTrigramPostings[j]] = 0;
+			}
+		}
+	}
+}
+
+void searchNuclides(const ndata *restrict ndat, search_state *restrict ss){
+	char nuclAStr[8], nuclElemName[32];
+	for(uint8_t i=0; i<ss->numSearchTok; i++){
+		uint8_t foundNucl = 0;
+		uint8_t len = (uint8_t)SDL_strlen(ss->searchTok[i]);
+		if(isdigit(ss->searchTok[i][0])){
+			//look for nuclide names starting with a digit (eg. 32Si)
+			for(uint8_t j=1; j<len; j++){
+				if(j>=7){
+					break;
+				}
+				if(ss->searchTok[i][j] == '-'){
+					memcpy(&nuclAStr,&ss->searchTok[i],(size_t)j);
+					nuclAStr[j] = '\0'; //terminate string at end
+					if((len > (j+1))&&((len-j+1)<32)){
+						memcpy(&nuclElemName,&(ss->searchTok[i][j+1]),(size_t)(len-j+1));
+						nuclElemName[len-j+1] = '\0'; //terminate string at end
+						foundNucl = 1;
+						break;
+					}
+				}else if(!(isdigit(ss->searchTok[i][j]))){
+					memcpy(&nuclAStr,&ss->searchTok[i],(size_t)j);
+					nuclAStr[j] = '\0'; //terminate string at end
+					if((len > j)&&((len-j)<32)){
+						memcpy(&nuclElemName,&(ss->searchTok[i][j]),(size_t)(len-j));
+						nuclElemName[len-j] = '\0'; //terminate string at end
+						foundNucl = 1;
+						break;
+					}
+				}
+			}
+			if(foundNucl == 0){
+				//try looking at the full string, for special cases
+				SDL_strlcpy(nuclElemName,ss->searchTok[i],31);
+				SDL_strlcpy(nuclAStr,"-1",7); //mark special case
+				//SDL_Log("Parsing special case: %s\n",ss->searchTok[i]);
+			}
+		}else if(isalpha(ss->searchTok[i][0])){
+			//look for nuclide names starting with a letter (eg. si32)
+			for(uint8_t j=1; j<len; j++){
+				if(j>=32){
+					break;
+				}
+				if(ss->searchTok[i][j] == '-'){
+					memcpy(&nuclElemName,&ss->searchTok[i],(size_t)j);
+					nuclElemName[j] = '\0'; //terminate string at end
+					if((len > (j+1))&&((len-j+1)<8)){
+						memcpy(&nuclAStr,&(ss->searchTok[i][j+1]),(size_t)(len-j+1));
+						nuclAStr[len-j+1] = '\0'; //terminate string at end
 						foundNucl = 1;
 						break;
 					}
@@ -870,92 +3454,57 @@ void searchNuclides(const ndata *restrict ndat, search_state *restrict ss){
 			nuclZu = (int16_t)elemStrToZ(nuclElemName);
 		}
 		if(nuclA >= 1){
-			for(int16_t j=0; j<ndat->numNucl; j++){
-				uint8_t nuclFound = 0;
-				if(nuclZ >= 0){
-					if(ndat->nuclData[j].Z == nuclZ){
-						if(((ndat->nuclData[j].N + ndat->nuclData[j].Z)) == nuclA){
-							if((ndat->nuclData[j].flags & 3U) == OBSFLAG_OBSERVED){
-								//identified nuclide (exact match)
-								nuclFound = 1;
-							}
-						}
-					}
-				}
-				if(nuclZu >= 0){
-					if((nuclZu != nuclZ)&&(ndat->nuclData[j].Z == nuclZu)){
-						if(((ndat->nuclData[j].N + ndat->nuclData[j].Z)) == nuclA){
-							if((ndat->nuclData[j].flags & 3U) == OBSFLAG_OBSERVED){
-								//identified nuclide (uppercase match)
-								nuclFound = 1;
-							}
-						}
-					}
+			for(uint8_t k=0; k<2; k++){
+				//exact match, then uppercase match
+				const int16_t Z = (k == 0) ? nuclZ : nuclZu;
+				if((Z < 0)||((k == 1)&&(nuclZu == nuclZ))){
+					continue;
 				}
-				if(nuclFound == 1){
+				const uint16_t nuclInd = getNuclInd(ndat,(int16_t)(nuclA - Z),Z);
+				if(nuclInd < ndat->numNucl){
+					//identified nuclide
 					search_result res;
 					res.relevance = 1.0f; //base value
 					res.resultType = SEARCHAGENT_NUCLIDE;
-					res.resultVal[0] = (uint32_t)j; //nuclide index
-					sortAndAppendResult(ss,&res);
-					ss->boostedNucl = (uint16_t)j;
+					res.resultVal[0] = (uint32_t)nuclInd; //nuclide index
+					res.resultVal[1] = 0;
+					appendSearchResult(ss,SEARCHAGENT_NUCLIDE,&res);
+					ss->boostedNucl = nuclInd;
 				}
 			}
 		}else if((nuclZ >= 0)||(nuclZu >= 0)){
 			//element only, no mass number specified
 			//rank isotopes by abundance, then half-life
-			for(int16_t j=0; j<ndat->numNucl; j++){
-				uint8_t nuclFound = 0;
-				if(nuclZ >= 0){
-					if(ndat->nuclData[j].Z == nuclZ){
-						if((ndat->nuclData[j].flags & 3U) == OBSFLAG_OBSERVED){
-							//identified nuclide (exact match)
-							nuclFound = 1;
-						}
-					}
-				}
-				if(nuclZu >= 0){
-					if((nuclZu != nuclZ)&&(ndat->nuclData[j].Z == nuclZu)){
-						if((ndat->nuclData[j].flags & 3U) == OBSFLAG_OBSERVED){
-							//identified nuclide (uppercase match)
-							nuclFound = 1;
-						}
-					}
+			for(uint8_t k=0; k<2; k++){
+				//exact match, then uppercase match
+				const int16_t Z = (k == 0) ? nuclZ : nuclZu;
+				if((Z < 0)||((k == 1)&&(nuclZu == nuclZ))){
+					continue;
 				}
-				if(nuclFound == 1){
-					search_result res;
-					res.relevance = 0.0f; //base value
-					float abundance = ndat->nuclData[j].abundance.val;
-					if(abundance > 0.0f){
-						res.relevance = 0.5f + 0.5f*(abundance/100.0f); //100% abundance gives relevance = 1
-					}else{
-						double gsHlFac = getNuclLevelHalfLifeSeconds(ndat,(uint16_t)j,ndat->nuclData[j].gsLevel);
-						if(gsHlFac <= 0.0){
-							res.relevance = 0.0f;
-						}else{
-							//SDL_Log("%i %i: %e\n",ndat->nuclData[j].Z,ndat->nuclData[j].N,gsHlFac);
-							gsHlFac = 100.0 + SDL_log(gsHlFac); //SDL_log (logarithm), not SDL_Log (printf equivalent)
-							if(gsHlFac > 130.0){
-								gsHlFac = 130.0;
-							}else if(gsHlFac < 0.0){
-								gsHlFac = 0.0;
-							}
-							gsHlFac /= 130.0;
-							res.relevance = (float)(0.5*gsHlFac);
-							//SDL_Log("%i %i: %e\n",ndat->nuclData[j].Z,ndat->nuclData[j].N,(double)res.relevance);
-						}
-						
+				for(int16_t N=0; N<MAX_NEUTRON_NUM; N++){
+					const uint16_t nuclInd = getNuclInd(ndat,N,Z);
+					if(nuclInd < ndat->numNucl){
+						//identified nuclide
+						search_result res;
+						res.relevance = getNuclProminence(ndat,nuclInd); //rank isotopes by abundance, then half-life
+						res.resultType = SEARCHAGENT_NUCLIDE;
+						res.resultVal[0] = (uint32_t)nuclInd; //nuclide index
+						res.resultVal[1] = 0;
+						appendSearchResult(ss,SEARCHAGENT_NUCLIDE,&res);
+						ss->boostedNucl = nuclInd;
 					}
-					res.resultType = SEARCHAGENT_NUCLIDE;
-					res.resultVal[0] = (uint32_t)j; //nuclide index
-					sortAndAppendResult(ss,&res);
-					ss->boostedNucl = (uint16_t)j;
 				}
 			}
 		}
 		
 	}
 
+	//suggestions for partial or misspelled names, after the exact matches
+	//so that those take precedence when results are de-duplicated
+	for(uint8_t i=0; i<ss->numSearchTok; i++){
+		searchNuclNamesFuzzy(ndat,ss,ss->searchTok[i]);
+	}
+
 	//SDL_Log("Number of search results: %u\n",ss->numUpdatedResults);
 }
 
@@ -996,3 +3545,827 @@ void searchSpecialStrings(search_state *restrict ss){
 
 	//SDL_Log("Number of search results: %u\n",ss->numUpdatedResults);
 }
+
+static int SDLCALL compareGammaIdxEntries(const void *a, const void *b){
+	gamma_index_entry *entA = ((gamma_index_entry*)(intptr_t)(a)); //get the index entry (double cast to avoid warning)
+	gamma_index_entry *entB = ((gamma_index_entry*)(intptr_t)(b)); //get the index entry (double cast to avoid warning)
+	if(entA->energy < entB->energy){
+		return -1;
+	}else if(entA->energy > entB->energy){
+		return 1;
+	}else if(entA->tranInd < entB->tranInd){
+		return -1; //keep database order for identical energies
+	}else if(entA->tranInd > entB->tranInd){
+		return 1;
+	}
+	return 0;
+}
+
+//builds the index of all transitions sorted by energy, so that
+//search agents can look up gammas in a given energy window
+//without scanning the entire database
+static void buildGammaIndex(ndata *nd){
+	nd->numGammaIdx = 0;
+	nd->gammaIdxMaxErrBound = 0.0f;
+	for(uint16_t i=0;i<nd->numNucl;i++){
+		for(uint32_t j=nd->nuclData[i].firstLevel; j<(nd->nuclData[i].firstLevel + (uint32_t)nd->nuclData[i].numLevels); j++){
+			for(uint32_t k=nd->levels[j].firstTran; k<(nd->levels[j].firstTran + (uint32_t)nd->levels[j].numTran); k++){
+				if((((nd->tran[k].energy.format >> 5U) & 15U)) != VALUETYPE_X){ //ignore variable energy
+					double rawEVal = getRawValFromDB(&nd->tran[k].energy);
+					if(rawEVal > 0.0){
+						const double errBound = getEnergyMatchErrBound(rawEVal,getRawErrFromDB(&nd->tran[k].energy));
+						if(nd->numGammaIdx >= MAXNUMTRAN){
+							SDL_LogWarn(SDL_LOG_CATEGORY_APPLICATION,"buildGammaIndex - too many transitions, index is incomplete.\n");
+							break;
+						}
+						gamma_index_entry *ent = &nd->gammaIdx[nd->numGammaIdx];
+						ent->energy = rawEVal;
+						ent->errBound = (float)errBound;
+						ent->tranInd = k;
+						ent->lvlInd = j;
+						ent->nuclInd = i;
+						if(ent->errBound > nd->gammaIdxMaxErrBound){
+							nd->gammaIdxMaxErrBound = ent->errBound;
+						}
+						nd->numGammaIdx++;
+					}
+				}
+			}
+		}
+	}
+	SDL_qsort(nd->gammaIdx,nd->numGammaIdx,sizeof(gamma_index_entry),compareGammaIdxEntries);
+}
+
+static int SDLCALL compareLvlIdxEntries(const void *a, const void *b){
+	level_index_entry *entA = ((level_index_entry*)(intptr_t)(a)); //get the index entry (double cast to avoid warning)
+	level_index_entry *entB = ((level_index_entry*)(intptr_t)(b)); //get the index entry (double cast to avoid warning)
+	if(entA->energy < entB->energy){
+		return -1;
+	}else if(entA->energy > entB->energy){
+		return 1;
+	}else if(entA->lvlInd < entB->lvlInd){
+		return -1; //keep database order for identical energies
+	}else if(entA->lvlInd > entB->lvlInd){
+		return 1;
+	}
+	return 0;
+}
+
+//builds the index of all levels sorted by energy, analogous to the gamma index
+static void buildLevelIndex(ndata *nd){
+	nd->numLvlIdx = 0;
+	nd->lvlIdxMaxErrBound = 0.0f;
+	for(uint16_t i=0;i<nd->numNucl;i++){
+		for(uint32_t j=nd->nuclData[i].firstLevel; j<(nd->nuclData[i].firstLevel + (uint32_t)nd->nuclData[i].numLevels); j++){
+			if((((nd->levels[j].energy.format >> 5U) & 15U)) == VALUETYPE_NUMBER){ //ignore variable energy
+				double rawEVal = getRawValFromDB(&nd->levels[j].energy);
+				if(rawEVal > 0.0){
+					const double errBound = getEnergyMatchErrBound(rawEVal,getRawErrFromDB(&nd->levels[j].energy));
+					if(nd->numLvlIdx >= MAXNUMLVLS){
+						SDL_LogWarn(SDL_LOG_CATEGORY_APPLICATION,"buildLevelIndex - too many levels, index is incomplete.\n");
+						break;
+					}
+					level_index_entry *ent = &nd->lvlIdx[nd->numLvlIdx];
+					ent->energy = rawEVal;
+					ent->errBound = (float)errBound;
+					ent->lvlInd = j;
+					ent->nuclInd = i;
+					if(ent->errBound > nd->lvlIdxMaxErrBound){
+						nd->lvlIdxMaxErrBound = ent->errBound;
+					}
+					nd->numLvlIdx++;
+				}
+			}
+		}
+	}
+	SDL_qsort(nd->lvlIdx,nd->numLvlIdx,sizeof(level_index_entry),compareLvlIdxEntries);
+}
+
+static int SDLCALL compareHlIdxEntries(const void *a, const void *b){
+	halflife_index_entry *entA = ((halflife_index_entry*)(intptr_t)(a)); //get the index entry (double cast to avoid warning)
+	halflife_index_entry *entB = ((halflife_index_entry*)(intptr_t)(b)); //get the index entry (double cast to avoid warning)
+	if(entA->hlSeconds < entB->hlSeconds){
+		return -1;
+	}else if(entA->hlSeconds > entB->hlSeconds){
+		return 1;
+	}else if(entA->lvlInd < entB->lvlInd){
+		return -1; //keep database order for identical half-lives
+	}else if(entA->lvlInd > entB->lvlInd){
+		return 1;
+	}
+	return 0;
+}
+
+//builds the index of all levels with known half-life, sorted by half-life in seconds
+//levels whose half-life has a very large error bound (or is not quoted in units of
+//time or width) can't be looked up by window, so they are stored unsorted after the
+//sorted entries and checked individually by the search agent
+static void buildHalfLifeIndex(ndata *nd){
+	nd->numHlIdx = 0;
+	nd->numHlIdxSorted = 0;
+	for(uint8_t pass=0; pass<2; pass++){
+		//first pass adds sortable entries, second pass adds the remaining ones
+		for(uint16_t i=0;i<nd->numNucl;i++){
+			for(uint32_t j=nd->nuclData[i].firstLevel; j<(nd->nuclData[i].firstLevel + (uint32_t)nd->nuclData[i].numLevels); j++){
+				uint8_t hlValueType = (uint8_t)((nd->levels[j].halfLife.format >> 5U) & 15U);
+				if((hlValueType == VALUETYPE_NUMBER)||(hlValueType == VALUETYPE_ASYMERROR)){
+					double rawHlVal = getRawValFromDB(&nd->levels[j].halfLife);
+					if(rawHlVal > 0.0){
+						const double errBound = getMatchErrBound(rawHlVal,getRawErrFromDB(&nd->levels[j].halfLife));
+						uint8_t hlUnit = (uint8_t)(nd->levels[j].halfLife.unit & 127U);
+						double hlSeconds = getHalfLifeSecondsFromVal(rawHlVal,hlUnit);
+						uint8_t sortable = 1;
+						if((hlUnit == VALUE_UNIT_STABLE)||(hlSeconds <= 0.0)||(errBound > rawHlVal*HLIDX_MAX_REL_ERRBOUND)){
+							sortable = 0;
+						}
+						if(sortable != (uint8_t)(1U - pass)){
+							continue;
+						}
+						if(nd->numHlIdx >= MAXNUMLVLS){
+							SDL_LogWarn(SDL_LOG_CATEGORY_APPLICATION,"buildHalfLifeIndex - too many levels, index is incomplete.\n");
+							break;
+						}
+						halflife_index_entry *ent = &nd->hlIdx[nd->numHlIdx];
+						ent->hlSeconds = hlSeconds;
+						ent->hlVal = rawHlVal;
+						ent->errBound = errBound;
+						ent->lvlInd = j;
+						ent->nuclInd = i;
+						ent->unit = hlUnit;
+						nd->numHlIdx++;
+					}
+				}
+			}
+		}
+		if(pass == 0){
+			nd->numHlIdxSorted = nd->numHlIdx;
+		}
+	}
+	SDL_qsort(nd->hlIdx,nd->numHlIdxSorted,sizeof(halflife_index_entry),compareHlIdxEntries);
+}
+
+static int SDLCALL compareNuclLvlIdxEntries(const void *a, const void *b){
+	nucl_level_index_entry *entA = ((nucl_level_index_entry*)(intptr_t)(a)); //get the index entry (double cast to avoid warning)
+	nucl_level_index_entry *entB = ((nucl_level_index_entry*)(intptr_t)(b)); //get the index entry (double cast to avoid warning)
+	if(entA->energy < entB->energy){
+		return -1;
+	}else if(entA->energy > entB->energy){
+		return 1;
+	}else if(entA->lvlInd < entB->lvlInd){
+		return -1; //keep database order for identical energies
+	}else if(entA->lvlInd > entB->lvlInd){
+		return 1;
+	}
+	return 0;
+}
+
+//builds the per-nuclide index of levels sorted by energy, used to look up
+//level energy differences without comparing every pair of levels
+static void buildNuclLevelIndex(ndata *nd){
+	for(uint16_t i=0;i<nd->numNucl;i++){
+		nd->numNuclLvlIdx[i] = 0;
+		nd->nuclLvlIdxMaxErr[i] = 0.0;
+		nucl_level_index_entry *nuclEnt = &nd->nuclLvlIdx[nd->nuclData[i].firstLevel];
+		for(uint32_t j=nd->nuclData[i].firstLevel; j<(nd->nuclData[i].firstLevel + (uint32_t)nd->nuclData[i].numLevels); j++){
+			if((((nd->levels[j].energy.format >> 5U) & 15U)) == VALUETYPE_NUMBER){ //ignore variable energy
+				nucl_level_index_entry *ent = &nuclEnt[nd->numNuclLvlIdx[i]];
+				ent->energy = getRawValFromDB(&nd->levels[j].energy);
+				ent->err = getRawErrFromDB(&nd->levels[j].energy);
+				ent->lvlInd = j;
+				if(ent->err > nd->nuclLvlIdxMaxErr[i]){
+					nd->nuclLvlIdxMaxErr[i] = ent->err;
+				}
+				nd->numNuclLvlIdx[i]++;
+			}
+		}
+		SDL_qsort(nuclEnt,nd->numNuclLvlIdx[i],sizeof(nucl_level_index_entry),compareNuclLvlIdxEntries);
+	}
+}
+
+static int SDLCALL compareCommentIdxTerms(void *userdata, const void *a, const void *b){
+	const comment_index_term *termA = ((const comment_index_term*)(intptr_t)(a)); //double cast to avoid warning
+	const comment_index_term *termB = ((const comment_index_term*)(intptr_t)(b));
+	const char *termBuf = (const char*)userdata;
+	return SDL_strcmp(&termBuf[termA->strPos],&termBuf[termB->strPos]);
+}
+
+//returns 1 if a word consists only of digits (numbers are not indexed, since
+//values are handled by the other search agents)
+static uint8_t isNumericCommentWord(const char *word){
+	for(uint8_t i=0; word[i]!='\0'; i++){
+		if(!isdigit(word[i])){
+			return 0;
+		}
+	}
+	return 1;
+}
+
+//looks up a word in the hash table used while building the comment text
+//index, adding it if it isn't there yet
+//returns the index of the word in nd->commentIdxTerms (in order of first
+//appearance), or MAX_UINT32_VAL if the index is full
+static uint32_t getCommentIdxBuildTermInd(ndata *nd, uint32_t *hashTable, const uint32_t hashTableSize, const char *word){
+	uint32_t hash = 2166136261U; //FNV-1a
+	for(uint8_t i=0; word[i]!='\0'; i++){
+		hash ^= (uint8_t)word[i];
+		hash *= 16777619U;
+	}
+	uint32_t slot = hash & (hashTableSize-1);
+	while(hashTable[slot] != 0){
+		const uint32_t termInd = hashTable[slot]-1;
+		if(SDL_strcmp(&nd->commentIdxTermBuf[nd->commentIdxTerms[termInd].strPos],word)==0){
+			return termInd;
+		}
+		slot = (slot + 1) & (hashTableSize-1);
+	}
+	//new word
+	const uint32_t len = (uint32_t)SDL_strlen(word);
+	if((nd->numCommentIdxTerms >= MAX_COMMENT_IDX_TERMS)||((nd->commentIdxTermBufLen + len + 1) > COMMENT_IDX_TERMBUFSIZE)){
+		return MAX_UINT32_VAL;
+	}
+	nd->commentIdxTerms[nd->numCommentIdxTerms].strPos = nd->commentIdxTermBufLen;
+	nd->commentIdxTerms[nd->numCommentIdxTerms].numDocs = 0;
+	nd->commentIdxTerms[nd->numCommentIdxTerms].postingsPos = MAX_UINT32_VAL;
+	SDL_strlcpy(&nd->commentIdxTermBuf[nd->commentIdxTermBufLen],word,len+1);
+	nd->commentIdxTermBufLen += len + 1;
+	hashTable[slot] = nd->numCommentIdxTerms + 1;
+	nd->numCommentIdxTerms++;
+	return nd->numCommentIdxTerms-1;
+}
+
+//builds the full-text index of level and transition ENSDF comments: the list
+//of comments, the alphabetically sorted list of words appearing in them, and
+//for each word the (compressed) list of comments containing it
+static int buildCommentIndex(ndata *nd){
+	char word[COMMENT_IDX_MAX_WORD_LEN];
+	nd->numCommentIdxDocs = 0;
+	nd->numCommentIdxTerms = 0;
+	nd->commentIdxTermBufLen = 0;
+	nd->commentIdxPostingsLen = 0;
+
+	//list all comments
+	for(uint16_t i=0;i<nd->numNucl;i++){
+		for(uint32_t j=nd->nuclData[i].firstLevel; j<(nd->nuclData[i].firstLevel + nd->nuclData[i].numLevels); j++){
+			for(uint8_t k=0; k<LCOMMENT_ENUM_LENGTH; k++){
+				if((nd->numCommentIdxDocs < MAX_COMMENT_IDX_DOCS)&&(getENSDFLvlCommentStrInd(nd,j,k) != MAX_UINT32_VAL)){
+					nd->commentIdxDocs[nd->numCommentIdxDocs].lvlInd = j;
+					nd->commentIdxDocs[nd->numCommentIdxDocs].tranInd = MAX_UINT32_VAL;
+					nd->commentIdxDocs[nd->numCommentIdxDocs].nuclInd = i;
+					nd->commentIdxDocs[nd->numCommentIdxDocs].commentType = k;
+					nd->numCommentIdxDocs++;
+				}
+			}
+			for(uint32_t l=nd->levels[j].firstTran; l<(nd->levels[j].firstTran + nd->levels[j].numTran); l++){
+				for(uint8_t k=0; k<TCOMMENT_ENUM_LENGTH; k++){
+					if((nd->numCommentIdxDocs < MAX_COMMENT_IDX_DOCS)&&(getENSDFTranCommentStrInd(nd,l,k) != MAX_UINT32_VAL)){
+						nd->commentIdxDocs[nd->numCommentIdxDocs].lvlInd = j;
+						nd->commentIdxDocs[nd->numCommentIdxDocs].tranInd = l;
+						nd->commentIdxDocs[nd->numCommentIdxDocs].nuclInd = i;
+						nd->commentIdxDocs[nd->numCommentIdxDocs].commentType = k;
+						nd->numCommentIdxDocs++;
+					}
+				}
+			}
+		}
+	}
+	if(nd->numCommentIdxDocs >= MAX_COMMENT_IDX_DOCS){
+		SDL_LogWarn(SDL_LOG_CATEGORY_APPLICATION,"buildCommentIndex - too many comments, some won't be searchable (increase MAX_COMMENT_IDX_DOCS).\n");
+	}
+
+	//allocated on heap to not overflow the stack
+	const uint32_t hashTableSize = 2*MAX_COMMENT_IDX_TERMS; //power of 2
+	uint32_t *hashTable=(uint32_t*)SDL_calloc(hashTableSize,sizeof(uint32_t));
+	uint32_t *lastDoc=(uint32_t*)SDL_calloc(MAX_COMMENT_IDX_TERMS,sizeof(uint32_t));
+	uint32_t *docListStart=(uint32_t*)SDL_calloc(MAX_COMMENT_IDX_TERMS+1,sizeof(uint32_t));
+	if((hashTable == NULL)||(lastDoc == NULL)||(docListStart == NULL)){
+		SDL_Log("ERROR: buildCommentIndex - couldn't allocate memory.\n");
+		SDL_free(hashTable);
+		SDL_free(lastDoc);
+		SDL_free(docListStart);
+		return -1;
+	}
+
+	//find all words, and count the comments containing each word
+	uint8_t termsFull = 0;
+	for(uint32_t i=0; i<nd->numCommentIdxDocs; i++){
+		const uint32_t strInd = getCommentIdxDocStrInd(nd,i);
+		uint32_t wordStart;
+		uint32_t pos = getNextCommentWord(nd->ensdfStrBuf,strInd,word,&wordStart);
+		while(pos > 0){
+			if(isNumericCommentWord(word)==0){
+				const uint32_t termInd = getCommentIdxBuildTermInd(nd,hashTable,hashTableSize,word);
+				if(termInd == MAX_UINT32_VAL){
+					termsFull = 1;
+				}else if(lastDoc[termInd] != (i+1)){
+					lastDoc[termInd] = i+1;
+					nd->commentIdxTerms[termInd].numDocs++;
+				}
+			}
+			pos = getNextCommentWord(nd->ensdfStrBuf,pos,word,&wordStart);
+		}
+	}
+	if(termsFull){
+		SDL_LogWarn(SDL_LOG_CATEGORY_APPLICATION,"buildCommentIndex - too many distinct words, some won't be searchable (increase MAX_COMMENT_IDX_TERMS or COMMENT_IDX_TERMBUFSIZE).\n");
+	}
+
+	//list the comments containing each word
+	for(uint32_t i=0; i<nd->numCommentIdxTerms; i++){
+		docListStart[i+1] = docListStart[i] + nd->commentIdxTerms[i].numDocs;
+		lastDoc[i] = 0;
+	}
+	uint32_t *docList=(uint32_t*)SDL_calloc(docListStart[nd->numCommentIdxTerms]+1,sizeof(uint32_t));
+	uint32_t *docListFill=(uint32_t*)SDL_calloc(MAX_COMMENT_IDX_TERMS,sizeof(uint32_t));
+	if((docList == NULL)||(docListFill == NULL)){
+		SDL_Log("ERROR: buildCommentIndex - couldn't allocate memory.\n");
+		SDL_free(hashTable);
+		SDL_free(lastDoc);
+		SDL_free(docListStart);
+		SDL_free(docList);
+		SDL_free(docListFill);
+		return -1;
+	}
+	for(uint32_t i=0; i<nd->numCommentIdxDocs; i++){
+		const uint32_t strInd = getCommentIdxDocStrInd(nd,i);
+		uint32_t wordStart;
+		uint32_t pos = getNextCommentWord(nd->ensdfStrBuf,strInd,word,&wordStart);
+		while(pos > 0){
+			if(isNumericCommentWord(word)==0){
+				const uint32_t termInd = getCommentIdxBuildTermInd(nd,hashTable,hashTableSize,word);
+				if((termInd != MAX_UINT32_VAL)&&(lastDoc[termInd] != (i+1))){
+					lastDoc[termInd] = i+1;
+					docList[docListStart[termInd] + docListFill[termInd]] = i;
+					docListFill[termInd]++;
+				}
+			}
+			pos = getNextCommentWord(nd->ensdfStrBuf,pos,word,&wordStart);
+		}
+	}
+
+	//sort words alphabetically (temporarily storing the original index of
+	//each word in postingsPos), then write the compressed postings lists
+	for(uint32_t i=0; i<nd->numCommentIdxTerms; i++){
+		nd->commentIdxTerms[i].postingsPos = i;
+	}
+	SDL_qsort_r(nd->commentIdxTerms,nd->numCommentIdxTerms,sizeof(comment_index_term),compareCommentIdxTerms,nd->commentIdxTermBuf);
+	uint8_t postingsFull = 0;
+	for(uint32_t i=0; i<nd->numCommentIdxTerms; i++){
+		const uint32_t origInd = nd->commentIdxTerms[i].postingsPos;
+		nd->commentIdxTerms[i].postingsPos = nd->commentIdxPostingsLen;
+		uint32_t prevDoc = 0;
+		for(uint32_t j=0; j<nd->commentIdxTerms[i].numDocs; j++){
+			if((nd->commentIdxPostingsLen + 5) > COMMENT_IDX_POSTINGSSIZE){
+				nd->commentIdxTerms[i].numDocs = j; //truncate list
+				postingsFull = 1;
+				break;
+			}
+			const uint32_t doc = docList[docListStart[origInd] + j];
+			uint32_t delta = doc - prevDoc;
+			prevDoc = doc;
+			while(delta >= 128){
+				nd->commentIdxPostings[nd->commentIdxPostingsLen] = (uint8_t)((delta & 127U) | 128U);
+				nd->commentIdxPostingsLen++;
+				delta >>= 7;
+			}
+			nd->commentIdxPostings[nd->commentIdxPostingsLen] = (uint8_t)delta;
+			nd->commentIdxPostingsLen++;
+		}
+	}
+	if(postingsFull){
+		SDL_LogWarn(SDL_LOG_CATEGORY_APPLICATION,"buildCommentIndex - postings buffer is full, some comments won't be searchable (increase COMMENT_IDX_POSTINGSSIZE).\n");
+	}
+
+	SDL_free(hashTable);
+	SDL_free(lastDoc);
+	SDL_free(docListStart);
+	SDL_free(docList);
+	SDL_free(docListFill);
+	return 0;
+}
+
+//builds the (energy, half-life) grid index, which sorts levels into cells of level
+//energy and log(half-life), for structured queries on level energy and half-life
+static void buildEHlGrid(ndata *nd){
+	uint32_t *cellFill = (uint32_t*)SDL_calloc(EHL_GRID_CELLS,sizeof(uint32_t));
+	if(cellFill == NULL){
+		SDL_Log("ERROR: buildEHlGrid - couldn't allocate memory.\n");
+		nd->numEHlGrid = 0;
+		return;
+	}
+	SDL_memset(nd->eHlGridStart,0,sizeof(nd->eHlGridStart));
+	nd->numEHlGrid = 0;
+
+	//count levels in each cell, then fill in the levels
+	for(uint8_t pass=0; pass<2; pass++){
+		for(uint16_t i=0;i<nd->numNucl;i++){
+			for(uint32_t j=nd->nuclData[i].firstLevel; j<(nd->nuclData[i].firstLevel + (uint32_t)nd->nuclData[i].numLevels); j++){
+				if((((nd->levels[j].energy.format >> 5U) & 15U)) != VALUETYPE_NUMBER){
+					continue; //ignore variable energy
+				}
+				if((nd->levels[j].halfLife.unit & 127U) == VALUE_UNIT_STABLE){
+					continue;
+				}
+				const double hlSeconds = getLevelHalfLifeSeconds(nd,j);
+				if(hlSeconds <= 0.0){
+					continue; //unknown half-life
+				}
+				const double energy = getRawValFromDB(&nd->levels[j].energy);
+				const uint32_t cell = (uint32_t)getEHlGridEBin(energy)*EHL_GRID_T_BINS + (uint32_t)getEHlGridTBin(hlSeconds);
+				if(pass == 0){
+					nd->eHlGridStart[cell+1]++;
+				}else{
+					nd->eHlGrid[nd->eHlGridStart[cell] + cellFill[cell]] = j;
+					cellFill[cell]++;
+				}
+			}
+		}
+		if(pass == 0){
+			for(uint32_t cell=0; cell<EHL_GRID_CELLS; cell++){
+				nd->eHlGridStart[cell+1] += nd->eHlGridStart[cell];
+			}
+			nd->numEHlGrid = nd->eHlGridStart[EHL_GRID_CELLS];
+		}
+	}
+	SDL_free(cellFill);
+}
+
+//builds the level and transition columns scanned by structured queries
+static void buildQueryColumns(ndata *nd){
+	for(uint16_t i=0;i<nd->numNucl;i++){
+		for(uint32_t j=nd->nuclData[i].firstLevel; j<(nd->nuclData[i].firstLevel + (uint32_t)nd->nuclData[i].numLevels); j++){
+			nd->qColLvlNucl[j] = i;
+			nd->qColLvlE[j] = NAN;
+			if((((nd->levels[j].energy.format >> 5U) & 15U)) == VALUETYPE_NUMBER){
+				nd->qColLvlE[j] = (float)getRawValFromDB(&nd->levels[j].energy);
+			}
+			nd->qColLvlLogHl[j] = NAN;
+			if((nd->levels[j].halfLife.unit & 127U) == VALUE_UNIT_STABLE){
+				nd->qColLvlLogHl[j] = INFINITY;
+			}else{
+				const double hlSeconds = getLevelHalfLifeSeconds(nd,j);
+				if(hlSeconds > 0.0){
+					nd->qColLvlLogHl[j] = (float)SDL_log10(hlSeconds);
+				}
+			}
+			nd->qColLvlTwoJ[j] = NAN;
+			nd->qColLvlPar[j] = NAN;
+			if(nd->levels[j].numSpinParVals > 0){
+				const uint32_t spvInd = nd->levels[j].firstSpinParVal;
+				const uint16_t twoJ = getSpinParValTwoJ(nd,j,spvInd);
+				if(twoJ != 65535U){
+					nd->qColLvlTwoJ[j] = (float)twoJ;
+				}
+				if(nd->spv[spvInd].parVal != 0){
+					nd->qColLvlPar[j] = (float)nd->spv[spvInd].parVal;
+				}
+			}
+			for(uint32_t k=nd->levels[j].firstTran; k<(nd->levels[j].firstTran + (uint32_t)nd->levels[j].numTran); k++){
+				nd->qColTranLvl[k] = j;
+				nd->qColTranE[k] = NAN;
+				if((((nd->tran[k].energy.format >> 5U) & 15U)) == VALUETYPE_NUMBER){
+					nd->qColTranE[k] = (float)getRawValFromDB(&nd->tran[k].energy);
+				}
+				nd->qColTranI[k] = NAN;
+				if(nd->tran[k].intensity.val > 0.0f){
+					nd->qColTranI[k] = (float)getRawValFromDB(&nd->tran[k].intensity);
+				}
+			}
+		}
+	}
+}
+
+//builds the grid used to look up nuclides by N and Z, and the map of the
+//nearest observed nuclide to each grid position (multi-source breadth-first
+//search over the grid, giving the nuclide with the smallest |dN|+|dZ|)
+static int buildNuclIndGrid(ndata *nd){
+	nd->nuclIndGridBuilt = 0;
+	for(uint16_t i=0;i<MAX_PROTON_NUM;i++){
+		for(uint16_t j=0;j<MAX_NEUTRON_NUM;j++){
+			nd->nuclIndByNZ[i][j] = MAXNUMNUCL;
+			nd->nearestNuclIndByNZ[i][j] = MAXNUMNUCL;
+		}
+	}
+	uint16_t *queue=(uint16_t*)SDL_calloc(MAX_PROTON_NUM*MAX_NEUTRON_NUM,sizeof(uint16_t)); //allocated on heap to not overflow the stack
+	if(queue == NULL){
+		SDL_Log("ERROR: buildNuclIndGrid - couldn't allocate memory.\n");
+		return -1;
+	}
+	uint32_t queueLen = 0;
+	for(uint16_t i=0;i<nd->numNucl;i++){
+		if((nd->nuclData[i].flags & 3U) == OBSFLAG_OBSERVED){
+			const int16_t Z = nd->nuclData[i].Z;
+			const int16_t N = nd->nuclData[i].N;
+			if((Z >= 0)&&(Z < MAX_PROTON_NUM)&&(N >= 0)&&(N < MAX_NEUTRON_NUM)){
+				if(nd->nuclIndByNZ[Z][N] == MAXNUMNUCL){ //use the first matching nuclide, same as a linear search
+					nd->nuclIndByNZ[Z][N] = i;
+					nd->nearestNuclIndByNZ[Z][N] = i;
+					queue[queueLen] = (uint16_t)(Z*MAX_NEUTRON_NUM + N);
+					queueLen++;
+				}
+			}
+		}
+	}
+	//spread outwards from the observed nuclides
+	const int16_t dZ[4] = {1,-1,0,0};
+	const int16_t dN[4] = {0,0,1,-1};
+	for(uint32_t q=0; q<queueLen; q++){
+		const int16_t Z = (int16_t)(queue[q]/MAX_NEUTRON_NUM);
+		const int16_t N = (int16_t)(queue[q] - Z*MAX_NEUTRON_NUM);
+		for(uint8_t k=0; k<4; k++){
+			const int16_t Z2 = (int16_t)(Z + dZ[k]);
+			const int16_t N2 = (int16_t)(N + dN[k]);
+			if((Z2 >= 0)&&(Z2 < MAX_PROTON_NUM)&&(N2 >= 0)&&(N2 < MAX_NEUTRON_NUM)){
+				if(nd->nearestNuclIndByNZ[Z2][N2] == MAXNUMNUCL){
+					nd->nearestNuclIndByNZ[Z2][N2] = nd->nearestNuclIndByNZ[Z][N];
+					queue[queueLen] = (uint16_t)(Z2*MAX_NEUTRON_NUM + N2);
+					queueLen++;
+				}
+			}
+		}
+	}
+	SDL_free(queue);
+	nd->nuclIndGridBuilt = 1;
+	return 0;
+}
+
+//adds a spelling of a nuclide or isomer name to the nuclide name index,
+//skipping spellings already added for the same nuclide/isomer
+static void appendNuclNameIdxEntry(ndata *nd, const char *nameStr, const uint16_t nuclInd, const uint32_t lvlInd){
+	if(nd->numNuclNameIdx >= MAX_NUCL_NAME_IDX_ENTRIES){
+		return;
+	}
+	nucl_name_index_entry *entry = &nd->nuclNameIdx[nd->numNuclNameIdx];
+	entry->len = getNuclNameIdxKey(entry->name,nameStr);
+	if(entry->len == 0){
+		return;
+	}
+	for(uint16_t i=nd->numNuclNameIdx; i>0; i--){
+		if((nd->nuclNameIdx[i-1].nuclInd != nuclInd)||(nd->nuclNameIdx[i-1].lvlInd != lvlInd)){
+			break;
+		}
+		if(SDL_strcmp(nd->nuclNameIdx[i-1].name,entry->name)==0){
+			return; //duplicate spelling
+		}
+	}
+	entry->nuclInd = nuclInd;
+	entry->lvlInd = lvlInd;
+	nd->numNuclNameIdx++;
+}
+
+//builds the index of nuclide name spellings (canonical '178m2Hf', symbol
+//first 'Hf178m2', and element name 'Hafnium178' forms), and the trigram
+//postings used to find candidate names for the fuzzy nuclide name search
+static int buildNuclNameIndex(ndata *nd){
+	char nameStr[32], canonStr[32];
+	nd->numNuclNameIdx = 0;
+	for(uint16_t i=0;i<nd->numNucl;i++){
+		if((nd->nuclData[i].flags & 3U) != OBSFLAG_OBSERVED){
+			continue;
+		}
+		const uint16_t A = (uint16_t)(nd->nuclData[i].Z + nd->nuclData[i].N);
+		const char *elemStr = getElemStr((uint8_t)(nd->nuclData[i].Z));
+		//ground state
+		getNuclNameStrASCII(canonStr,&nd->nuclData[i],255);
+		appendNuclNameIdxEntry(nd,canonStr,i,MAXNUMLVLS);
+		SDL_snprintf(nameStr,32,"%s%u",elemStr,A);
+		appendNuclNameIdxEntry(nd,nameStr,i,MAXNUMLVLS);
+		SDL_snprintf(nameStr,32,"%s%u",getFullElemStr((uint8_t)(nd->nuclData[i].Z),(uint8_t)(nd->nuclData[i].N)),A);
+		appendNuclNameIdxEntry(nd,nameStr,i,MAXNUMLVLS);
+		//isomers
+		for(uint32_t j=nd->nuclData[i].firstLevel; j<(nd->nuclData[i].firstLevel + nd->nuclData[i].numLevels); j++){
+			const uint8_t mVal = (uint8_t)((nd->levels[j].format >> 5U) & 7U);
+			if(mVal > 0){
+				const uint8_t dispMVal = (nd->nuclData[i].numIsomerMVals > 1) ? mVal : 0;
+				getNuclNameStrASCII(canonStr,&nd->nuclData[i],dispMVal);
+				appendNuclNameIdxEntry(nd,canonStr,i,j);
+				if(dispMVal > 0){
+					SDL_snprintf(nameStr,32,"%s%um%u",elemStr,A,dispMVal);
+				}else{
+					SDL_snprintf(nameStr,32,"%s%um",elemStr,A);
+				}
+				appendNuclNameIdxEntry(nd,nameStr,i,j);
+			}
+		}
+	}
+	if(nd->numNuclNameIdx >= MAX_NUCL_NAME_IDX_ENTRIES){
+		SDL_LogWarn(SDL_LOG_CATEGORY_APPLICATION,"buildNuclNameIndex - nuclide name index is full, some names won't be searchable (increase MAX_NUCL_NAME_IDX_ENTRIES).\n");
+	}
+
+	//count the names containing each trigram
+	SDL_memset(nd->nuclNameTrigramStart,0,sizeof(nd->nuclNameTrigramStart));
+	uint32_t trigramCodes[NUCL_NAME_IDX_STR_LEN]; //distinct trigrams in the current name
+	uint32_t *fillPos=(uint32_t*)SDL_calloc(NUCL_NAME_TRIGRAM_CODES,sizeof(uint32_t)); //allocated on heap to not overflow the stack
+	if(fillPos == NULL){
+		SDL_Log("ERROR: buildNuclNameIndex - couldn't allocate memory.\n");
+		return -1;
+	}
+	for(uint16_t i=0;i<nd->numNuclNameIdx;i++){
+		uint8_t numCodes = 0;
+		for(uint8_t j=0;j<nd->nuclNameIdx[i].len;j++){
+			const uint32_t code = getNuclNameTrigramCode(nd->nuclNameIdx[i].name,j);
+			uint8_t dup = 0;
+			for(uint8_t k=0;k<numCodes;k++){
+				if(trigramCodes[k] == code){
+					dup = 1;
+					break;
+				}
+			}
+			if(dup == 0){
+				trigramCodes[numCodes] = code;
+				numCodes++;
+				nd->nuclNameTrigramStart[code+1]++;
+			}
+		}
+	}
+	for(uint32_t i=0;i<NUCL_NAME_TRIGRAM_CODES;i++){
+		nd->nuclNameTrigramStart[i+1] += nd->nuclNameTrigramStart[i];
+		fillPos[i] = nd->nuclNameTrigramStart[i];
+	}
+	//fill postings (names are visited in order, so each postings list is sorted)
+	for(uint16_t i=0;i<nd->numNuclNameIdx;i++){
+		uint8_t numCodes = 0;
+		for(uint8_t j=0;j<nd->nuclNameIdx[i].len;j++){
+			const uint32_t code = getNuclNameTrigramCode(nd->nuclNameIdx[i].name,j);
+			uint8_t dup = 0;
+			for(uint8_t k=0;k<numCodes;k++){
+				if(trigramCodes[k] == code){
+					dup = 1;
+					break;
+				}
+			}
+			if(dup == 0){
+				trigramCodes[numCodes] = code;
+				numCodes++;
+				nd->nuclNameTrigramPostings[fillPos[code]] = i;
+				fillPos[code]++;
+			}
+		}
+	}
+	SDL_free(fillPos);
+	return 0;
+}
+
+static int SDLCALL compareRxnCatalogueKeys(void *userdata, const void *a, const void *b){
+	const char (*keys)[RXN_CATALOGUE_KEY_LEN] = (const char (*)[RXN_CATALOGUE_KEY_LEN])userdata;
+	uint16_t rxnA = *((const uint16_t*)(a));
+	uint16_t rxnB = *((const uint16_t*)(b));
+	int cmp = SDL_strcmp(keys[rxnA],keys[rxnB]);
+	if(cmp != 0){
+		return cmp;
+	}
+	//reactions are stored in order of nuclide index, preserve this
+	if(rxnA < rxnB){
+		return -1;
+	}else if(rxnA > rxnB){
+		return 1;
+	}
+	return 0;
+}
+
+//builds the reaction catalogue, which lists the nuclides populated by each
+//canonical reaction type (eg. all (p,g) reactions, regardless of target)
+static int buildRxnCatalogue(ndata *nd){
+
+	nd->numRxnCatalogueTypes = 0;
+	nd->numRxnCatalogueEntries = 0;
+	if(nd->numNucl <= 0){
+		return 0;
+	}
+
+	char (*keys)[RXN_CATALOGUE_KEY_LEN] = (char (*)[RXN_CATALOGUE_KEY_LEN])SDL_calloc(MAXNUMREACTIONS,RXN_CATALOGUE_KEY_LEN);
+	uint16_t *rxnNucl = (uint16_t*)SDL_calloc(MAXNUMREACTIONS,sizeof(uint16_t));
+	uint16_t *sortedRxns = (uint16_t*)SDL_calloc(MAXNUMREACTIONS,sizeof(uint16_t));
+	if((keys == NULL)||(rxnNucl == NULL)||(sortedRxns == NULL)){
+		SDL_Log("ERROR: buildRxnCatalogue - couldn't allocate memory.\n");
+		SDL_free(keys);
+		SDL_free(rxnNucl);
+		SDL_free(sortedRxns);
+		return -1;
+	}
+
+	//get the canonical reaction type of each reaction
+	uint16_t numSortedRxns = 0;
+	char target[RXN_CATALOGUE_TARGET_LEN];
+	for(uint16_t i=0; i<(uint16_t)nd->numNucl; i++){
+		for(uint8_t j=0; j<nd->nuclData[i].numRxns; j++){
+			const uint16_t rxnInd = (uint16_t)(nd->nuclData[i].firstRxn + j);
+			if((j >= 64)||(rxnInd >= nd->numRxns)){
+				break; //levels can only be filtered on the first 64 reactions
+			}
+			if(getRxnCatalogueKey(keys[rxnInd],target,&nd->ensdfStrBuf[nd->rxn[rxnInd].rxnStrBufStartPos]) > 0){
+				rxnNucl[rxnInd] = i;
+				sortedRxns[numSortedRxns] = rxnInd;
+				numSortedRxns++;
+			}
+		}
+	}
+	SDL_qsort_r(sortedRxns,numSortedRxns,sizeof(uint16_t),compareRxnCatalogueKeys,keys);
+
+	//group reactions by type
+	for(uint16_t i=0; i<numSortedRxns; i++){
+		const uint16_t rxnInd = sortedRxns[i];
+		if((nd->numRxnCatalogueTypes == 0)||(SDL_strcmp(keys[rxnInd],nd->rxnCatalogueTypes[nd->numRxnCatalogueTypes-1].key)!=0)){
+			if(nd->numRxnCatalogueTypes >= MAX_RXN_CATALOGUE_TYPES){
+				SDL_LogWarn(SDL_LOG_CATEGORY_APPLICATION,"buildRxnCatalogue - too many reaction types, some won't be searchable (increase MAX_RXN_CATALOGUE_TYPES).\n");
+				break;
+			}
+			rxn_catalogue_type *type = &nd->rxnCatalogueTypes[nd->numRxnCatalogueTypes];
+			SDL_strlcpy(type->key,keys[rxnInd],RXN_CATALOGUE_KEY_LEN);
+			type->firstEntry = nd->numRxnCatalogueEntries;
+			type->numEntries = 0;
+			nd->numRxnCatalogueTypes++;
+		}
+		rxn_catalogue_entry *ent = &nd->rxnCatalogueEntries[nd->numRxnCatalogueEntries];
+		ent->nuclInd = rxnNucl[rxnInd];
+		ent->rxnLocalInd = (uint8_t)(rxnInd - nd->nuclData[rxnNucl[rxnInd]].firstRxn);
+		nd->numRxnCatalogueEntries++;
+		nd->rxnCatalogueTypes[nd->numRxnCatalogueTypes-1].numEntries++;
+	}
+
+	SDL_free(keys);
+	SDL_free(rxnNucl);
+	SDL_free(sortedRxns);
+	return 0;
+}
+
+//checks whether a spin-parity index key was already used by an earlier
+//spin-parity value of the same level
+static uint8_t isSpinParIdxKeyRepeated(const ndata *nd, const uint32_t lvlInd, const uint8_t spvNum, const uint16_t key){
+	for(uint8_t i=0; i<spvNum; i++){
+		const uint32_t spvInd = nd->levels[lvlInd].firstSpinParVal + (uint32_t)i;
+		const uint16_t twoJ = getSpinParValTwoJ(nd,lvlInd,spvInd);
+		if((twoJ <= SPIDX_MAX_TWOJ)&&(getSpinParIdxKey(twoJ,nd->spv[spvInd].parVal) == key)){
+			return 1;
+		}
+	}
+	return 0;
+}
+
+//builds the spin-parity index, which lists the levels having each (2J, parity)
+//combination, for the spin-parity search agent
+static void buildSpinParIndex(ndata *nd){
+	uint32_t keyFill[SPIDX_NUM_KEYS];
+	SDL_memset(nd->spIdxStart,0,sizeof(nd->spIdxStart));
+	SDL_memset(keyFill,0,sizeof(keyFill));
+	nd->numSpIdx = 0;
+
+	//count levels for each key, then fill in the levels
+	for(uint8_t pass=0; pass<2; pass++){
+		for(uint16_t i=0;i<nd->numNucl;i++){
+			for(uint32_t j=nd->nuclData[i].firstLevel; j<(nd->nuclData[i].firstLevel + (uint32_t)nd->nuclData[i].numLevels); j++){
+				for(uint8_t k=0; k<nd->levels[j].numSpinParVals; k++){
+					const uint32_t spvInd = nd->levels[j].firstSpinParVal + (uint32_t)k;
+					const uint16_t twoJ = getSpinParValTwoJ(nd,j,spvInd);
+					if(twoJ > SPIDX_MAX_TWOJ){
+						continue;
+					}
+					const uint16_t key = getSpinParIdxKey(twoJ,nd->spv[spvInd].parVal);
+					if(isSpinParIdxKeyRepeated(nd,j,k,key)){
+						continue; //only list each level once per key
+					}
+					if(pass == 0){
+						nd->spIdxStart[key+1]++;
+					}else{
+						spinpar_index_entry *ent = &nd->spIdx[nd->spIdxStart[key] + keyFill[key]];
+						ent->lvlInd = j;
+						ent->nuclInd = i;
+						ent->tentative = (uint8_t)((nd->spv[spvInd].format >> 10U) & 15U);
+						keyFill[key]++;
+					}
+				}
+			}
+		}
+		if(pass == 0){
+			for(uint16_t key=0; key<SPIDX_NUM_KEYS; key++){
+				nd->spIdxStart[key+1] += nd->spIdxStart[key];
+			}
+			nd->numSpIdx = nd->spIdxStart[SPIDX_NUM_KEYS];
+		}
+	}
+}
+
+//builds the indices used by the search agents, which are derived from the rest of the
+//nuclear data rather than stored in the app data file (must be called once the data is loaded)
+void buildSearchIndices(ndata *nd){
+	const uint64_t startTime = SDL_GetTicksNS();
+	buildNuclIndGrid(nd); //nuclides are looked up without the grid if it can't be built
+	if(buildNuclNameIndex(nd) == -1){
+		nd->numNuclNameIdx = 0;
+		SDL_memset(nd->nuclNameTrigramStart,0,sizeof(nd->nuclNameTrigramStart)); //fuzzy nuclide name search is disabled
+	}
+	if(buildRxnCatalogue(nd) == -1){
+		nd->numRxnCatalogueTypes = 0;
+		nd->numRxnCatalogueEntries = 0; //reaction search is disabled
+	}
+	buildSpinParIndex(nd);
+	buildGammaIndex(nd);
+	buildLevelIndex(nd);
+	buildHalfLifeIndex(nd);
+	buildNuclLevelIndex(nd);
+	buildEHlGrid(nd);
+	buildQueryColumns(nd);
+	if(buildCommentIndex(nd) == -1){
+		nd->numCommentIdxDocs = 0;
+		nd->numCommentIdxTerms = 0; //comment search is disabled
+	}
+	SDL_Log("Built search indices in %0.1f ms (%u nuclide names, %u reaction types, %u spin-parities, %u gammas, %u levels, %u half-lives, %u comments with %u words).\n",(double)(SDL_GetTicksNS() - startTime)/1.0E6,nd->numNuclNameIdx,nd->numRxnCatalogueTypes,nd->numSpIdx,nd->numGammaIdx,nd->numLvlIdx,nd->numHlIdx,nd->numCommentIdxDocs,nd->numCommentIdxTerms);
+}
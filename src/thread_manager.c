@@ -21,110 +21,264 @@ along with this program.  If not, see <https://www.gnu.org/licenses/>.
 #include "data_ops.h"
 #include "search_ops.h"
 
+//returns the bit pattern of search agents which must finish before a search agent can run
+static uint32_t getSearchAgentDependencies(const uint8_t agent){
+  switch(agent){
+    case SEARCHAGENT_TOKENIZE:
+      return 0;
+    case SEARCHAGENT_PARSESPECIALSTRS:
+      return (uint32_t)(1U << SEARCHAGENT_TOKENIZE);
+    case SEARCHAGENT_NUCLIDE:
+      return (uint32_t)(1U << SEARCHAGENT_PARSESPECIALSTRS); //special strings determine which results are boosted
+    default:
+      //nuclide names (and special strings) determine which results the other agents boost
+      return (uint32_t)(1U << SEARCHAGENT_NUCLIDE);
+  }
+}
+
+//returns the bit pattern of the search thread results (ss.threadResults) written by a thread
+static uint32_t getThreadResultsWritten(const thread_data *tdat){
+  switch(tdat->threadPar){
+    case SEARCHAGENT_TOKENIZE:
+    case SEARCHAGENT_PARSESPECIALSTRS:
+      return 0; //no results
+    default:
+      return (uint32_t)(1U << getSearchResultHeapInd(tdat->threadPar,tdat->threadSubPar));
+  }
+}
+
+//returns the number of chunks of the data (ss.chunk) that a search agent is split across
+static uint8_t getNumSearchAgentChunks(const uint8_t agent){
+  switch(agent){
+    case SEARCHAGENT_ELEVELDIFF:
+    case SEARCHAGENT_GAMMACASCADE:
+      return NUM_SEARCH_CHUNKS; //slowest agents
+    default:
+      return 1;
+  }
+}
+
+//runs a search agent, as specified by the task parameters of a thread
+static void runSearchTask(thread_data *tdat){
+  //SDL_Log("Running search with agent %u.\n",tdat->threadPar);
+  //SDL_Log("Query: %s\n",tdat->state->ss.ctx.searchString);
+  switch(tdat->threadPar){
+    case SEARCHAGENT_TOKENIZE:
+      tokenizeSearchStr(&tdat->state->ss);
+      break;
+    case SEARCHAGENT_PARSESPECIALSTRS:
+      //SDL_Log("Searching for special strings...\n");
+      searchSpecialStrings(&tdat->state->ss);
+      break;
+    case SEARCHAGENT_NUCLIDE:
+      //SDL_Log("Searching for nuclides...\n");
+      if(tdat->state->ss.ctx.searchInProgress != SEARCHSTATE_SEARCHING_SINGLENUCL){
+        searchNuclides(&tdat->dat->ndat,&tdat->state->ss);
+      }
+      break;
+    case SEARCHAGENT_EGAMMA:
+      //SDL_Log("Searching for transitions...\n");
+      searchEGamma(&tdat->dat->ndat,&tdat->state->ss.ctx,&tdat->state->ss);
+      break;
+    case SEARCHAGENT_ELEVEL:
+      //SDL_Log("Searching for levels...\n");
+      searchELevel(&tdat->dat->ndat,&tdat->state->ss.ctx,&tdat->state->ss);
+      break;
+    case SEARCHAGENT_ELEVELDIFF:
+      //SDL_Log("Searching for level energy differences (chunk %u)...\n",tdat->threadSubPar);
+      searchELevelDiff(&tdat->dat->ndat,&tdat->state->ss.ctx,&tdat->state->ss,tdat->threadSubPar);
+      break;
+    case SEARCHAGENT_GAMMACASCADE:
+      //SDL_Log("Searching for gamma cascades...\n");
+      searchGammaCascade(&tdat->dat->ndat,&tdat->state->ss.ctx,&tdat->state->ss,tdat->threadSubPar);
+      break;
+    case SEARCHAGENT_HALFLIFE:
+      //SDL_Log("Searching for half-lives...\n");
+      searchHalfLife(&tdat->dat->ndat,&tdat->state->ss.ctx,&tdat->state->ss);
+      break;
+    case SEARCHAGENT_COMMENT:
+      //SDL_Log("Searching for comments...\n");
+      searchComments(&tdat->dat->ndat,&tdat->state->ss.ctx,&tdat->state->ss);
+      break;
+    case SEARCHAGENT_REACTION:
+      //SDL_Log("Searching for reactions...\n");
+      searchReactions(&tdat->dat->ndat,&tdat->state->ss.ctx,&tdat->state->ss);
+      break;
+    case SEARCHAGENT_SPINPAR:
+      //SDL_Log("Searching for spin-parity values...\n");
+      searchSpinParity(&tdat->dat->ndat,&tdat->state->ss.ctx,&tdat->state->ss);
+      break;
+    case SEARCHAGENT_QUERY:
+      //SDL_Log("Searching for structured query matches...\n");
+      searchQuery(&tdat->dat->ndat,&tdat->state->ss.ctx,&tdat->state->ss);
+      break;
+    default:
+      break;
+  }
+  const uint32_t resultsWritten = getThreadResultsWritten(tdat);
+  if((resultsWritten != 0)&&(!isSearchCancelled(&tdat->state->ss))){
+    publishSearchResults(&tdat->state->ss,resultsWritten); //show results found so far
+  }
+}
+
+//returns the index of the highest priority queued task whose dependencies have all finished
+//(the first one queued, if there are several), -1 if there is none
+//(call with the queue locked)
+static int getRunnableTask(const thread_task_queue *queue){
+  int taskInd = -1;
+  for(uint8_t i=0; i<queue->numTasks; i++){
+    if((queue->task[i].taskType == THREADTASK_SEARCH)&&(queue->numStaleSearchTasks > 0)){
+      continue; //wait for the tasks of cancelled searches to stop, since they share the search state
+    }
+    if((queue->task[i].dependencies & ~(queue->finishedTasks)) == 0){
+      if((taskInd < 0)||(queue->task[i].priority < queue->task[taskInd].priority)){
+        taskInd = i;
+      }
+    }
+  }
+  return taskInd;
+}
+
 //monolithic callback function for threads in the pool
+//threads sleep until a task is runnable, and run runnable tasks in order of priority
 int tpFunc(void *data){
   thread_data *tdat = ((thread_data*)(intptr_t)(data)); //get the thread data (double cast to avoid warning)
+  thread_task_queue *queue = tdat->queue;
   //printf("Initialized thread %u.\n",tdat->threadNum);
 
   //main loop for the thread
+  SDL_LockMutex(queue->lock);
   while(tdat->threadState != THREADSTATE_KILL){
-    SDL_Delay(THREAD_UPDATE_DELAY);
-    switch(tdat->threadState){
-      case THREADSTATE_SEARCH:
-        //run a search agent
-        //SDL_Log("Running search with agent %u.\n",tdat->threadPar);
-        //SDL_Log("Query: %s\n",tdat->state->ss.searchString);
-        switch(tdat->threadPar){
-          case SEARCHAGENT_TOKENIZE:
-            if(!(tdat->state->ss.finishedSearchAgents & (uint32_t)(1U << SEARCHAGENT_TOKENIZE))){
-              tokenizeSearchStr(&tdat->state->ss);
-              tdat->state->ss.finishedSearchAgents |= (uint32_t)(1U << SEARCHAGENT_TOKENIZE); //flag search agent as finished
-            }
-            break;
-          case SEARCHAGENT_PARSESPECIALSTRS:
-            while(!(tdat->state->ss.finishedSearchAgents & (uint32_t)(1U << SEARCHAGENT_TOKENIZE))){
-              if(tdat->threadState == THREADSTATE_KILL){
-                break; //kill waiting thread, if requested
-              }
-              SDL_Delay(THREAD_UPDATE_DELAY); //wait for tokenization to complete
-            }
-            //SDL_Log("Searching for special strings...\n");
-            searchSpecialStrings(&tdat->state->ss);
-            if(tdat->state->ss.searchInProgress != SEARCHSTATE_SEARCHING_SINGLENUCL){
-              searchNuclides(&tdat->dat->ndat,&tdat->state->ss);
-            }
-            tdat->state->ss.finishedSearchAgents |= (uint32_t)(1U << SEARCHAGENT_PARSESPECIALSTRS); //flag search agent as finished
-            tdat->state->ss.finishedSearchAgents |= (uint32_t)(1U << SEARCHAGENT_NUCLIDE); //flag search agent as finished
-            break;
-          case SEARCHAGENT_EGAMMA:
-            while(!(tdat->state->ss.finishedSearchAgents & (uint32_t)(1U << SEARCHAGENT_NUCLIDE))){
-              if(tdat->threadState == THREADSTATE_KILL){
-                break; //kill waiting thread, if requested
-              }
-              SDL_Delay(THREAD_UPDATE_DELAY); //wait for tokenization to complete
-            }
-            //SDL_Log("Searching for transitions...\n");
-            searchEGamma(&tdat->dat->ndat,tdat->state,&tdat->state->ss);
-            break;
-          case SEARCHAGENT_ELEVEL:
-            while(!(tdat->state->ss.finishedSearchAgents & (uint32_t)(1U << SEARCHAGENT_NUCLIDE))){
-              if(tdat->threadState == THREADSTATE_KILL){
-                break; //kill waiting thread, if requested
-              }
-              SDL_Delay(THREAD_UPDATE_DELAY); //wait for tokenization to complete
-            }
-            //SDL_Log("Searching for levels...\n");
-            searchELevel(&tdat->dat->ndat,tdat->state,&tdat->state->ss);
-            break;
-          case SEARCHAGENT_ELEVELDIFF:
-            while(!(tdat->state->ss.finishedSearchAgents & (uint32_t)(1U << SEARCHAGENT_NUCLIDE))){
-              if(tdat->threadState == THREADSTATE_KILL){
-                break; //kill waiting thread, if requested
-              }
-              SDL_Delay(THREAD_UPDATE_DELAY); //wait for tokenization to complete
-            }
-            if(tdat->state->ss.boostedResultType == SEARCHAGENT_ELEVELDIFF){
-              //use this thread (alongside other threads) to do a search of level energy differences
-              searchELevelDiff(&tdat->dat->ndat,tdat->state,&tdat->state->ss);
-            }
-            break;
-          case SEARCHAGENT_GAMMACASCADE:
-            while(!(tdat->state->ss.finishedSearchAgents & (uint32_t)(1U << SEARCHAGENT_NUCLIDE))){
-              if(tdat->threadState == THREADSTATE_KILL){
-                break; //kill waiting thread, if requested
-              }
-              SDL_Delay(THREAD_UPDATE_DELAY); //wait for tokenization to complete
-            }
-            //SDL_Log("Searching for gamma cascades...\n");
-            searchGammaCascade(&tdat->dat->ndat,tdat->state,&tdat->state->ss);
-            break;
-          case SEARCHAGENT_HALFLIFE:
-            while(!(tdat->state->ss.finishedSearchAgents & (uint32_t)(1U << SEARCHAGENT_NUCLIDE))){
-              if(tdat->threadState == THREADSTATE_KILL){
-                break; //kill waiting thread, if requested
-              }
-              SDL_Delay(THREAD_UPDATE_DELAY); //wait for tokenization to complete
-            }
-            //SDL_Log("Searching for half-lives...\n");
-            searchHalfLife(&tdat->dat->ndat,tdat->state,&tdat->state->ss);
-            break;
-          default:
-            break;
-        }
-        tdat->threadState = THREADSTATE_IDLE; //fdone searching (idle threads will eventually be killed)
+    const int taskInd = getRunnableTask(queue);
+    if(taskInd < 0){
+      SDL_WaitCondition(queue->taskQueued,queue->lock); //sleep until there is something to do
+      continue;
+    }
+    //take the task from the queue
+    const thread_task task = queue->task[taskInd];
+    memmove(&queue->task[taskInd],&queue->task[taskInd+1],(size_t)(queue->numTasks - taskInd - 1)*sizeof(thread_task));
+    queue->numTasks--;
+    tdat->threadPar = task.threadPar;
+    tdat->threadSubPar = task.threadSubPar;
+    if(task.taskType == THREADTASK_SEARCH){
+      if(task.threadPar == SEARCHAGENT_TOKENIZE){
+        startSearchTasks(&tdat->state->ss); //first task of the search, all others depend on it
+      }
+      queue->taskStartTime[task.taskNum] = SDL_GetTicksNS() - queue->batchStartTime;
+      tdat->threadState = THREADSTATE_SEARCH;
+    }else{
+      tdat->threadState = THREADSTATE_BACKGROUNDTASK;
+    }
+    SDL_UnlockMutex(queue->lock);
+
+    int result = 0;
+    switch(task.taskType){
+      case THREADTASK_SEARCH:
+        runSearchTask(tdat);
         break;
-      case THREADSTATE_IDLE:
+      case THREADTASK_SAVESCREENSHOT:
+        result = saveScreenshot((screenshot_data*)task.taskData);
         break;
       default:
         break;
     }
-  }
 
+    SDL_LockMutex(queue->lock);
+    if((tdat->threadState == THREADSTATE_SEARCH)||(tdat->threadState == THREADSTATE_BACKGROUNDTASK)){
+      tdat->threadState = THREADSTATE_IDLE; //done with the task
+    }
+    uint32_t completes = task.completes;
+    if(task.taskType == THREADTASK_SEARCH){
+      if(task.searchGeneration == queue->searchGeneration){
+        queue->taskEndTime[task.taskNum] = SDL_GetTicksNS() - queue->batchStartTime;
+        queue->numUnfinishedSearchTasks--;
+        if(queue->numUnfinishedSearchTasks == 0){
+          SDL_BroadcastCondition(queue->taskDone); //wake anything waiting for the search to finish
+        }
+      }else{
+        //task of a cancelled search (its results were dropped)
+        completes = 0; //the tasks queued now belong to another search
+        queue->numStaleSearchTasks--;
+        if((queue->numStaleSearchTasks == 0)&&(queue->numTasks > 0)){
+          SDL_BroadcastCondition(queue->taskQueued); //tasks of the current search may now be runnable
+        }
+      }
+    }
+    if(task.future != NULL){
+      task.future->result = result;
+      SDL_SetAtomicInt(&task.future->state,TASKFUTURE_DONE); //result is visible before the state changes
+      SDL_BroadcastCondition(queue->taskDone); //wake anything waiting on the future
+    }
+    const uint32_t newlyFinished = completes & ~(queue->finishedTasks);
+    queue->finishedTasks |= completes;
+    if((newlyFinished != 0)&&(queue->numTasks > 0)){
+      SDL_BroadcastCondition(queue->taskQueued); //tasks depending on this one may now be runnable
+    }
+    if(tdat->state->ss.resultsEventType != 0){
+      //wake the main thread, so that it can show the results (or finish the search, or use the result of the task)
+      SDL_Event evt;
+      SDL_zero(evt);
+      evt.type = tdat->state->ss.resultsEventType;
+      SDL_PushEvent(&evt);
+    }
+  }
   //printf("Terminating thread %u.\n",tdat->threadNum);
   tdat->threadState = THREADSTATE_DEAD;
+  SDL_UnlockMutex(queue->lock);
   return 1;
 }
 
+//starts the threads in the thread pool, sized according to the number of CPU cores
+//returns 0 if successful, -1 otherwise
+static int startThreadPool(app_data *restrict dat, app_state *restrict state, thread_manager_state *restrict tms){
+  tms->queue.lock = SDL_CreateMutex();
+  tms->queue.taskQueued = SDL_CreateCondition();
+  tms->queue.taskDone = SDL_CreateCondition();
+  if((tms->queue.lock == NULL)||(tms->queue.taskQueued == NULL)||(tms->queue.taskDone == NULL)){
+    SDL_Log("ERROR: startThreadPool - couldn't create synchronization primitives - %s\n",SDL_GetError());
+    return -1; //fail
+  }
+  tms->queue.numTasks = 0;
+  tms->queue.numUnfinishedSearchTasks = 0;
+  tms->queue.numStaleSearchTasks = 0;
+  tms->queue.searchGeneration = 0;
+
+  setSearchChunks(&dat->ndat,&state->ss); //split the data for the slowest search agents
+
+  //one thread per core, no more than there are search tasks to run at once
+  int numThreads = SDL_GetNumLogicalCPUCores();
+  if(numThreads > NUM_SEARCH_THREADS){
+    numThreads = NUM_SEARCH_THREADS;
+  }
+  if(numThreads > MAX_NUM_THREADS){
+    numThreads = MAX_NUM_THREADS;
+  }
+  if(numThreads < 1){
+    numThreads = 1;
+  }
+  //SDL_Log("Starting %i thread(s).\n",numThreads);
+  for(uint8_t i=0; i<(uint8_t)numThreads; i++){
+    char threadName[16];
+    SDL_snprintf(threadName,16,"tp_%u",i);
+    tms->threadData[i].threadNum = i;
+    tms->threadData[i].threadState = THREADSTATE_IDLE;
+    tms->threadData[i].queue = &tms->queue;
+    tms->threadData[i].state = state;
+    tms->threadData[i].dat = dat;
+    tms->thread[i] = SDL_CreateThread(tpFunc,threadName,(void *)(intptr_t)(&tms->threadData[i]));
+    if(tms->thread[i]==NULL){
+      SDL_Log("ERROR: startThreadPool - couldn't create thread %u - %s\n",i,SDL_GetError());
+      tms->threadData[i].threadState = THREADSTATE_DEAD;
+      break;
+    }
+    tms->numThreads++;
+  }
+  if(tms->numThreads == 0){
+    return -1; //fail
+  }
+  return 0;
+}
+
 int startSearchThreads(app_data *restrict dat, app_state *restrict state, thread_manager_state *restrict tms){
 
   if(strlen(state->ss.searchString)<=0){
@@ -134,108 +288,261 @@ int startSearchThreads(app_data *restrict dat, app_state *restrict state, thread
     return 0;
   }
 
-  //initialize search state
+  //initialize search state (the state shared by the search tasks is set up once they start, see startSearchTasks)
   SDL_memset(state->ss.updatedResults,0,sizeof(state->ss.updatedResults));
-  state->ss.finishedSearchAgents = 0;
   state->ss.numUpdatedResults = 0;
   if((state->uiState == UISTATE_FULLLEVELINFO)||(state->uiState == UISTATE_FULLLEVELINFOWITHMENU)){
     state->ss.searchInProgress = SEARCHSTATE_SEARCHING_SINGLENUCL;
-    state->ss.boostedNucl = state->chartSelectedNucl;
   }else{
     state->ss.searchInProgress = SEARCHSTATE_SEARCHING;
-    state->ss.boostedNucl = MAXNUMNUCL;
   }
-  state->ss.boostedResultType = SEARCHAGENT_TOKENIZE; //default value
-  state->ss.broadSearch = 0;
+  state->ss.runningSearchGeneration = SDL_AddAtomicInt(&state->ss.searchGeneration,1) + 1; //search threads stop once the query changes again
+  search_context ctx;
+  setSearchContext(state,&ctx); //search threads only read a copy of the state that they depend on
+  ctx.generation = state->ss.runningSearchGeneration;
 
-  //determine number of threads
-  tms->numThreads = SEARCHAGENT_ENUM_LENGTH;
-  tms->masterThreadState = THREADSTATE_SEARCH;
-  if(tms->numThreads > MAX_NUM_THREADS){
-    SDL_Log("ERROR: startSearchThreads - trying to start invalid number of threads (%u).\n",tms->numThreads);
+  //publish cached results without searching, if this query was searched for recently
+  state->ss.resultCache.searchCacheable = getSearchResultCacheKey(&ctx,&state->ss.resultCache.searchKey);
+  if(getCachedSearchResults(&state->ss)){
+    state->ss.searchInProgress = SEARCHSTATE_NOTSEARCHING;
+    return 0; //no threads needed
+  }
+
+  //start the thread pool on the first search
+  if(tms->numThreads == 0){
+    if(startThreadPool(dat,state,tms) != 0){
+      SDL_Log("ERROR: startSearchThreads - couldn't start thread pool.\n");
+      return -1; //fail
+    }
+  }
+
+  //queue one task per search agent, with the slowest agents split into one task per chunk of the data
+  //(each task runs once the agents it depends on have finished)
+  //(tasks of cancelled searches which are still running don't hold up queueing, the new tasks
+  //start as soon as those have dropped out at their next cancellation check)
+  SDL_LockMutex(tms->queue.lock);
+  if(tms->queue.numUnfinishedSearchTasks > 0){
+    //the previous search must be finished or cancelled (see cancelSearchThreads) first
+    SDL_UnlockMutex(tms->queue.lock);
+    SDL_Log("ERROR: startSearchThreads - previous search still running (%u unfinished tasks).\n",tms->queue.numUnfinishedSearchTasks);
     return -1; //fail
   }
-  //printf("Starting %u search thread(s).\n",tms->numThreads);
-
-  uint8_t numThreadsStarted = 0;
-  uint8_t i=0;
-  uint16_t loopCtr = 0;
-  while(numThreadsStarted < tms->numThreads){
-    if((!(tms->aliveThreads & ((uint64_t)(1) << i)))&&(tms->threadData[i].threadState == THREADSTATE_DEAD)){
-      //start a new thread at this slot
-      char threadName[16];
-      SDL_snprintf(threadName,16,"tp_%u",i);
-      tms->threadData[i].threadNum = i;
-      tms->threadData[i].threadState = THREADSTATE_SEARCH;
-      tms->threadData[i].threadPar = numThreadsStarted;
-      //assign data and state pointers
-      tms->threadData[i].state = state;
-      tms->threadData[i].dat = dat;
-      SDL_Thread *thread = SDL_CreateThread(tpFunc,threadName,(void *)(intptr_t)(&tms->threadData[i]));
-      SDL_DetachThread(thread);
-      if(thread==NULL){
-        printf("ERROR: startSearchThreads - couldn't create thread %u - %s\n",i,SDL_GetError());
-        return -1; //fail
-      }
-      tms->aliveThreads |= ((uint64_t)(1) << i);
-      numThreadsStarted++;
-    }else{
-      //active thread, kill it so that this slot can be used again later
-      if(tms->threadData[i].threadState != THREADSTATE_KILL){ //check to make sure this thread hasn't already been flagged by killIdleThreads
-        tms->threadData[i].threadState = THREADSTATE_KILL;
-        tms->aliveThreads = (uint64_t)(tms->aliveThreads & ~((uint64_t)(1) << i)); //unset
-      }
+  if((tms->queue.numTasks + NUM_SEARCH_THREADS) > MAX_NUM_THREAD_TASKS){
+    //too many background tasks queued
+    SDL_UnlockMutex(tms->queue.lock);
+    SDL_Log("ERROR: startSearchThreads - task queue is full.\n");
+    return -1; //fail
+  }
+  memcpy(&state->ss.nextCtx,&ctx,sizeof(search_context)); //copied to ss.ctx when the first task starts
+  tms->queue.searchGeneration = ctx.generation;
+  tms->queue.finishedTasks = 0;
+  tms->queue.batchStartTime = SDL_GetTicksNS();
+  tms->queue.numBatchTasks = NUM_SEARCH_THREADS; //tasks are numbered by the index of their results (ss.threadResults)
+  for(uint8_t i=0; i<SEARCHAGENT_ENUM_LENGTH; i++){
+    for(uint8_t j=0; j<getNumSearchAgentChunks(i); j++){
+      thread_task *task = &tms->queue.task[tms->queue.numTasks];
+      task->taskData = NULL;
+      task->future = NULL;
+      task->taskType = THREADTASK_SEARCH;
+      task->priority = TASKPRIORITY_SEARCH;
+      task->taskNum = getSearchResultHeapInd(i,j);
+      task->threadPar = i;
+      task->threadSubPar = j; //chunk of the data to search
+      task->dependencies = getSearchAgentDependencies(i);
+      task->completes = (uint32_t)(1U << i); //chunked agents are never depended on, so any chunk can flag the agent
+      task->searchGeneration = ctx.generation;
+      tms->queue.taskStartTime[task->taskNum] = 0;
+      tms->queue.taskEndTime[task->taskNum] = 0;
+      tms->queue.numTasks++;
     }
-    i++;
-    loopCtr++;
-    if(i >= MAX_NUM_THREADS){
-      i=0; //loop back and see if any threads that were killed can now be used
-      SDL_Delay(THREAD_UPDATE_DELAY); //oof
+  }
+  tms->queue.numUnfinishedSearchTasks = NUM_SEARCH_THREADS;
+  tms->masterThreadState = THREADSTATE_SEARCH;
+  SDL_BroadcastCondition(tms->queue.taskQueued); //wake the pool
+  SDL_UnlockMutex(tms->queue.lock);
+  //printf("Queued %u search task(s).\n",NUM_SEARCH_THREADS);
+  
+  return NUM_SEARCH_THREADS; //win
+}
+
+//cancels the running search, dropping any of its tasks which haven't started yet, a new
+//search can be started straight away (the tasks still running drop out at their next
+//cancellation check, and their results are discarded)
+void cancelSearchThreads(app_state *restrict state, thread_manager_state *restrict tms){
+  state->ss.searchInProgress = SEARCHSTATE_NOTSEARCHING;
+  tms->masterThreadState = THREADSTATE_IDLE;
+  if(tms->numThreads == 0){
+    cancelSearch(&state->ss); //no pool, nothing queued
+    return;
+  }
+  SDL_LockMutex(tms->queue.lock);
+  cancelSearch(&state->ss);
+  uint8_t numKeptTasks = 0;
+  for(uint8_t i=0; i<tms->queue.numTasks; i++){
+    if(tms->queue.task[i].taskType == THREADTASK_SEARCH){
+      tms->queue.numUnfinishedSearchTasks--; //drop the task
+    }else{
+      tms->queue.task[numKeptTasks] = tms->queue.task[i]; //keep other tasks
+      numKeptTasks++;
     }
-    if(loopCtr >= 2048){
-      SDL_Log("ERROR: startSearchThreads - probable infinite loop.\n");
+  }
+  tms->queue.numTasks = numKeptTasks;
+  //the remaining tasks are running, count them separately so that the next search doesn't wait for them to finish
+  tms->queue.numStaleSearchTasks = (uint8_t)(tms->queue.numStaleSearchTasks + tms->queue.numUnfinishedSearchTasks);
+  tms->queue.numUnfinishedSearchTasks = 0;
+  tms->queue.searchGeneration = 0;
+  SDL_BroadcastCondition(tms->queue.taskDone); //wake anything waiting for the search to finish
+  SDL_UnlockMutex(tms->queue.lock);
+}
+
+//queues a task other than a search (see thread_task_type_enum) to be run in the background
+//by the thread pool, future (if not NULL) is set once the task is done, and can be polled
+//each frame using getTaskFutureState (or waited on using waitForTaskFuture)
+//returns 0 if the task was queued, -1 otherwise (in which case the task should be run directly)
+int queueBackgroundTask(app_data *restrict dat, app_state *restrict state, thread_manager_state *restrict tms, const uint8_t taskType, const uint8_t priority, void *taskData, thread_task_future *future){
+
+  //start the thread pool, if it hasn't been started by a search yet
+  if(tms->numThreads == 0){
+    if(startThreadPool(dat,state,tms) != 0){
+      SDL_Log("ERROR: queueBackgroundTask - couldn't start thread pool.\n");
       return -1; //fail
     }
   }
-  if(numThreadsStarted != tms->numThreads){
-    SDL_Log("ERROR: startSearchThreads - started an invalid number of threads (%u, should be %u).\n",numThreadsStarted,tms->numThreads);
+
+  SDL_LockMutex(tms->queue.lock);
+  if(tms->queue.numTasks >= MAX_NUM_THREAD_TASKS){
+    SDL_UnlockMutex(tms->queue.lock);
+    SDL_Log("ERROR: queueBackgroundTask - task queue is full.\n");
     return -1; //fail
   }
-  
-  return (int)(tms->numThreads); //win
+  thread_task *task = &tms->queue.task[tms->queue.numTasks];
+  task->taskData = taskData;
+  task->future = future;
+  task->dependencies = 0;
+  task->completes = 0;
+  task->taskType = taskType;
+  task->priority = priority;
+  task->taskNum = 0;
+  task->threadPar = 0;
+  task->threadSubPar = 0;
+  task->searchGeneration = 0;
+  if(future != NULL){
+    future->result = 0;
+    SDL_SetAtomicInt(&future->state,TASKFUTURE_PENDING);
+  }
+  tms->queue.numTasks++;
+  SDL_SignalCondition(tms->queue.taskQueued); //wake a thread in the pool
+  SDL_UnlockMutex(tms->queue.lock);
+  return 0;
 }
 
-void updateThreads(const app_data *restrict dat, app_state *restrict state, resource_data *restrict rdat, thread_manager_state *restrict tms){
-  
-  //kill any idle threads
-  for(uint8_t i=0;i<MAX_NUM_THREADS;i++){
-    if(tms->aliveThreads & ((uint64_t)(1) << i)){
-      if(tms->threadData[i].threadState == THREADSTATE_IDLE){
-        tms->threadData[i].threadState = THREADSTATE_KILL;
-        tms->aliveThreads = (uint64_t)(tms->aliveThreads & ~((uint64_t)(1) << i)); //unset
-        if(tms->numThreads > 0){
-          tms->numThreads--;
-        }
-      }
+//returns the state of a task future, values from task_future_state_enum
+//(once TASKFUTURE_DONE is returned, future->result can be read)
+uint8_t getTaskFutureState(thread_task_future *future){
+  return (uint8_t)SDL_GetAtomicInt(&future->state);
+}
+
+//blocks until the task of a future has finished (returns immediately if no task is pending)
+void waitForTaskFuture(thread_manager_state *restrict tms, thread_task_future *future){
+  if(tms->numThreads == 0){
+    return; //no pool, so no pending tasks
+  }
+  SDL_LockMutex(tms->queue.lock);
+  while(getTaskFutureState(future) == TASKFUTURE_PENDING){
+    SDL_WaitCondition(tms->queue.taskDone,tms->queue.lock);
+  }
+  SDL_UnlockMutex(tms->queue.lock);
+}
+
+//blocks until all tasks of the running search have finished
+//(the results are then merged by the next call to updateThreads)
+void waitForSearchTasks(thread_manager_state *restrict tms){
+  if(tms->numThreads == 0){
+    return; //no pool, so no search tasks
+  }
+  SDL_LockMutex(tms->queue.lock);
+  while(tms->queue.numUnfinishedSearchTasks > 0){
+    SDL_WaitCondition(tms->queue.taskDone,tms->queue.lock);
+  }
+  SDL_UnlockMutex(tms->queue.lock);
+}
+
+//records the timing of the tasks in a finished search, for display in the performance stats
+static void recordSearchTaskTimes(thread_manager_state *restrict tms){
+  tms->lastSearchTime = 0;
+  tms->lastSlowestTaskTime = 0;
+  tms->lastSlowestTask = 0;
+  for(uint8_t i=0; i<tms->queue.numBatchTasks; i++){
+    const Uint64 taskTime = tms->queue.taskEndTime[i] - tms->queue.taskStartTime[i];
+    //SDL_Log("Task %2u: started at %8.3f ms, ran for %8.3f ms.\n",i,(double)tms->queue.taskStartTime[i]/1.0E6,(double)taskTime/1.0E6);
+    if(taskTime > tms->lastSlowestTaskTime){
+      tms->lastSlowestTaskTime = taskTime;
+      tms->lastSlowestTask = i;
+    }
+    if(tms->queue.taskEndTime[i] > tms->lastSearchTime){
+      tms->lastSearchTime = tms->queue.taskEndTime[i];
+    }
+  }
+}
+
+//saves screenshots in the background once a file has been chosen
+//(one at a time, a screenshot waits until any previous one has been saved)
+static void queueScreenshotSave(app_data *restrict dat, app_state *restrict state, resource_data *restrict rdat, thread_manager_state *restrict tms){
+  if(getTaskFutureState(&rdat->ssdat.saveFuture) == TASKFUTURE_DONE){
+    SDL_SetAtomicInt(&rdat->ssdat.saveFuture.state,TASKFUTURE_NONE);
+  }
+  if((rdat->ssdat.takingScreenshot == 3)&&(getTaskFutureState(&rdat->ssdat.saveFuture) == TASKFUTURE_NONE)){
+    rdat->ssdat.savingScreenshot = rdat->ssdat.screenshot;
+    rdat->ssdat.screenshot = NULL;
+    SDL_strlcpy(rdat->ssdat.savingFileName,rdat->ssdat.fileName,256);
+    if(queueBackgroundTask(dat,state,tms,THREADTASK_SAVESCREENSHOT,TASKPRIORITY_IO,(void*)&rdat->ssdat,&rdat->ssdat.saveFuture) != 0){
+      saveScreenshot(&rdat->ssdat); //save on the main thread instead
     }
+    rdat->ssdat.takingScreenshot = 0; //no longer taking a screenshot
   }
+}
 
+//waits for screenshots to be saved (including one whose file was chosen
+//while a previous screenshot was being saved), for use before quitting
+void finishScreenshotSaves(app_data *restrict dat, app_state *restrict state, resource_data *restrict rdat, thread_manager_state *restrict tms){
+  waitForTaskFuture(tms,&rdat->ssdat.saveFuture);
+  queueScreenshotSave(dat,state,rdat,tms);
+  waitForTaskFuture(tms,&rdat->ssdat.saveFuture);
+}
+
+void updateThreads(app_data *restrict dat, app_state *restrict state, resource_data *restrict rdat, thread_manager_state *restrict tms){
+
+  queueScreenshotSave(dat,state,rdat,tms);
+  
   //update UI based on thread state
   if(tms->masterThreadState == THREADSTATE_SEARCH){
-    updateSearchUIState(dat,state,rdat);
-    //ensure the search results are processed on the next frame
-    //regardless of the presence of user input or other events
-    state->ds.forceRedraw = 1;
+    //show the results of the search threads which have finished so far
+    if(getPublishedSearchResults(&state->ss)){
+      updateSearchUIState(dat,state,rdat);
+      state->ds.forceRedraw = 1; //draw the new results
+    }
+    if(state->ss.resultsEventType == 0){
+      //search threads can't wake the main thread, ensure the search results are
+      //processed on the next frame regardless of the presence of user input or other events
+      state->ds.forceRedraw = 1;
+    }
   }
 
-  //take action once all threads are done
-  if(tms->numThreads == 0){
-    if(tms->masterThreadState == THREADSTATE_SEARCH){
+  //take action once all tasks are done
+  if(tms->masterThreadState == THREADSTATE_SEARCH){
+    SDL_LockMutex(tms->queue.lock);
+    const uint8_t numUnfinishedSearchTasks = tms->queue.numUnfinishedSearchTasks;
+    SDL_UnlockMutex(tms->queue.lock);
+    if(numUnfinishedSearchTasks == 0){
       //search is finished, copy over the search results
+      //(cancelled searches are never finished, see cancelSearchThreads)
       //SDL_Log("Search finished.\n");
       if(strlen(state->ss.searchString)>0){
+        recordSearchTaskTimes(tms);
+        mergeSearchResults(&state->ss);
         memcpy(state->ss.results,state->ss.updatedResults,sizeof(state->ss.updatedResults));
         state->ss.numResults = state->ss.numUpdatedResults;
+        cacheSearchResults(&state->ss);
       }else{
         //perhaps the user pressed backspace too quickly...
         state->ss.numResults = 0;
@@ -247,10 +554,28 @@ void updateThreads(const app_data *restrict dat, app_state *restrict state, reso
   }
 }
 
+//stops the threads in the thread pool, dropping any queued tasks, and waits for them to exit
+//(threads finish the task they are running first, so any search should be cancelled beforehand)
 void stopThreadPool(thread_manager_state *restrict tms){
-  printf("Stopping %u thread(s).\n",tms->numThreads);
-  for(uint8_t i=0;i<tms->numThreads;i++){
-    tms->threadData[i].threadState = THREADSTATE_KILL;
+  SDL_Log("Stopping %u thread(s).\n",tms->numThreads);
+  if(tms->numThreads > 0){
+    SDL_LockMutex(tms->queue.lock);
+    for(uint8_t i=0;i<tms->numThreads;i++){
+      tms->threadData[i].threadState = THREADSTATE_KILL;
+    }
+    tms->queue.numTasks = 0;
+    SDL_BroadcastCondition(tms->queue.taskQueued); //wake sleeping threads, so that they exit
+    SDL_UnlockMutex(tms->queue.lock);
+    for(uint8_t i=0;i<tms->numThreads;i++){
+      SDL_WaitThread(tms->thread[i],NULL);
+      tms->thread[i] = NULL;
+    }
+    SDL_DestroyCondition(tms->queue.taskQueued);
+    SDL_DestroyCondition(tms->queue.taskDone);
+    SDL_DestroyMutex(tms->queue.lock);
+    tms->queue.taskQueued = NULL;
+    tms->queue.taskDone = NULL;
+    tms->queue.lock = NULL;
   }
   tms->masterThreadState = THREADSTATE_KILL;
   tms->numThreads = 0;